@@ -0,0 +1,35 @@
+#include "allocationCounter.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+namespace chess::bench {
+
+static std::atomic<std::uint64_t> allocations = 0;
+
+std::uint64_t allocationCount() { return allocations.load(std::memory_order_relaxed); }
+
+}  // namespace chess::bench
+
+void *operator new(std::size_t size) {
+    chess::bench::allocations.fetch_add(1, std::memory_order_relaxed);
+
+    void *ret = std::malloc(size != 0 ? size : 1);
+    if (ret == nullptr) {
+        throw std::bad_alloc();
+    }
+
+    return ret;
+}
+
+void *operator new[](std::size_t size) { return operator new(size); }
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+
+void operator delete[](void *ptr) noexcept { std::free(ptr); }
+
+void operator delete(void *ptr, std::size_t) noexcept { std::free(ptr); }
+
+void operator delete[](void *ptr, std::size_t) noexcept { std::free(ptr); }
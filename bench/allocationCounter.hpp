@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * `chess_bench` replaces the global `operator new` to count heap allocations, so benchmarks of
+ * paths that shouldn't allocate can check that they don't
+ */
+
+namespace chess::bench {
+
+/**
+ * heap allocations made by the process so far
+ */
+std::uint64_t allocationCount();
+
+}  // namespace chess::bench
@@ -0,0 +1,76 @@
+#include "benchPositions.hpp"
+
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "chessBase.hpp"
+#include "chessBoard.hpp"
+#include "chessGame.hpp"
+
+namespace chess::bench {
+
+std::optional<Move> ScriptedPlayer::chooseMove(Game &game) {
+    std::optional<Move> ret = std::nullopt;
+
+    if (!moves.empty()) {
+        auto [start, end] = moves.front();
+        moves.pop_front();
+        ret = Move{game.board.pieceMap.at(start).get(), game.board.pieceMap.at(end).get(), start,
+                   end};
+    }
+
+    return ret;
+}
+
+void BenchGame::unlogMove() {
+    moveLog.pop_back();
+    moveLogText.pop_back();
+    moveCount--;
+    turnCount -= currentPlayer->color == PieceColor::white ? 1 : 0;
+}
+
+BenchSetup::BenchSetup(const BenchPosition &position)
+    : board(64, false),
+      white(PieceColor::white),
+      black(PieceColor::black),
+      game(board, white, black) {
+    if (!game.loadFEN(position.fen)) {
+        throw std::invalid_argument("bad bench position: " + position.name);
+    }
+
+    game.start();
+    for (auto &move : position.moves) {
+        (game.currentPlayer == &white ? white : black).moves.push_back(move);
+        if (game.run() != RunResult::turnedPassed) {
+            throw std::invalid_argument("bad bench move: " + move.first + move.second);
+        }
+    }
+}
+
+Player &BenchSetup::sideToMove() { return *game.currentPlayer; }
+
+const std::vector<BenchPosition> &benchPositions() {
+    static const std::vector<BenchPosition> ret = {
+        {"opening", "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", {}},
+        {"middlegame", "r1bq1rk1/pp2bppp/2n1pn2/2pp4/2PP4/2N1PN2/PP2BPPP/R1BQ1RK1 w - - 0 8", {}},
+        {"endgame", "8/5pk1/6p1/8/3R4/6P1/5PK1/3r4 w - - 0 40", {}},
+        {"repetition",
+         "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+         {{"e2", "e4"},
+          {"e7", "e5"},
+          {"g1", "f3"},
+          {"b8", "c6"},
+          {"f3", "g1"},
+          {"c6", "b8"},
+          {"g1", "f3"},
+          {"b8", "c6"},
+          {"f3", "g1"},
+          {"c6", "b8"}}},
+    };
+
+    return ret;
+}
+
+}  // namespace chess::bench
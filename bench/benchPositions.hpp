@@ -0,0 +1,64 @@
+#pragma once
+
+#include <deque>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "chessBase.hpp"
+#include "chessBoard.hpp"
+#include "chessGame.hpp"
+
+namespace chess::bench {
+
+/**
+ * a FEN string and the moves to play from it, as start and end squares
+ */
+struct BenchPosition {
+    std::string name;
+    std::string fen;
+    std::vector<std::pair<std::string, std::string>> moves;
+};
+
+/**
+ * plays the moves it's given, in order
+ */
+class ScriptedPlayer : public Player {
+   public:
+    std::deque<std::pair<std::string, std::string>> moves;
+
+   public:
+    using Player::Player;
+    std::optional<Move> chooseMove(Game &game) override;
+    ~ScriptedPlayer() override {};
+};
+
+class BenchGame : public Game {
+   public:
+    using Game::Game;
+    /**
+     * removes the last entry `logMove()` added without touching the board
+     */
+    void unlogMove();
+};
+
+/**
+ * a game at one of the bench positions, ready to be measured
+ */
+struct BenchSetup {
+    Board board;
+    ScriptedPlayer white;
+    ScriptedPlayer black;
+    BenchGame game;
+
+    explicit BenchSetup(const BenchPosition &position);
+    Player &sideToMove();
+};
+
+/**
+ * opening, middlegame, endgame and a threefold repetition
+ */
+const std::vector<BenchPosition> &benchPositions();
+
+}  // namespace chess::bench
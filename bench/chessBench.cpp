@@ -0,0 +1,457 @@
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "allocationCounter.hpp"
+#include "benchPositions.hpp"
+#include "chessBase.hpp"
+#include "chessBoard.hpp"
+#include "chessGame.hpp"
+#include "chessMoveList.hpp"
+#include "chessNNUE.hpp"
+#include "chessPiece.hpp"
+#include "chessPosition.hpp"
+
+using namespace chess;
+using namespace chess::bench;
+
+static std::vector<std::string> allSquares() {
+    std::vector<std::string> ret{};
+    for (int x = 1; x <= 8; x++) {
+        for (int y = 1; y <= 8; y++) {
+            ret.push_back(pairToChessPos({x, y}));
+        }
+    }
+
+    return ret;
+}
+
+static void chessPosToPairBench(benchmark::State &state) {
+    std::vector<std::string> squares = allSquares();
+
+    for (auto _ : state) {
+        for (std::string &square : squares) {
+            benchmark::DoNotOptimize(chessPosToPair(square));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * squares.size());
+}
+
+static void pairToChessPosBench(benchmark::State &state) {
+    for (auto _ : state) {
+        for (int x = 1; x <= 8; x++) {
+            for (int y = 1; y <= 8; y++) {
+                benchmark::DoNotOptimize(pairToChessPos({x, y}));
+            }
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * 64);
+}
+
+/**
+ * recomputes where every square of a `side` x `side` board is drawn, as flipping the board does
+ */
+static void updateSquaresPositionBench(benchmark::State &state, int side) {
+    Board board(720, side * side, false, {0, 0}, {}, false);
+
+    for (auto _ : state) {
+        board.updateSquaresPosition();
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * side * side);
+}
+
+/**
+ * asks every piece of type `notation` whether it can move to every square
+ */
+static void canMoveBench(benchmark::State &state, const BenchPosition &position, char notation) {
+    BenchSetup setup(position);
+    std::vector<std::string> squares = allSquares();
+    std::vector<Piece *> pieces{};
+    std::optional<Move> lastMove = setup.game.lastMove();
+
+    for (auto &[pos, piece] : setup.board.pieceMap) {
+        if (piece != nullptr && piece->notation == notation) {
+            pieces.push_back(piece.get());
+        }
+    }
+
+    for (auto _ : state) {
+        for (Piece *piece : pieces) {
+            for (std::string &square : squares) {
+                benchmark::DoNotOptimize(piece->canMove(setup.board.pieceMap, square, lastMove));
+            }
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * pieces.size() * squares.size());
+}
+
+static void isKingInCheckBench(benchmark::State &state, const BenchPosition &position) {
+    BenchSetup setup(position);
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(setup.game.isKingInCheck(setup.sideToMove().color));
+    }
+}
+
+/**
+ * legal moves of every piece of the side to move
+ */
+static void getLegalMovesBench(benchmark::State &state, const BenchPosition &position) {
+    BenchSetup setup(position);
+    Player &player = setup.sideToMove();
+    std::vector<Piece *> pieces{};
+
+    for (auto &[pos, piece] : setup.board.pieceMap) {
+        if (piece != nullptr && piece->color == player.color) {
+            pieces.push_back(piece.get());
+        }
+    }
+
+    for (auto _ : state) {
+        for (Piece *piece : pieces) {
+            benchmark::DoNotOptimize(setup.game.getLegalMoves(*piece, player));
+        }
+    }
+}
+
+/**
+ * with the legal moves generated again every time, as after each move of a game
+ */
+static void lookForWinBench(benchmark::State &state, const BenchPosition &position) {
+    BenchSetup setup(position);
+
+    for (auto _ : state) {
+        setup.game.invalidateLegalMoves();
+        benchmark::DoNotOptimize(setup.game.lookForWin());
+    }
+}
+
+/**
+ * destinations of every square once the legal moves of the position are cached,
+ * what a UI asks for every frame while a piece is dragged
+ */
+static void legalMovesFromBench(benchmark::State &state, const BenchPosition &position) {
+    BenchSetup setup(position);
+    std::vector<std::string> squares = allSquares();
+
+    setup.game.legalMoves();
+    for (auto _ : state) {
+        for (const std::string &square : squares) {
+            benchmark::DoNotOptimize(setup.game.legalMovesFrom(square));
+        }
+    }
+}
+
+/**
+ * a snapshot of the game that another thread can copy
+ */
+static void positionBench(benchmark::State &state, const BenchPosition &position) {
+    BenchSetup setup(position);
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(setup.game.position());
+    }
+}
+
+/**
+ * runs `fn` once to warm up and then once per iteration, reports the heap allocations per
+ * iteration and fails the benchmark if there were any
+ */
+template <class Fn>
+static void withoutAllocations(benchmark::State &state, Fn fn) {
+    fn();
+
+    std::uint64_t before = allocationCount();
+    for (auto _ : state) {
+        fn();
+    }
+    std::uint64_t allocations = allocationCount() - before;
+
+    state.counters["allocations"] =
+        benchmark::Counter(static_cast<double>(allocations), benchmark::Counter::kAvgIterations);
+    if (allocations != 0) {
+        state.SkipWithError("the hot path allocated on the heap");
+    }
+}
+
+/**
+ * legal moves of the side to move into a `MoveList`
+ */
+static void generateMovesBench(benchmark::State &state, const BenchPosition &position) {
+    BenchSetup setup(position);
+    MoveList moves{};
+
+    withoutAllocations(state, [&] {
+        moves.clear();
+        setup.game.getLegalMoves(setup.sideToMove(), moves);
+        benchmark::DoNotOptimize(moves.size());
+    });
+}
+
+/**
+ * checks every legal move of the side to move
+ */
+static void isMoveLegalBench(benchmark::State &state, const BenchPosition &position) {
+    BenchSetup setup(position);
+    MoveList moves{};
+
+    setup.game.getLegalMoves(setup.sideToMove(), moves);
+    withoutAllocations(state, [&] {
+        for (Move &move : moves) {
+            benchmark::DoNotOptimize(setup.game.isMoveLegal(move, setup.sideToMove()));
+        }
+    });
+}
+
+/**
+ * makes and undoes every legal move of the side to move
+ */
+static void makeUndoBench(benchmark::State &state, const BenchPosition &position) {
+    BenchSetup setup(position);
+    MoveList moves{};
+
+    setup.game.getLegalMoves(setup.sideToMove(), moves);
+    withoutAllocations(state, [&] {
+        for (const Move &move : moves) {
+            setup.game.makeMove(move);
+            setup.game.undoLastMove();
+        }
+    });
+}
+
+/**
+ * checks the UCI notation of every legal move of the side to move with the promotion it can't
+ * have, which `tryApplyMove()` parses and looks up in the cached legal moves before rejecting
+ * it, so the position and its cache stay as they are
+ */
+static void validateMoveBench(benchmark::State &state, const BenchPosition &position) {
+    BenchSetup setup(position);
+    std::vector<std::string> moves{};
+
+    for (Move move : setup.game.legalMoves()) {
+        bool promotes = move.startPiece->notation == 'p' &&
+                        (move.end[1] == '8' || move.end[1] == '1');
+        move.promotion = promotes ? '\0' : 'q';
+        moves.push_back(moveToUCI(move));
+    }
+    withoutAllocations(state, [&] {
+        for (const std::string &move : moves) {
+            benchmark::DoNotOptimize(setup.game.tryApplyMove(move));
+        }
+    });
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(moves.size()));
+}
+
+/**
+ * a capture that promotes and its undo, which replace pieces on both ways
+ */
+static void capturePromoteBench(benchmark::State &state) {
+    BenchSetup setup({"promotion", "1r5k/P7/8/8/8/8/8/K7 w - - 0 1", {}});
+
+    withoutAllocations(state, [&] {
+        setup.game.makeMove(*setup.game.moveFromUCI("a7b8q"));
+        setup.game.undoLastMove();
+    });
+}
+
+/**
+ * plays up to 200 plies of the same spread out moves from the setup's position
+ */
+static void playLongGame(BenchSetup &setup) {
+    for (std::size_t ply = 0; ply < 200 && !setup.game.legalMoves().empty(); ply++) {
+        std::span<const Move> moves = setup.game.legalMoves();
+        setup.game.makeMove(moves[ply * 7 % moves.size()]);
+    }
+}
+
+/**
+ * jumps between the start and the end of a long game, as a review UI does when it's scrubbed,
+ * from the checkpoints taken as the game was played
+ */
+static void seekToPlyBench(benchmark::State &state) {
+    BenchSetup setup(benchPositions().front());
+
+    playLongGame(setup);
+    std::size_t end = setup.game.moveLog.size();
+    for (auto _ : state) {
+        setup.game.seekToPly(10);
+        setup.game.seekToPly(end);
+    }
+    state.SetItemsProcessed(state.iterations() * 2);
+}
+
+/**
+ * puts a long game away, as a server does with a game that went idle
+ */
+static void saveStateBench(benchmark::State &state) {
+    BenchSetup setup(benchPositions().front());
+
+    playLongGame(setup);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(setup.game.saveState());
+    }
+    state.SetBytesProcessed(state.iterations() *
+                            static_cast<std::int64_t>(setup.game.saveState().size()));
+}
+
+/**
+ * brings a long game back from what `saveStateBench` put away
+ */
+static void loadStateBench(benchmark::State &state) {
+    BenchSetup setup(benchPositions().front());
+
+    playLongGame(setup);
+    std::string saved = setup.game.saveState();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(setup.game.loadState(std::as_bytes(std::span(saved))));
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(saved.size()));
+}
+
+/**
+ * puts the default pieces back on the board, as a server does between games
+ */
+static void resetGameBench(benchmark::State &state) {
+    BenchSetup setup(benchPositions().front());
+
+    withoutAllocations(state, [&] { setup.game.reset(); });
+}
+
+/**
+ * the position and every position one legal move away, in the order a search visits them
+ */
+static std::vector<Position> searchOrder(BenchSetup &setup) {
+    std::vector<Position> ret{setup.game.position()};
+    MoveList moves{};
+
+    setup.game.getLegalMoves(setup.sideToMove(), moves);
+    for (const Move &move : moves) {
+        setup.game.makeMove(move);
+        ret.push_back(setup.game.position());
+        setup.game.undoLastMove();
+        ret.push_back(ret.front());
+    }
+
+    return ret;
+}
+
+/**
+ * evaluates the positions of `searchOrder` with accumulators updated from one to the next
+ */
+static void nnueIncrementalBench(benchmark::State &state, const BenchPosition &position) {
+    BenchSetup setup(position);
+    std::vector<Position> positions = searchOrder(setup);
+    nnue::Evaluator evaluator(nnue::Network::generate(0));
+
+    withoutAllocations(state, [&] {
+        for (const Position &p : positions) {
+            benchmark::DoNotOptimize(evaluator.evaluate(p));
+        }
+    });
+    state.SetItemsProcessed(state.iterations() * positions.size());
+}
+
+/**
+ * the same positions with the accumulators computed from scratch every time
+ */
+static void nnueRefreshBench(benchmark::State &state, const BenchPosition &position) {
+    BenchSetup setup(position);
+    std::vector<Position> positions = searchOrder(setup);
+    std::unique_ptr<nnue::Network> network = nnue::Network::generate(0);
+
+    withoutAllocations(state, [&] {
+        for (const Position &p : positions) {
+            benchmark::DoNotOptimize(nnue::Evaluator::forward(
+                *network, nnue::Evaluator::refresh(*network, p), p.sideToMove));
+        }
+    });
+    state.SetItemsProcessed(state.iterations() * positions.size());
+}
+
+static void logMoveBench(benchmark::State &state, const BenchPosition &position) {
+    BenchSetup setup(position);
+    Player &player = setup.sideToMove();
+    std::vector<Move> moves{};
+
+    for (auto &[pos, piece] : setup.board.pieceMap) {
+        if (piece != nullptr && piece->color == player.color && moves.empty()) {
+            moves = setup.game.getLegalMoves(*piece, player);
+        }
+    }
+
+    for (auto _ : state) {
+        setup.game.logMove(moves.front());
+        setup.game.unlogMove();
+    }
+}
+
+int main(int argc, char **argv) {
+    benchmark::RegisterBenchmark("chessPosToPair", chessPosToPairBench);
+    benchmark::RegisterBenchmark("pairToChessPos", pairToChessPosBench);
+    benchmark::RegisterBenchmark("capturePromote", capturePromoteBench);
+    benchmark::RegisterBenchmark("resetGame", resetGameBench);
+    benchmark::RegisterBenchmark("seekToPly", seekToPlyBench);
+    benchmark::RegisterBenchmark("saveState", saveStateBench);
+    benchmark::RegisterBenchmark("loadState", loadStateBench);
+    for (int side : {8, 10, 16}) {
+        benchmark::RegisterBenchmark(("updateSquaresPosition/" + std::to_string(side)).c_str(),
+                                     updateSquaresPositionBench, side);
+    }
+
+    for (const BenchPosition &position : benchPositions()) {
+        for (char notation : {'p', 'r', 'n', 'b', 'q', 'k'}) {
+            BenchSetup setup(position);
+            bool present = false;
+            for (auto &[pos, piece] : setup.board.pieceMap) {
+                present = present || (piece != nullptr && piece->notation == notation);
+            }
+
+            if (present) {
+                benchmark::RegisterBenchmark(
+                    ("canMove/" + std::string(1, notation) + "/" + position.name).c_str(),
+                    canMoveBench, position, notation);
+            }
+        }
+
+        benchmark::RegisterBenchmark(("isKingInCheck/" + position.name).c_str(),
+                                     isKingInCheckBench, position);
+        benchmark::RegisterBenchmark(("getLegalMoves/" + position.name).c_str(),
+                                     getLegalMovesBench, position);
+        benchmark::RegisterBenchmark(("lookForWin/" + position.name).c_str(), lookForWinBench,
+                                     position);
+        benchmark::RegisterBenchmark(("legalMovesFrom/" + position.name).c_str(),
+                                     legalMovesFromBench, position);
+        benchmark::RegisterBenchmark(("generateMoves/" + position.name).c_str(),
+                                     generateMovesBench, position);
+        benchmark::RegisterBenchmark(("isMoveLegal/" + position.name).c_str(), isMoveLegalBench,
+                                     position);
+        benchmark::RegisterBenchmark(("makeUndo/" + position.name).c_str(), makeUndoBench,
+                                     position);
+        benchmark::RegisterBenchmark(("validateMove/" + position.name).c_str(),
+                                     validateMoveBench, position);
+        benchmark::RegisterBenchmark(("position/" + position.name).c_str(), positionBench,
+                                     position);
+        benchmark::RegisterBenchmark(("logMove/" + position.name).c_str(), logMoveBench,
+                                     position);
+        benchmark::RegisterBenchmark(("nnueIncremental/" + position.name).c_str(),
+                                     nnueIncrementalBench, position);
+        benchmark::RegisterBenchmark(("nnueRefresh/" + position.name).c_str(), nnueRefreshBench,
+                                     position);
+    }
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+
+    return 0;
+}
@@ -0,0 +1,70 @@
+#include <benchmark/benchmark.h>
+
+#include <utility>
+
+#include "SDL.h"
+#include "SDL_render.h"
+#include "SDL_surface.h"
+#include "benchPositions.hpp"
+#include "chessBase.hpp"
+#include "chessSDL.hpp"
+
+using namespace chess;
+using namespace chess::bench;
+
+/**
+ * renders into a software surface, so the benchmarks don't need a window
+ */
+struct SoftwareTarget {
+    SDL_Surface *surface;
+    SDL_Renderer *ren;
+    SDL_Texture *texture;
+
+    SoftwareTarget()
+        : surface(SDL_CreateRGBSurfaceWithFormat(0, 720, 720, 32, SDL_PIXELFORMAT_RGBA32)),
+          ren(SDL_CreateSoftwareRenderer(surface)),
+          texture(SDL_CreateTexture(ren, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STATIC, 90,
+                                    90)) {
+        for (char notation : {'p', 'r', 'n', 'b', 'q', 'k'}) {
+            spriteMap[{notation, PieceColor::white}] = {texture, {0, 0, 90, 90}};
+            spriteMap[{notation, PieceColor::black}] = {texture, {0, 0, 90, 90}};
+        }
+    }
+
+    ~SoftwareTarget() {
+        spriteMap.clear();
+        SDL_DestroyTexture(texture);
+        SDL_DestroyRenderer(ren);
+        SDL_FreeSurface(surface);
+    }
+};
+
+static void drawBench(benchmark::State &state, const BenchPosition &position) {
+    SoftwareTarget target{};
+    BenchSetup setup(position);
+    BoardRenderer renderer(setup.board, target.ren);
+
+    for (auto _ : state) {
+        renderer.draw();
+    }
+}
+
+static void renderPiecesBench(benchmark::State &state, const BenchPosition &position) {
+    SoftwareTarget target{};
+    BenchSetup setup(position);
+    BoardRenderer renderer(setup.board, target.ren);
+
+    for (auto _ : state) {
+        renderer.renderPieces();
+    }
+}
+
+static const bool registered = [] {
+    for (const BenchPosition &position : benchPositions()) {
+        benchmark::RegisterBenchmark(("draw/" + position.name).c_str(), drawBench, position);
+        benchmark::RegisterBenchmark(("renderPieces/" + position.name).c_str(),
+                                     renderPiecesBench, position);
+    }
+
+    return true;
+}();
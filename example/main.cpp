@@ -8,6 +8,7 @@
 #include "chessBase.hpp"
 #include "chessBoard.hpp"
 #include "chessGame.hpp"
+#include "chessSDL.hpp"
 
 using namespace chess;
 
@@ -18,12 +19,12 @@ int main(int argc, char **argv) {
     SDL_Window *window = SDL_CreateWindow("Chess", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
                                           1280, 720, SDL_WINDOW_RESIZABLE);
     SDL_Renderer *renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
-    Board board = {
-        720,  64,      true, {0, 0}, {defaultLightBrown, defaultDarkBrown, {0, 0, 0, 100}},
-        true, renderer};
-    Player player1 = {PieceColor::white};
-    Player player2 = {PieceColor::black};
-    Game game = {board, player1, player2, event};
+    Board board = {720, 64, true, {0, 0}, {defaultLightBrown, defaultDarkBrown, {0, 0, 0, 100}},
+                   true};
+    BoardRenderer boardRenderer = {board, renderer};
+    SDLPlayer player1 = {PieceColor::white, event, boardRenderer};
+    SDLPlayer player2 = {PieceColor::black, event, boardRenderer};
+    Game game = {board, player1, player2};
 
     createSpriteSheet("../example/pieces.png", 2560, 854, 6, 2, renderer);
     setPieceSprite('p', PieceColor::white, 5, 0);
@@ -50,9 +51,9 @@ int main(int argc, char **argv) {
         SDL_RenderClear(renderer);
 
         board.keepCentered(w, h);
-        board.draw();
-        board.highlightSquareUnderCursor(50);
-        board.renderPieces();
+        boardRenderer.draw();
+        boardRenderer.highlightSquareUnderCursor(50);
+        boardRenderer.renderPieces();
 
         renderDrawQueue(renderer, {0, 0, 0, 255});
 
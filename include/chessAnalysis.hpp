@@ -0,0 +1,70 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+#include "chessEngine.hpp"
+#include "chessPosition.hpp"
+
+namespace chess {
+
+struct AnalysisUpdate {
+    /**
+     * which call to `AnalysisSession::analyze()` the line belongs to
+     */
+    std::uint64_t generation;
+    SearchInfo info;
+};
+
+using AnalysisCallback = std::function<void(const AnalysisUpdate &update)>;
+
+/**
+ * analyzes positions in the background with its own thread and board, the best `lines` moves
+ * of every completed depth are streamed to the callback, best first, from the analysis thread,
+ * depth 1 comes first so the first results arrive within a few milliseconds
+ *
+ * `analyze()` retargets the running analysis to another position without starting a new thread,
+ * lines of the previous positions are not reported once it returns, so the callback is called
+ * under the session's lock and must not call `analyze()` or `stop()` itself
+ */
+class AnalysisSession {
+   private:
+    std::unique_ptr<Engine> _engine;
+    int _lines;
+    AnalysisCallback _onUpdate;
+    SearchSignals _signals;
+    std::mutex _mutex;
+    std::condition_variable _cv;
+    /**
+     * the position to analyze next, taken by the analysis thread
+     */
+    std::optional<Position> _pending;
+    std::uint64_t _generation;
+    bool _quit;
+    std::thread _thread;
+
+   public:
+    AnalysisSession(std::unique_ptr<Engine> engine, int lines, AnalysisCallback onUpdate);
+    AnalysisSession(const AnalysisSession &) = delete;
+    AnalysisSession &operator=(const AnalysisSession &) = delete;
+    ~AnalysisSession();
+    /**
+     * stops analyzing the current position and starts on `position` until `stop()` or the next
+     * call, returns the generation of its updates
+     */
+    std::uint64_t analyze(const Position &position);
+    /**
+     * stops analyzing, the session waits for the next position
+     */
+    void stop();
+
+   private:
+    void run();
+};
+
+}  // namespace chess
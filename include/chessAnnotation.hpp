@@ -0,0 +1,153 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "chessArchive.hpp"
+#include "chessBase.hpp"
+#include "chessEngine.hpp"
+#include "chessGame.hpp"
+
+namespace chess {
+
+/**
+ * what a search found in one position, from the point of view of the side to move
+ */
+struct PositionAnalysis {
+    int score;
+    /**
+     * moves until mate, negative if the side to move gets mated, 0 if it's checkmated already
+     */
+    std::optional<int> mateIn;
+    /**
+     * in UCI notation and in SAN, empty if the side to move has no legal move
+     */
+    std::string bestMove;
+    std::string bestMoveSAN;
+    int depth;
+};
+
+/**
+ * analyses by position hash and depth, shared between the threads of an annotation run and
+ * between runs, so a position reached in several games (or annotated again later) is only
+ * searched once
+ */
+class AnnotationCache {
+   private:
+    std::mutex _mutex;
+    std::map<std::pair<std::uint64_t, int>, PositionAnalysis> _analyses;
+
+   public:
+    /**
+     * returns `std::nullopt` if the position wasn't searched to exactly `depth`
+     */
+    std::optional<PositionAnalysis> find(std::uint64_t hash, int depth);
+    void insert(std::uint64_t hash, const PositionAnalysis &analysis);
+    std::size_t size();
+};
+
+enum class MoveQuality { good, inaccuracy, mistake, blunder };
+
+struct MoveAnnotation {
+    std::string san;
+    /**
+     * the position after the move, from white's point of view
+     */
+    int score;
+    /**
+     * moves until mate after the move, positive if white mates
+     */
+    std::optional<int> mateIn;
+    /**
+     * in SAN, empty if the move played was the best one
+     */
+    std::string bestMove;
+    /**
+     * centipawns the side that moved lost compared to the best move
+     */
+    int loss;
+    MoveQuality quality;
+};
+
+struct AnnotatedGame {
+    std::size_t index;
+    /**
+     * empty if the game started from the standard starting position
+     */
+    std::string fen;
+    WinSearchResult result;
+    std::vector<MoveAnnotation> moves;
+    /**
+     * `false` if the game couldn't be replayed to its end, `moves` has the moves before that
+     */
+    bool complete;
+};
+
+struct AnnotationConfig {
+    /**
+     * how deep the best moves are searched, at least 2, the moves played are scored by searching
+     * the position after them one ply less deep
+     */
+    int depth = 4;
+    /**
+     * 0 uses one thread per core
+     */
+    int threads = 0;
+    /**
+     * games replayed and searched together, the positions of a batch are spread over the threads
+     * and the games are reported in order once it's done
+     */
+    std::size_t batchGames = 256;
+    /**
+     * centipawns lost for a move to be an inaccuracy, a mistake and a blunder
+     */
+    int inaccuracy = 50;
+    int mistake = 100;
+    int blunder = 300;
+    /**
+     * called once per thread, `MaterialEngine` if unset
+     */
+    std::function<std::unique_ptr<Engine>()> engineFactory{};
+};
+
+struct AnnotationStats {
+    std::size_t games;
+    /**
+     * positions of all games, counting every occurrence
+     */
+    std::size_t positions;
+    /**
+     * searches that had to be run, the others came from the cache, each position is searched to
+     * two depths
+     */
+    std::size_t searched;
+    double seconds;
+};
+
+/**
+ * `move` of the side to move in standard algebraic notation, with `+` or `#` if it gives check
+ * or mate, `game` is back in its position when this returns
+ */
+std::string moveToSAN(Game &game, const Move &move);
+/**
+ * annotates every game of `archive`, `onGame` is called once per game, in archive order and one
+ * call at a time
+ */
+AnnotationStats annotateGames(const GameArchive &archive, const AnnotationConfig &config,
+                              AnnotationCache &cache,
+                              const std::function<void(const AnnotatedGame &game)> &onGame);
+/**
+ * the game in PGN with the evaluations as `[%eval]` comments, inaccuracies, mistakes and
+ * blunders marked with `$6`, `$2` and `$4` and the best move in their comments
+ */
+std::string toPGN(const AnnotatedGame &game);
+
+}  // namespace chess
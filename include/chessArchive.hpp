@@ -0,0 +1,137 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "chessBase.hpp"
+#include "chessGame.hpp"
+#include "chessMappedFile.hpp"
+
+/**
+ * binary game archive, all integers are little endian:
+ *
+ *   file:    "CHSARC01", game records, index
+ *   record:  u16 FEN length (0 for the standard starting position), u8 `WinSearchResult`,
+ *            u8 reserved, u32 number of plies, FEN, 2 bytes per ply
+ *   ply:     bits 0-5 start square, bits 6-11 end square, bits 12-14 promotion
+ *            (0 none, 1 knight, 2 bishop, 3 rook, 4 queen), squares are `file + 8 * rank` from a1
+ *   index:   u64 offset of each record, u64 number of games, "CHSIDX01"
+ *
+ * the index is written last, so an archive is only readable once its writer has been closed
+ */
+
+namespace chess {
+
+/**
+ * packs a move in UCI notation into the 2 bytes of a ply,
+ * returns `std::nullopt` if it doesn't name two squares of an 8x8 board
+ */
+std::optional<std::uint16_t> packMove(std::string_view uci);
+std::string unpackMove(std::uint16_t packed);
+
+/**
+ * one game of a `GameArchive`, it points into the archive's memory and can't outlive it
+ */
+class ArchivedGame {
+   private:
+    std::span<const std::byte> _plies;
+
+   public:
+    /**
+     * empty if the game started from the standard starting position
+     */
+    std::string_view fen;
+    WinSearchResult result;
+
+   public:
+    ArchivedGame(std::string_view fen, WinSearchResult result, std::span<const std::byte> plies);
+    std::size_t plies() const;
+    /**
+     * the move of ply `ply` as stored in the archive, see `packMove()`
+     */
+    std::uint16_t packedMove(std::size_t ply) const;
+    /**
+     * the move of ply `ply` in UCI notation
+     */
+    std::string moveUCI(std::size_t ply) const;
+    /**
+     * sets `game` up from the game's starting position and makes its first `plies` moves
+     * (all of them by default), returns `false` if the FEN or one of the moves isn't valid
+     * for `game`, in which case the moves before it stay made
+     */
+    bool replay(Game &game, std::optional<std::size_t> plies = std::nullopt) const;
+};
+
+/**
+ * a memory mapped archive written by `GameArchiveWriter`, any game can be opened in O(1)
+ */
+class GameArchive {
+   private:
+    MappedFile _file;
+    std::span<const std::byte> _index;
+
+   public:
+    /**
+     * returns `std::nullopt` if the file can't be opened or isn't a complete archive
+     */
+    static std::optional<GameArchive> open(const std::string &path);
+    std::size_t size() const;
+    /**
+     * returns `std::nullopt` if `index` is out of range or the record is corrupt
+     */
+    std::optional<ArchivedGame> game(std::size_t index) const;
+
+   private:
+    GameArchive(MappedFile file, std::span<const std::byte> index);
+};
+
+/**
+ * appends games to a new archive as they're finished, the index is kept in memory
+ * and written by `close()` or the destructor
+ */
+class GameArchiveWriter {
+   private:
+    std::ofstream _out;
+    std::vector<std::uint64_t> _offsets;
+    std::uint64_t _position;
+
+   public:
+    GameArchiveWriter(GameArchiveWriter &&other) = default;
+    /**
+     * closes the archive this writer had open before taking over `other`'s
+     */
+    GameArchiveWriter &operator=(GameArchiveWriter &&other);
+    ~GameArchiveWriter();
+    /**
+     * truncates `path`, returns `std::nullopt` if it can't be written
+     */
+    static std::optional<GameArchiveWriter> create(const std::string &path);
+    /**
+     * appends the moves of `game` from the position it was set up from,
+     * returns `false` if the game isn't on a 64-square board or the file can't be written
+     */
+    bool append(const Game &game, WinSearchResult result = WinSearchResult::nothing);
+    /**
+     * appends a game given as a FEN string (empty for the standard starting position)
+     * and moves in UCI notation, the moves aren't checked for legality,
+     * returns `false` if one of them doesn't name two squares or the file can't be written
+     */
+    bool append(std::string_view fen, std::span<const std::string> moves,
+                WinSearchResult result = WinSearchResult::nothing);
+    std::size_t size() const;
+    /**
+     * writes the index, returns `false` if the archive couldn't be written completely
+     */
+    bool close();
+
+   private:
+    GameArchiveWriter(std::ofstream out);
+};
+
+}  // namespace chess
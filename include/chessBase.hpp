@@ -1,23 +1,27 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <functional>
-#include <map>
-#include <memory>
 #include <optional>
 #include <string>
 #include <utility>
 
-#include "SDL_pixels.h"
-#include "SDL_render.h"
-
 namespace chess {
 
 template <class Ty>
 using OptionalRef = std::optional<std::reference_wrapper<Ty>>;
 
+/**
+ * the standard starting position
+ */
+inline constexpr const char *startingFEN =
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
 class Player;
 class Board;
 class Piece;
+class Game;
 
 enum class WinSearchResult {
     nothing,
@@ -35,16 +39,59 @@ enum class MoveType { normal, enPassant, shortCastle, longCastle };
 
 enum class RunResult { invalid, still, turnedPassed, awaitPromotion };
 
+/**
+ * why `Game::tryApplyMove()` didn't make a move
+ */
+enum class MoveError {
+    none,
+    /**
+     * neither UCI notation nor SAN, or it names a square the board doesn't have
+     */
+    malformed,
+    /**
+     * no legal move of the side to move is the one named
+     */
+    illegal,
+    /**
+     * SAN that names more than one legal move
+     */
+    ambiguous,
+    /**
+     * a pawn reaching the last rank without a promotion, or a promotion on any other move
+     */
+    promotion,
+};
+
+/**
+ * same layout as `SDL_Color`, so the core library doesn't depend on SDL
+ */
+struct Color {
+    std::uint8_t r;
+    std::uint8_t g;
+    std::uint8_t b;
+    std::uint8_t a;
+};
+
+/**
+ * same layout as `SDL_Rect`, so the core library doesn't depend on SDL
+ */
+struct Rect {
+    int x;
+    int y;
+    int w;
+    int h;
+};
+
 struct BoardColors {
-    SDL_Color light;
-    SDL_Color dark;
-    SDL_Color outline;
+    Color light;
+    Color dark;
+    Color outline;
 };
 
 struct BoardSquare {
     std::string position;
-    SDL_Rect rect;
-    SDL_Color color;
+    Rect rect;
+    Color color;
 };
 
 struct Move {
@@ -54,46 +101,46 @@ struct Move {
     std::string end;
     std::optional<MoveType> type = std::nullopt;
     bool PiecePromoted = false;
+    /**
+     * what a pawn reaching the last rank promotes to (`q`, `r`, `n` or `b`),
+     * when it's not set `Game::makeMove()` asks the player
+     */
+    char promotion = '\0';
 
     auto operator<=>(const Move &) const = default;
 };
 
-struct SDLTextureDeleter {
-    void operator()(SDL_Texture *t);
-};
-
-struct PieceSprite {
-    SDL_Texture *texture;
-    SDL_Rect source;
-};
-
-struct PieceSpriteSheet {
-    int width;
-    int height;
-    int horizontalFrames;
-    int verticalFrames;
-    std::unique_ptr<SDL_Texture, SDLTextureDeleter> texture;
+/**
+ * what `Game::tryApplyMoves()` did, the first `applied` moves were made and `error` is why the
+ * next one wasn't, `MoveError::none` if all of them were made
+ */
+struct MoveBatchResult {
+    std::size_t applied;
+    MoveError error;
 };
 
-inline std::map<int, std::function<void(SDL_Renderer *ren)>> drawQueue{};
-inline std::map<std::pair<char, PieceColor>, PieceSprite> spriteMap{};
-inline PieceSpriteSheet sheet{};
-
-inline constexpr SDL_Color defaultLightBrown = {237, 214, 176, 255};
-inline constexpr SDL_Color defaultDarkBrown = {184, 135, 98, 255};
-inline constexpr SDL_Color defaultLightBlue = {100, 100, 255, 255};
-inline constexpr SDL_Color defaultDarkBlue = {10, 10, 100, 255};
+inline constexpr Color defaultLightBrown = {237, 214, 176, 255};
+inline constexpr Color defaultDarkBrown = {184, 135, 98, 255};
+inline constexpr Color defaultLightBlue = {100, 100, 255, 255};
+inline constexpr Color defaultDarkBlue = {10, 10, 100, 255};
 
-/**
- * used to render things from `Game::run()` without causing flickers
- */
-void renderDrawQueue(SDL_Renderer *ren, SDL_Color color);
-void createSpriteSheet(std::string path, int width, int height, int horizontalFrames,
-                       int verticalFrames, SDL_Renderer *ren);
-void setPieceSprite(char type, PieceColor color, int hFrame, int vFrame);
 std::string pairToChessPos(std::pair<int, int> p);
 std::pair<int, int> chessPosToPair(std::string s);
-std::pair<int, int> absDistance(std::string start, std::string end);
-std::pair<int, int> relativeDistance(std::string start, std::string end);
+/**
+ * files and ranks between two squares, looked up in `chessTables.hpp` on an 8x8 board
+ */
+std::pair<int, int> absDistance(const std::string &start, const std::string &end);
+/**
+ * `start - end` in files and ranks
+ */
+std::pair<int, int> relativeDistance(const std::string &start, const std::string &end);
+/**
+ * the move in UCI notation, like `e2e4` or `e7e8q`
+ */
+std::string moveToUCI(const Move &move);
+/**
+ * `threads` if it's positive, one per core otherwise
+ */
+int threadCount(int threads);
 
-}  // namespace chess
\ No newline at end of file
+}  // namespace chess
@@ -6,17 +6,18 @@
 #include <utility>
 #include <vector>
 
-#include "SDL_pixels.h"
-#include "SDL_render.h"
 #include "chessBase.hpp"
+#include "chessPieceArena.hpp"
+#include "chessPosition.hpp"
 
 namespace chess {
 
 class Board {
-   private:
-    SDL_Renderer *_ren;
-
    public:
+    /**
+     * where the board's pieces are allocated, declared first so it's released last
+     */
+    std::unique_ptr<PieceArena, PieceArena::Detach> pieceArena;
     std::map<std::string, std::unique_ptr<Piece>> pieceMap;
     std::map<std::string, BoardSquare> squaresMap;
     int length;
@@ -26,21 +27,46 @@ class Board {
     BoardColors colors;
 
    public:
+    /**
+     * `numSquares` has to be the square of a side length from 1 to 16, see `chessGeometry.hpp`,
+     * other values leave the board without squares
+     */
     Board(int length, int numSquares, bool flipped, std::pair<int, int> offset, BoardColors colors,
-          bool createPieceMap, SDL_Renderer *ren);
+          bool createPieceMap);
+    /**
+     * a board for the rules only, with no size, offset or colors to draw it with,
+     * `numSquares` is as above
+     */
+    Board(int numSquares, bool createPieceMap);
+    /**
+     * a board of 64 squares with the pieces of `position` on it
+     */
+    Board(const Position &position, int length, bool flipped, std::pair<int, int> offset,
+          BoardColors colors);
     /**
      * creates a map with the default pieces in their default locations, like in regular chess,
      * it can be called in the constructor
      */
     void createDefaultPieceMap();
     void clear();
+    /**
+     * replaces the pieces with those of `position`, pawns on their starting rank and the kings and
+     * rooks `position` lets castle count as unmoved, does nothing unless the board has 64 squares
+     */
+    void setPieces(const Position &position);
+    /**
+     * the pieces and castling rights of a board of 64 squares, the side to move, en passant file
+     * and clocks are those of a new game, `Game::position()` fills them in
+     */
+    Position position() const;
     void updateSquaresPosition();
     void updateSquaresColor();
-    void draw();
-    void drawSquareOutline(BoardSquare square, SDL_Color color);
-    void renderPieces();
     void flip();
     void keepCentered(int areaWidth, int areaHeight);
+    /**
+     * the number of files and ranks, 0 if `numSquares` isn't a supported size
+     */
+    int sideLength() const;
     /**
      * attempts to make a move, whether it's legal or not,
      * if `move.endPiece` isn't nullptr the piece it points to will be captured and deleted,
@@ -54,8 +80,6 @@ class Board {
      * returns `true` if the move was made, otherwise `false`
      */
     bool makeMove(Move move, std::vector<std::unique_ptr<Piece>> &capturedPieces);
-    OptionalRef<BoardSquare> getSquareUnderCursor();
-    void highlightSquareUnderCursor(int increment);
 };
 
-}  // namespace chess
\ No newline at end of file
+}  // namespace chess
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "chessBase.hpp"
+#include "chessGame.hpp"
+#include "chessNNUE.hpp"
+
+namespace chess {
+
+/**
+ * times are in milliseconds, a search without any limit runs until it's stopped
+ */
+struct SearchLimits {
+    std::optional<int> depth = std::nullopt;
+    std::optional<std::int64_t> nodes = std::nullopt;
+    std::optional<int> moveTime = std::nullopt;
+    std::optional<int> whiteTime = std::nullopt;
+    std::optional<int> blackTime = std::nullopt;
+    int whiteIncrement = 0;
+    int blackIncrement = 0;
+    std::optional<int> movesToGo = std::nullopt;
+    bool infinite = false;
+    /**
+     * how many of the best moves get a score and a principal variation, every iteration reports
+     * one `SearchInfo` per move, best first
+     */
+    int multiPV = 1;
+};
+
+/**
+ * shared between the thread running the search and the one controlling it,
+ * while `ponder` is set the clock doesn't run, clearing it (a ponderhit) starts it
+ */
+struct SearchSignals {
+    std::atomic<bool> stop = false;
+    std::atomic<bool> ponder = false;
+};
+
+struct SearchInfo {
+    int depth;
+    /**
+     * centipawns from the point of view of the side to move
+     */
+    int score;
+    /**
+     * moves until mate, negative if the side to move gets mated
+     */
+    std::optional<int> mateIn;
+    std::int64_t nodes;
+    std::int64_t timeMs;
+    /**
+     * principal variation in UCI notation
+     */
+    std::vector<std::string> pv;
+    /**
+     * the rank of the line, from 1 to `SearchLimits::multiPV`
+     */
+    int multiPV = 1;
+};
+
+using InfoCallback = std::function<void(const SearchInfo &info)>;
+
+class Engine {
+   public:
+    virtual std::string name() const = 0;
+    /**
+     * searches the current position of `game` and returns the best move found,
+     * `game` is used as a scratch board and is back in its original position when this returns,
+     * `onInfo` is called from the searching thread for every line of every completed iteration
+     */
+    virtual std::optional<Move> search(Game &game, const SearchLimits &limits,
+                                       SearchSignals &signals, const InfoCallback &onInfo) = 0;
+    /**
+     * forgets anything learned about the previous game
+     */
+    virtual void newGame() {}
+    virtual ~Engine() {}
+};
+
+/**
+ * how long to think about a move given the limits, `std::nullopt` if there's no time limit
+ */
+std::optional<std::chrono::milliseconds> timeBudget(const SearchLimits &limits,
+                                                    PieceColor sideToMove);
+
+/**
+ * iterative deepening alpha-beta search that counts material
+ */
+class MaterialEngine : public Engine {
+   public:
+    std::string name() const override;
+    std::optional<Move> search(Game &game, const SearchLimits &limits, SearchSignals &signals,
+                               const InfoCallback &onInfo) override;
+    ~MaterialEngine() override {}
+};
+
+/**
+ * the same search as `MaterialEngine` with the positions evaluated by a network, see
+ * `chessNNUE.hpp`
+ */
+class NNUEEngine : public Engine {
+   private:
+    nnue::Evaluator _evaluator;
+
+   public:
+    explicit NNUEEngine(std::shared_ptr<const nnue::Network> network);
+    std::string name() const override;
+    std::optional<Move> search(Game &game, const SearchLimits &limits, SearchSignals &signals,
+                               const InfoCallback &onInfo) override;
+    ~NNUEEngine() override {}
+};
+
+}  // namespace chess
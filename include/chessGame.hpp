@@ -1,14 +1,24 @@
 #pragma once
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
-#include "SDL_events.h"
 #include "chessBase.hpp"
 #include "chessBoard.hpp"
+#include "chessGeometry.hpp"
+#include "chessMaterial.hpp"
+#include "chessMoveList.hpp"
 #include "chessPiece.hpp"
+#include "chessPosition.hpp"
 
 namespace chess {
 
@@ -21,16 +31,179 @@ class Player {
 
    public:
     Player(PieceColor color_);
-    virtual std::optional<Move> handleEvents(Board &board, SDL_Event event);
+    /**
+     * called by `Game::run()` when it's this player's turn,
+     * returns the move the player wants to make or `std::nullopt` if it hasn't decided yet,
+     * the default player never moves on its own
+     */
+    virtual std::optional<Move> chooseMove(Game &game);
+    /**
+     * called by `Game::defaultPromotionHandler()` when one of this player's pawns has to be
+     * promoted, returns the notation of the new piece (`q`, `r`, `n` or `b`) or `std::nullopt`
+     * to keep the game waiting, the default player always picks a queen
+     */
+    virtual std::optional<char> choosePromotion(Game &game, Piece &pawn);
     virtual ~Player() {};
 };
 
 class Game {
+   private:
+    RunResult handlePromotion(
+        Piece *piece, const std::optional<std::function<RunResult(Piece *piece)>> &promotionFn);
+    /**
+     * points the last move of `moveLog`, or `_fenLastMove` if no moves were made, at the pieces
+     * it moved and captured
+     */
+    void bindLastMove();
+    /**
+     * points the moves of `moveLog` for which `captured(ply)` is set at the pieces their side
+     * captured, in order, and the others at none, after the pieces were recreated, the pieces
+     * they moved are forgotten, `bindLastMove()` gives the last one its own back
+     */
+    void bindCaptures(const std::function<bool(std::size_t ply)> &captured);
+    /**
+     * the file of the pawn the last move pushed two squares if the side to move can take it en
+     * passant, 0 if it can't, so the same position has the same hash and FEN however it was
+     * reached
+     */
+    int enPassantFile();
+    /**
+     * makes `move` for the current player, it has to be legal and have its `type` set
+     */
+    RunResult applyMove(Move &move,
+                        const std::optional<std::function<RunResult(Piece *piece)>> &promotionFn);
+    /**
+     * sets `move` to the move of `legalMoves()` that `text` names in UCI notation or SAN, with
+     * its promotion, or returns why there's none
+     */
+    MoveError findLegalMove(std::string_view text, Move &move);
+
    protected:
-    SDL_Event &_event;
-    std::vector<std::string> _positions;
+    /**
+     * a piece of a `Checkpoint`, its FEN letter, its square numbered
+     * `(file - 1) + 16 * (rank - 1)`, and how often it moved
+     */
+    struct CheckpointPiece {
+        char letter;
+        std::uint8_t square;
+        std::uint16_t moveCount;
+    };
+
+    /**
+     * the state of the game after a multiple of `checkpointInterval` plies of `_line`, the pieces
+     * on the board come first, then those captured by `player1` and by `player2` in the order
+     * they were captured, so `undoLastMove()` can put them back
+     */
+    struct Checkpoint {
+        std::array<CheckpointPiece, 32> pieces;
+        std::uint8_t onBoard;
+        std::uint8_t capturedByPlayer1;
+        std::uint8_t capturedByPlayer2;
+        PieceColor sideToMove;
+        int movesUntilDraw;
+        int turnCount;
+        int moveCount;
+        material::Key material;
+    };
+
+    /**
+     * a move of `_line` with what `moveLogText` and the logs next to `moveLog` hold for it
+     */
+    struct LineMove {
+        Move move;
+        std::string text;
+        std::uint64_t position;
+        int movesUntilDraw;
+        material::Key material;
+    };
+
+    /**
+     * `positionHash()` after each move of `moveLog`
+     */
+    std::vector<std::uint64_t> _positions;
+    /**
+     * the double pawn push a FEN string's en passant square implies, if there was one
+     */
+    std::optional<Move> _fenLastMove;
+    /**
+     * `movesUntilDraw` before each move of `moveLog`, so it can be restored by `undoLastMove()`
+     */
+    std::vector<int> _movesUntilDrawLog;
+    /**
+     * the pieces on the board by type and side, updated by captures and promotions, and the key
+     * before each move of `moveLog` so `undoLastMove()` can put it back
+     */
+    material::Key _material;
+    std::vector<material::Key> _materialLog;
+    std::string _startFEN;
+    /**
+     * legal moves of the side to move, grouped by start square, only valid while
+     * `_legalMovesValid` is set, allocated by the first `legalMoves()` and freed by `reset()`
+     * so a game that isn't asked for them doesn't carry a full `MoveList`
+     */
+    std::unique_ptr<MoveList> _legalMoves;
+    bool _legalMovesValid;
+    /**
+     * where the moves of each square begin and end in `_legalMoves`,
+     * squares are numbered `(file - 1) + 16 * (rank - 1)`
+     */
+    std::array<std::pair<std::uint16_t, std::uint16_t>, maxBoardSide * maxBoardSide>
+        _legalMovesFrom;
+    /**
+     * the moves `seekToPly()` goes along, `moveLog` and the moves a seek went back over
+     */
+    std::vector<LineMove> _line;
+    /**
+     * how many moves at the start of `moveLog` are those of `_line`, moves made after them, like
+     * those of a search, leave the line alone until the next seek
+     */
+    std::size_t _onLine;
+    /**
+     * the checkpoints of `_line` indexed by ply / `checkpointInterval`, taken as the moves are
+     * made
+     */
+    std::vector<std::optional<Checkpoint>> _checkpoints;
+    /**
+     * those of the moves of `moveLog` past `_onLine`, which become the line's at the next seek
+     */
+    std::vector<std::optional<Checkpoint>> _branchCheckpoints;
+
+    /**
+     * the current state as a checkpoint, `std::nullopt` if it has more than 32 pieces
+     */
+    std::optional<Checkpoint> checkpoint();
+    /**
+     * where the checkpoint of ply `ply` of `moveLog` is kept, in `_checkpoints` if the ply is on
+     * the line and in `_branchCheckpoints` if it isn't
+     */
+    std::optional<Checkpoint> &checkpointSlot(std::size_t ply);
+    /**
+     * takes the checkpoint of the current ply if it's a multiple of `checkpointInterval`, none
+     * while a promotion is pending
+     */
+    void saveCheckpoint();
+    /**
+     * takes `checkpoint` of the ply after move `ply` of `moveLog` back to the ply before it
+     * without touching the board, returns `false` if it doesn't have the pieces the move needs
+     */
+    bool takeBack(Checkpoint &checkpoint, std::size_t ply) const;
+    /**
+     * puts the game back to ply `ply` of `_line` from `checkpoint`
+     */
+    void restore(const Checkpoint &checkpoint, std::size_t ply);
+    /**
+     * replaces the pieces on the board and the captured ones with `pieces`, ordered like those of
+     * a `Checkpoint`
+     */
+    void placePieces(std::span<const CheckpointPiece> pieces, std::size_t onBoard,
+                     std::size_t capturedByPlayer1);
 
    public:
+    /**
+     * plies between the checkpoints `seekToPly()` restores
+     */
+    static constexpr std::size_t checkpointInterval = 16;
+
     bool running;
     std::vector<std::string> moveLogText;
     std::vector<Move> moveLog;
@@ -43,27 +216,198 @@ class Game {
     int moveCount;
 
    public:
-    Game(Board &board, Player &player1, Player &player2, SDL_Event &event);
+    Game(Board &board, Player &player1, Player &player2);
+    /**
+     * a game set up from `position` with `loadPosition()`
+     */
+    Game(Board &board, Player &player1, Player &player2, const Position &position);
     virtual ~Game() {}
     std::optional<RunResult> start();
     /**
-     * if a promotion is possible, `promotionFn` will be called to handle user input for the
-     * promotion, if no function or lambda is provided, keyboard input will be used,
-     * the default is: `Q` = queen, `R` = rook, `N` = knight, `B` = bishop,
-     * and, the promoted pawn gets deleted and replaced with a new piece,
+     * asks the current player for a move and makes it with `makeMove()`,
+     * if a promotion is still pending, `promotionFn` will be called to handle the promotion first,
+     * if no function or lambda is provided, `defaultPromotionHandler()` will be used,
+     * the promoted pawn gets deleted and replaced with a new piece,
      * trying to access the pawn through a pointer after a promotion will probably crash your game
      */
     virtual RunResult run(
         std::optional<std::function<RunResult(Piece *piece)>> promotionFn = std::nullopt);
+    /**
+     * makes `move` for the current player if it's legal, without asking the player,
+     * a promotion is done right away if `move.promotion` is set,
+     * returns `RunResult::turnedPassed` if the move was made, `RunResult::still` if it wasn't,
+     * and `RunResult::awaitPromotion` if the move was made but the promotion it allows couldn't
+     * be handled right away, in which case `run()` will keep trying
+     */
+    RunResult makeMove(Move move, std::optional<std::function<RunResult(Piece *piece)>>
+                                      promotionFn = std::nullopt);
     void logMove(Move move);
     bool isKingInCheck(PieceColor color);
     bool isMoveLegal(Move &move, const Player &player);
     void undoLastMove();
+    /**
+     * goes to ply `ply` of the game's line, 0 being where its moves started, the line is `moveLog`
+     * and the moves a previous seek went back over, so a game can be scrubbed back and forth,
+     * the closest checkpoint is restored and at most `checkpointInterval` / 2 moves are replayed
+     * or undone, making a move other than the line's next one and seeking again makes the
+     * game's moves the line,
+     * returns `false` and leaves the game as it is if the line is shorter than `ply`
+     */
+    bool seekToPly(std::size_t ply);
+    /**
+     * plies of the line `seekToPly()` goes along
+     */
+    std::size_t lineLength() const;
     Piece *lookForPromotion();
+    /**
+     * replaces `pawn` with a new piece of type `notation` (`q`, `r`, `n` or `b`),
+     * returns `false` if `notation` isn't a piece a pawn can promote to
+     */
+    bool promote(Piece *pawn, char notation);
+    /**
+     * asks the owner of `piece` what it wants to promote to through `Player::choosePromotion()`
+     */
     RunResult defaultPromotionHandler(Piece *piece);
     void reset(std::optional<std::function<void()>> boardResetFn = std::nullopt);
     std::vector<Move> getLegalMoves(Piece &piece, Player &player);
+    /**
+     * adds the legal moves of `piece` to `moves` without allocating,
+     * returns `false` if some didn't fit
+     */
+    bool getLegalMoves(Piece &piece, Player &player, MoveList &moves);
+    /**
+     * legal moves of every piece of `player`
+     */
+    std::vector<Move> getLegalMoves(Player &player);
+    /**
+     * adds the legal moves of every piece of `player` to `moves` without allocating,
+     * returns `false` if some didn't fit
+     */
+    bool getLegalMoves(Player &player, MoveList &moves);
+    /**
+     * legal moves of the side to move, generated once per position and kept until a move is made,
+     * undone or promoted, or the game is reset, the span is only valid until then, the list they're
+     * kept in is allocated by the first call after the game was reset
+     */
+    std::span<const Move> legalMoves();
+    /**
+     * the moves of `legalMoves()` starting on `square`, empty if there are none
+     */
+    std::span<const Move> legalMovesFrom(const std::string &square);
+    /**
+     * whether the side to move can move from `start` to `end`, answered from `legalMoves()`
+     */
+    bool isLegalMove(const std::string &start, const std::string &end);
+    /**
+     * drops the cached `legalMoves()` and the line of `seekToPly()` and counts `materialKey()`
+     * again, only needed after changing `board` without going through the game
+     */
+    void invalidateLegalMoves();
+    /**
+     * how many pieces of each type both sides have, kept up to date as moves are made, undone and
+     * promoted, see `material::Key`
+     */
+    material::Key materialKey() const;
+    /**
+     * checkmate or stalemate of the side to move, or one of the draws by rule, insufficient
+     * material is looked up from `materialKey()`
+     */
     WinSearchResult lookForWin();
+    /**
+     * the last move of `moveLog`, or the double pawn push implied by the en passant square of the
+     * last FEN string loaded if no moves were made since
+     */
+    std::optional<Move> lastMove();
+    /**
+     * resets the game to the position of a FEN string, including the side to move,
+     * castling rights, en passant square and clocks, the board needs to have 64 squares,
+     * returns `false` and leaves the game untouched if `fen` isn't valid
+     */
+    bool loadFEN(const std::string &fen);
+    std::string getFEN();
+    /**
+     * resets the game to `position` like `loadFEN()` does, returns `false` and leaves the game
+     * untouched if the board doesn't have 64 squares or `position` doesn't have one king per side
+     */
+    bool loadPosition(const Position &position);
+    /**
+     * the current position as a plain value, see `Position`
+     */
+    Position position();
+    /**
+     * everything the game needs to go on from where it is, so it can be put away and brought
+     * back by `loadState()` without replaying its moves, all integers are little endian:
+     *
+     *   state:  "CHSGAM02", u16 number of squares, u8 side to move (0 white, 1 black),
+     *           u8 `running`, i16 `movesUntilDraw`, u32 `turnCount`, u32 `moveCount`,
+     *           u16 FEN length, `startFEN()`, u8 1 if the FEN had an en passant square and then
+     *           u8 start and u8 end square of the double pawn push it implies,
+     *           u16 pieces on the board, u16 captured by white, u16 captured by black, pieces,
+     *           u32 number of plies, plies, u64 FNV-1a checksum of everything before it
+     *   piece:  u8 FEN letter, u8 square, u16 move count
+     *   ply:    u8 start square, u8 end square, u8 `MoveType` | 4 if it captured | 8 if it
+     *           promoted | promotion << 4 (0 none, 1 queen, 2 rook, 3 knight, 4 bishop),
+     *           i16 `movesUntilDraw` before it, u64 `positionHash()` after it, u8 text length,
+     *           its `moveLogText`
+     *
+     * squares are numbered `(file - 1) + 16 * (rank - 1)`, captured pieces are in the order they
+     * were captured, about 20 bytes per ply and 4 per piece
+     */
+    std::string saveState() const;
+    /**
+     * resets the game to a state from `saveState()` of a game on a board with as many squares,
+     * the line of `seekToPly()` starts over from its moves, whose checkpoints are worked out
+     * backwards from the state, returns `false` and leaves the game untouched if `blob` isn't
+     * valid, the moves aren't replayed, a damaged state is caught by its checksum
+     */
+    bool loadState(std::span<const std::byte> blob);
+    /**
+     * the FEN string the game was last set up from with `loadFEN()`,
+     * empty if it was set up with the default piece map
+     */
+    const std::string &startFEN() const;
+    /**
+     * a 64-bit Zobrist hash of the pieces, side to move, castling rights and en passant file if
+     * the capture can be made, the same for the same position however it was reached, for boards
+     * up to 16x16
+     */
+    std::uint64_t positionHash();
+    /**
+     * turns a move in UCI notation (`e2e4`, `e7e8q`) into a `Move` on the current board,
+     * the move isn't checked for legality, returns `std::nullopt` if it doesn't name two squares
+     * of the board or a valid promotion
+     */
+    std::optional<Move> moveFromUCI(const std::string &uci);
+    /**
+     * makes the move `text` names in UCI notation (`e2e4`, `e7e8q`) or SAN (`Nf3`, `exd5`,
+     * `e8=Q+`) if it's one of `legalMoves()`, without checking it again like `makeMove()` does,
+     * a promotion has to be named, SAN's `x`, `+`, `#`, `!` and `?` are optional, doesn't throw
+     * or allocate other than to grow the logs and for the first `legalMoves()` after a reset,
+     * returns `MoveError::none` if the move was made
+     */
+    MoveError tryApplyMove(std::string_view text);
+    /**
+     * `tryApplyMove()` for each of `moves` in order, stopping at the first one that isn't made
+     */
+    MoveBatchResult tryApplyMoves(std::span<const std::string_view> moves);
+};
+
+/**
+ * a game on a board for the rules only, between two default players, for code that drives the
+ * game itself, `game` refers to the other members so it can't be copied or moved
+ */
+struct HeadlessGame {
+    Board board;
+    Player white;
+    Player black;
+    Game game;
+
+    /**
+     * an empty board, or the default pieces if `createPieceMap` is set
+     */
+    explicit HeadlessGame(bool createPieceMap = false);
+    HeadlessGame(const HeadlessGame &) = delete;
+    HeadlessGame &operator=(const HeadlessGame &) = delete;
 };
 
-}  // namespace chess
\ No newline at end of file
+}  // namespace chess
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <array>
+#include <string_view>
+#include <utility>
+
+#include "chessBase.hpp"
+
+/**
+ * board geometry as a compile-time parameter, squares are numbered `(file - 1) + side * (rank - 1)`
+ * from a1, their names are a file and a rank character like everywhere else in the library
+ * (`pairToChessPos()`), so ranks past 9 continue with `:`, `;` and so on
+ */
+
+namespace chess {
+
+inline constexpr int maxBoardSide = 16;
+
+namespace detail {
+
+template <int Side>
+struct ArithmeticGeometry {
+    static_assert(Side >= 1 && Side <= maxBoardSide, "boards go up to 16x16");
+
+    static constexpr int side = Side;
+    static constexpr int squares = Side * Side;
+
+    static constexpr int file(int square) { return square % Side + 1; }
+    static constexpr int rank(int square) { return square / Side + 1; }
+    static constexpr int index(int file, int rank) { return (file - 1) + Side * (rank - 1); }
+    static constexpr bool contains(int file, int rank) {
+        return file >= 1 && file <= Side && rank >= 1 && rank <= Side;
+    }
+    static constexpr bool isDark(int square) { return (file(square) + rank(square)) % 2 == 0; }
+
+    /**
+     * where the square is drawn on a board of `length` pixels,
+     * a1 is at the top right unless the board is flipped
+     */
+    static constexpr Rect rect(int square, int length, std::pair<int, int> offset, bool flipped) {
+        int lengthOfSquare = length / Side;
+        int column = flipped ? file(square) - 1 : Side - file(square);
+        int row = flipped ? Side - rank(square) : rank(square) - 1;
+
+        return {column * lengthOfSquare + offset.first, row * lengthOfSquare + offset.second,
+                lengthOfSquare, lengthOfSquare};
+    }
+
+    static constexpr auto names = [] {
+        std::array<std::array<char, 2>, squares> ret{};
+
+        for (int i = 0; i < squares; i++) {
+            ret[i] = {static_cast<char>('a' + i % Side), static_cast<char>('1' + i / Side)};
+        }
+
+        return ret;
+    }();
+
+    static constexpr std::string_view name(int square) {
+        return {names[square].data(), names[square].size()};
+    }
+};
+
+}  // namespace detail
+
+/**
+ * the generic path for variant sizes, everything is computed from the compile-time side length
+ */
+template <int Side>
+struct BoardGeometry : detail::ArithmeticGeometry<Side> {};
+
+/**
+ * standard chess, square queries are lookups in a table built at compile time
+ */
+template <>
+struct BoardGeometry<8> : detail::ArithmeticGeometry<8> {
+   private:
+    using Base = detail::ArithmeticGeometry<8>;
+
+    struct SquareInfo {
+        int file;
+        int rank;
+        bool dark;
+    };
+
+    static constexpr auto _squares = [] {
+        std::array<SquareInfo, 64> ret{};
+
+        for (int i = 0; i < 64; i++) {
+            ret[i] = {Base::file(i), Base::rank(i), Base::isDark(i)};
+        }
+
+        return ret;
+    }();
+
+   public:
+    static constexpr int file(int square) { return _squares[square].file; }
+    static constexpr int rank(int square) { return _squares[square].rank; }
+    static constexpr bool isDark(int square) { return _squares[square].dark; }
+};
+
+/**
+ * calls `fn(BoardGeometry<side>{})` for a board of `numSquares` squares, so loops over the board
+ * get a compile-time size, 8x8 boards take the table-driven specialization,
+ * returns `false` without calling `fn` if the board isn't a square of at most 16x16
+ */
+template <class Function>
+bool withBoardGeometry(int numSquares, Function &&fn) {
+    bool ret = numSquares == 64;
+
+    if (ret) {
+        fn(BoardGeometry<8>{});
+    } else {
+        ret = [&]<int... Sides>(std::integer_sequence<int, Sides...>) -> bool {
+            return ((numSquares == (Sides + 1) * (Sides + 1) &&
+                     (fn(BoardGeometry<Sides + 1>{}), true)) ||
+                    ...);
+        }(std::make_integer_sequence<int, maxBoardSide>{});
+    }
+
+    return ret;
+}
+
+}  // namespace chess
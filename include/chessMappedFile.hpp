@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+
+namespace chess {
+
+/**
+ * a read-only view of a whole file, memory mapped where the platform supports it
+ * and read into memory otherwise
+ */
+class MappedFile {
+   private:
+    const std::byte *_data;
+    std::size_t _size;
+    /**
+     * the buffer the file was read into when it couldn't be mapped
+     */
+    std::byte *_buffer;
+
+   public:
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+    MappedFile(MappedFile &&other) noexcept;
+    MappedFile &operator=(MappedFile &&other) noexcept;
+    ~MappedFile();
+    /**
+     * returns `std::nullopt` if the file can't be opened
+     */
+    static std::optional<MappedFile> open(const std::string &path);
+    std::span<const std::byte> bytes() const;
+
+   private:
+    MappedFile();
+    void release();
+};
+
+/**
+ * reads an unsigned little endian integer of `bytes.size()` bytes
+ */
+std::uint64_t readLittleEndian(std::span<const std::byte> bytes);
+/**
+ * appends the `bytes` lowest bytes of `value` to `out`, least significant first
+ */
+void appendLittleEndian(std::string &out, std::uint64_t value, std::size_t bytes);
+
+}  // namespace chess
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "chessBase.hpp"
+#include "chessBoard.hpp"
+#include "chessGame.hpp"
+#include "chessMoveList.hpp"
+#include "chessPosition.hpp"
+
+namespace chess {
+
+struct MateResult {
+    /**
+     * first moves in UCI notation that mate in at most the given number of moves
+     * whatever the defender plays
+     */
+    std::vector<std::string> mates;
+    /**
+     * first moves proven not to mate in time
+     */
+    std::vector<std::string> refuted;
+    /**
+     * first moves left unproven when the node limit was reached
+     */
+    std::vector<std::string> unknown;
+    std::int64_t nodes;
+
+    /**
+     * whether every first move is in `mates` or `refuted`, an empty `mates` is then a proof that
+     * there's no mate
+     */
+    bool complete() const;
+};
+
+/**
+ * proves or disproves mates in N with a depth-first proof-number search (df-pn), the side to move
+ * is the attacker, a mate has to be forced against every defence
+ *
+ * positions are only asked whether they're check and what their legal moves are, nothing is
+ * evaluated, proof and disproof numbers are kept in a table of its own by position and plies
+ * left, kept from one `solve()` to the next, a solver isn't thread safe, use one per thread
+ */
+class MateSolver {
+   private:
+    struct Entry {
+        std::uint64_t key;
+        std::uint32_t proof;
+        std::uint32_t disproof;
+    };
+
+    /**
+     * the moves of a node being searched and what's known of their positions
+     */
+    struct Children {
+        MoveList moves;
+        std::array<std::uint64_t, MoveList::capacity> keys;
+        std::array<std::uint32_t, MoveList::capacity> proof;
+        std::array<std::uint32_t, MoveList::capacity> disproof;
+    };
+
+    std::vector<Entry> _table;
+    Board _board;
+    Player _white;
+    Player _black;
+    Game _game;
+    std::deque<Children> _children;
+    PieceColor _attacker;
+    std::int64_t _nodes;
+    std::int64_t _maxNodes;
+
+   public:
+    /**
+     * `tableEntries` is rounded up to a power of two, each entry takes 16 bytes
+     */
+    explicit MateSolver(std::size_t tableEntries = std::size_t{1} << 20);
+    /**
+     * which first moves of `position` mate in at most `moves` moves, searching at most
+     * `maxNodes` nodes
+     */
+    MateResult solve(const Position &position, int moves, std::int64_t maxNodes = 10'000'000);
+
+   private:
+    std::uint64_t key(std::uint64_t hash, int plies) const;
+    /**
+     * points `move` to the pieces now on its squares, undoing a promotion replaces pieces
+     */
+    void refresh(Move &move);
+    /**
+     * the legal moves of the side to move into `moves`, once per promotion piece
+     */
+    void generate(MoveList &moves);
+    /**
+     * searches the current position, which has `plies` plies left, until its proof number
+     * reaches `proofLimit` or its disproof number `disproofLimit`, stores and returns both
+     */
+    std::pair<std::uint32_t, std::uint32_t> search(std::uint64_t nodeKey, int plies,
+                                                   std::uint32_t proofLimit,
+                                                   std::uint32_t disproofLimit);
+};
+
+}  // namespace chess
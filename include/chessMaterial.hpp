@@ -0,0 +1,215 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "chessBase.hpp"
+
+/**
+ * the material of a position as one number, kept up to date by `Game` as moves are made, and what
+ * it says about the endgame, whether either side can still mate and how to score it, looked up in
+ * a table generated at compile time
+ */
+
+namespace chess::material {
+
+/**
+ * the number of pawns, knights, bishops on light squares, bishops on dark squares, rooks and
+ * queens of each side in 4 bits each, white's in the low 24 bits, kings aren't counted,
+ * bishops are told apart by square color since they can never leave it
+ */
+using Key = std::uint64_t;
+
+enum class Endgame : std::uint8_t {
+    /**
+     * scored as usual
+     */
+    none,
+    /**
+     * no sequence of moves can end in a mate, the game is drawn
+     */
+    insufficientMaterial,
+    /**
+     * a mate is possible but can't be forced without a blunder, like two knights against a king
+     * or a minor piece each
+     */
+    drawish,
+    /**
+     * one side has only its king and the other enough to force a mate
+     */
+    loneWhiteKing,
+    loneBlackKing,
+};
+
+/**
+ * the place of a piece type in a side's 24 bits, -1 for kings and unknown notations
+ */
+constexpr int field(char notation, bool lightSquare) {
+    int ret = -1;
+
+    switch (notation) {
+        case 'p':
+            ret = 0;
+            break;
+        case 'n':
+            ret = 1;
+            break;
+        case 'b':
+            ret = lightSquare ? 2 : 3;
+            break;
+        case 'r':
+            ret = 4;
+            break;
+        case 'q':
+            ret = 5;
+            break;
+    }
+
+    return ret;
+}
+
+constexpr int shift(PieceColor color, int field) {
+    return 4 * (field + (color == PieceColor::black ? 6 : 0));
+}
+
+/**
+ * what one piece adds to a key, 0 for a king
+ */
+constexpr Key piece(PieceColor color, char notation, bool lightSquare) {
+    int f = field(notation, lightSquare);
+    return f >= 0 ? Key{1} << shift(color, f) : 0;
+}
+
+/**
+ * pieces of one type, bishops of both square colors together
+ */
+constexpr int count(Key key, PieceColor color, char notation) {
+    auto at = [&](int f) -> int { return static_cast<int>((key >> shift(color, f)) & 0xf); };
+    return notation == 'b' ? at(2) + at(3)
+                           : (field(notation, false) >= 0 ? at(field(notation, false)) : 0);
+}
+
+/**
+ * the material of one side in `Piece::value` units
+ */
+constexpr int value(Key key, PieceColor color) {
+    return count(key, color, 'p') + 3 * count(key, color, 'n') + 3 * count(key, color, 'b') +
+           5 * count(key, color, 'r') + 9 * count(key, color, 'q');
+}
+
+/**
+ * the key of a board, counted square by square, `Game` only needs it when it's set up
+ */
+Key count(const Board &board);
+
+namespace detail {
+
+/**
+ * a side has no pawns, up to 3 knights and up to one bishop of each square color, rook and
+ * queen, 6 bits per side give the index of a key in `endgames`
+ */
+constexpr Key beyondTable = 0xeeeecf | (Key{0xeeeecf} << 24);
+constexpr std::size_t tableSize = std::size_t{1} << 12;
+
+constexpr std::size_t tableIndex(Key key) {
+    std::size_t ret = 0;
+
+    for (int side = 0; side < 2; side++) {
+        Key bits = key >> (24 * side);
+        ret |= (((bits >> 4) & 3) | ((bits >> 6) & 4) | ((bits >> 9) & 8) | ((bits >> 12) & 16) |
+                ((bits >> 15) & 32))
+               << (6 * side);
+    }
+
+    return ret;
+}
+
+/**
+ * the key of a table index, the inverse of `tableIndex()`
+ */
+constexpr Key tableKey(std::size_t index) {
+    Key ret = 0;
+
+    for (int side = 0; side < 2; side++) {
+        Key bits = index >> (6 * side);
+        ret |= ((bits & 3) << 4 | (bits & 4) << 6 | (bits & 8) << 9 | (bits & 16) << 12 |
+                (bits & 32) << 15)
+               << (24 * side);
+    }
+
+    return ret;
+}
+
+constexpr Endgame classify(Key key) {
+    using enum PieceColor;
+
+    Endgame ret = Endgame::none;
+    auto at = [&](PieceColor color, int f) -> int {
+        return static_cast<int>((key >> shift(color, f)) & 0xf);
+    };
+    auto minors = [&](PieceColor color) -> int {
+        return at(color, 1) + at(color, 2) + at(color, 3);
+    };
+    auto majors = [&](PieceColor color) -> int { return at(color, 4) + at(color, 5); };
+    auto bare = [&](PieceColor color) -> bool { return minors(color) + majors(color) == 0; };
+    auto canForceMate = [&](PieceColor color) -> bool {
+        return majors(color) > 0 || (at(color, 2) > 0 && at(color, 3) > 0) ||
+               (at(color, 1) > 0 && at(color, 2) + at(color, 3) > 0) || at(color, 1) >= 3;
+    };
+    bool noKnights = at(white, 1) + at(black, 1) == 0;
+    bool oneBishopColor = at(white, 2) + at(black, 2) == 0 || at(white, 3) + at(black, 3) == 0;
+
+    if (majors(white) + majors(black) == 0 &&
+        (minors(white) + minors(black) <= 1 || (noKnights && oneBishopColor))) {
+        ret = Endgame::insufficientMaterial;
+    } else if (bare(white) && canForceMate(black)) {
+        ret = Endgame::loneWhiteKing;
+    } else if (bare(black) && canForceMate(white)) {
+        ret = Endgame::loneBlackKing;
+    } else if (bare(white) || bare(black)) {
+        // two knights, the only material that can mate a bare king without forcing it
+        ret = Endgame::drawish;
+    } else if (majors(white) + majors(black) == 0 && minors(white) == 1 && minors(black) == 1) {
+        ret = Endgame::drawish;
+    } else if (majors(white) + majors(black) == 1 && minors(white) + minors(black) == 1 &&
+               at(white, 4) + at(black, 4) == 1 && minors(at(white, 4) == 1 ? black : white) == 1) {
+        // a rook against a minor piece
+        ret = Endgame::drawish;
+    }
+
+    return ret;
+}
+
+}  // namespace detail
+
+/**
+ * `detail::classify()` of every key without pawns and with few pieces
+ */
+inline constexpr auto endgames = [] {
+    std::array<Endgame, detail::tableSize> ret{};
+
+    for (std::size_t i = 0; i < ret.size(); i++) {
+        ret[i] = detail::classify(detail::tableKey(i));
+    }
+
+    return ret;
+}();
+
+/**
+ * what kind of endgame `key` is, `Endgame::none` while there are pawns or more pieces than the
+ * table has
+ */
+constexpr Endgame endgame(Key key) {
+    return (key & detail::beyondTable) == 0 ? endgames[detail::tableIndex(key)] : Endgame::none;
+}
+
+/**
+ * the score of a position of `endgame` in centipawns from white's point of view, `balance` is
+ * white's material minus black's in centipawns, the kings' squares are numbered like in
+ * `chess::tables` or -1 if the board is bigger, a lone king is pushed towards the edge and the
+ * other king towards it
+ */
+int evaluate(Endgame endgame, int balance, int whiteKing, int blackKing);
+
+}  // namespace chess::material
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <span>
+
+#include "chessBase.hpp"
+
+namespace chess {
+
+/**
+ * up to `capacity` moves stored in place, so filling one never allocates,
+ * a position of regular chess has at most 218 legal moves
+ */
+class MoveList {
+   public:
+    static constexpr std::size_t capacity = 256;
+
+   private:
+    std::array<Move, capacity> _moves;
+    std::size_t _size;
+
+   public:
+    MoveList() : _size(0) {}
+    /**
+     * returns `false` and drops `move` if the list is full, which can only happen on boards
+     * larger than 8x8
+     */
+    bool push_back(const Move &move) {
+        bool ret = _size < capacity;
+
+        if (ret) {
+            _moves[_size++] = move;
+        }
+
+        return ret;
+    }
+    void pop_back() { _size -= _size > 0 ? 1 : 0; }
+    void clear() { _size = 0; }
+    std::size_t size() const { return _size; }
+    bool empty() const { return _size == 0; }
+    bool full() const { return _size == capacity; }
+    Move &operator[](std::size_t i) { return _moves[i]; }
+    const Move &operator[](std::size_t i) const { return _moves[i]; }
+    Move &front() { return _moves[0]; }
+    const Move &front() const { return _moves[0]; }
+    Move &back() { return _moves[_size - 1]; }
+    const Move &back() const { return _moves[_size - 1]; }
+    Move *begin() { return _moves.data(); }
+    Move *end() { return _moves.data() + _size; }
+    const Move *begin() const { return _moves.data(); }
+    const Move *end() const { return _moves.data() + _size; }
+    std::span<Move> span() { return {_moves.data(), _size}; }
+    std::span<const Move> span() const { return {_moves.data(), _size}; }
+    operator std::span<const Move>() const { return span(); }
+};
+
+}  // namespace chess
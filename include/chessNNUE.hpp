@@ -0,0 +1,102 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "chessGame.hpp"
+#include "chessPosition.hpp"
+
+/**
+ * an efficiently updatable neural network evaluation, one hidden layer seen from both sides:
+ *
+ *   inputs:  768 per side, one per color (own or the opponent's), piece type and square,
+ *            the squares are mirrored vertically for black so both sides see their pieces from
+ *            the bottom of the board
+ *   hidden:  `hidden` int16 values per side (the accumulators), clipped to [0, `activationMax`]
+ *   output:  the side to move's clipped values then the opponent's, times the output weights,
+ *            plus the output bias, scaled to centipawns by `evalScale / (activationMax *
+ *            outputQuantization)`
+ *
+ * the file is every integer in little endian:
+ *
+ *   "CHSNNUE1", u32 inputs, u32 hidden, i16 feature weights (`hidden` per input),
+ *   i16 feature biases, i16 output weights (2 * `hidden`), i32 output bias
+ *
+ * the accumulators are added to and subtracted from with AVX2 when the library is built with it
+ * (`-DCHESS_ENABLE_AVX2=ON`), with SSE2 on other x86-64 builds and with plain loops otherwise,
+ * defining `CHESS_NNUE_SCALAR` forces the plain loops, all of them give the same results
+ */
+
+namespace chess::nnue {
+
+inline constexpr int inputs = 768;
+inline constexpr int hidden = 128;
+inline constexpr int activationMax = 255;
+inline constexpr int outputQuantization = 64;
+inline constexpr int evalScale = 400;
+
+struct Network {
+    alignas(64) std::array<std::int16_t, inputs * hidden> featureWeights;
+    alignas(64) std::array<std::int16_t, hidden> featureBiases;
+    alignas(64) std::array<std::int16_t, 2 * hidden> outputWeights;
+    std::int32_t outputBias;
+
+    /**
+     * returns nullptr if the file can't be read or isn't a network of this shape
+     */
+    static std::unique_ptr<Network> load(const std::string &path);
+    /**
+     * a network that counts material, 100 per pawn, 300 per knight and bishop, 500 per rook and
+     * 900 per queen, with weights from `seed` in its remaining hidden values so every part of
+     * the network is used, for testing
+     */
+    static std::unique_ptr<Network> generate(std::uint64_t seed);
+    /**
+     * returns `false` if the file couldn't be written
+     */
+    bool save(const std::string &path) const;
+};
+
+/**
+ * the hidden values of both sides, `values[0]` seen by white and `values[1]` by black
+ */
+struct Accumulator {
+    alignas(64) std::array<std::array<std::int16_t, hidden>, 2> values;
+};
+
+/**
+ * evaluates positions with a network, keeping the accumulators of the last position it saw,
+ * only the squares that changed since then are added to or subtracted from them, which between
+ * the positions a search visits one after the other is a few squares per move made or undone
+ */
+class Evaluator {
+   private:
+    std::shared_ptr<const Network> _network;
+    Position _position;
+    Accumulator _accumulator;
+
+   public:
+    explicit Evaluator(std::shared_ptr<const Network> network);
+    /**
+     * centipawns from the point of view of the side to move
+     */
+    int evaluate(const Position &position);
+    int evaluate(Game &game);
+    /**
+     * the accumulators of the last position evaluated
+     */
+    const Accumulator &accumulator() const;
+    /**
+     * computes the accumulators of `position` from scratch, for checking the incremental ones
+     */
+    static Accumulator refresh(const Network &network, const Position &position);
+    /**
+     * the output of the network for `accumulator` from the point of view of `sideToMove`
+     */
+    static int forward(const Network &network, const Accumulator &accumulator,
+                       PieceColor sideToMove);
+};
+
+}  // namespace chess::nnue
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "chessArchive.hpp"
+#include "chessMappedFile.hpp"
+
+/**
+ * move statistics of every position reached in the first plies of the games of a `GameArchive`,
+ * all integers are little endian:
+ *
+ *   file:      "CHSOPN02", u64 number of positions, u64 number of moves, positions, moves
+ *   position:  u64 `Game::positionHash()`, u32 index of its first move, u32 number of moves,
+ *              sorted by hash
+ *   move:      u64 hash of the position it leads to, u16 move (see `packMove()`), u16 reserved,
+ *              u32 games, u32 white wins, u32 draws, u32 black wins,
+ *              the moves of a position are sorted by games, most played first
+ */
+
+namespace chess {
+
+struct OpeningMove {
+    std::string move;
+    /**
+     * `Game::positionHash()` of the position after the move, to walk down the tree
+     */
+    std::uint64_t position;
+    std::uint32_t games;
+    /**
+     * games without a result in the archive are counted in `games` only
+     */
+    std::uint32_t whiteWins;
+    std::uint32_t draws;
+    std::uint32_t blackWins;
+};
+
+struct OpeningTreeConfig {
+    /**
+     * 0 uses one thread per core
+     */
+    int threads = 0;
+    /**
+     * moves made after this many plies aren't counted
+     */
+    int maxPlies = 20;
+    /**
+     * moves played in fewer games are left out of the tree
+     */
+    std::uint32_t minGames = 1;
+};
+
+/**
+ * replays the games of `archive` on a pool of threads, each one counting moves in its own
+ * hash map, merges the maps and writes the tree to `path`,
+ * games stop being counted at their first illegal move,
+ * returns `false` if the file couldn't be written
+ */
+bool buildOpeningTree(const GameArchive &archive, const std::string &path,
+                      const OpeningTreeConfig &config = {});
+
+/**
+ * a memory mapped tree written by `buildOpeningTree()`
+ */
+class OpeningTree {
+   private:
+    MappedFile _file;
+    std::span<const std::byte> _positions;
+    std::span<const std::byte> _moves;
+
+   public:
+    /**
+     * returns `std::nullopt` if the file can't be opened or isn't a complete tree
+     */
+    static std::optional<OpeningTree> open(const std::string &path);
+    std::size_t size() const;
+    /**
+     * the moves played from the position with this `Game::positionHash()`, most played first,
+     * empty if the position isn't in the tree
+     */
+    std::vector<OpeningMove> moves(std::uint64_t position) const;
+
+   private:
+    OpeningTree(MappedFile file, std::span<const std::byte> positions,
+                std::span<const std::byte> moves);
+};
+
+}  // namespace chess
@@ -1,33 +1,38 @@
 #pragma once
 
+#include <cstddef>
 #include <map>
 #include <memory>
 #include <optional>
 #include <string>
+#include <vector>
 
-#include "SDL_rect.h"
 #include "chessBase.hpp"
+#include "chessPieceArena.hpp"
 
 namespace chess {
 
+/**
+ * the rules state of a piece, where it's drawn is up to the renderer, see `BoardRenderer`
+ */
 class Piece {
-   private:
-    bool _dstOverride;
-
-   private:
-    friend class Player;
-    friend class Board;
-
    public:
     std::string position;
     const int value;
     const char notation;
     const PieceColor color;
-    SDL_Rect dst;
     int moveCount;
 
    public:
     Piece(std::string position, int value, char notation, PieceColor color);
+    /**
+     * `new (arena) Pawn(...)` takes the memory from `arena`, a plain `new` from the global
+     * allocator, `delete` gives it back to where it came from either way
+     */
+    static void *operator new(std::size_t size);
+    static void *operator new(std::size_t size, PieceArena *arena);
+    static void operator delete(void *ptr);
+    static void operator delete(void *ptr, PieceArena *arena);
     virtual std::optional<MoveType> canMove(
         const std::map<std::string, std::unique_ptr<Piece>> &pieceMap, std::string where,
         std::optional<Move> lastMove = std::nullopt) = 0;
@@ -93,4 +98,16 @@ class King : public Piece {
     ~King() override {};
 };
 
+/**
+ * creates a piece from its notation (`p`, `r`, `n`, `b`, `q` or `k`) with its default value,
+ * in `arena` if there is one, returns nullptr if `notation` isn't one of those
+ */
+std::unique_ptr<Piece> createPiece(char notation, std::string position, PieceColor color,
+                                   PieceArena *arena = nullptr);
+/**
+ * whether a piece of color `by` could capture on `square`, pawns only attack diagonally
+ */
+bool isSquareAttacked(const std::map<std::string, std::unique_ptr<Piece>> &pieceMap,
+                      const std::string &square, PieceColor by);
+
 }  // namespace chess
\ No newline at end of file
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace chess {
+
+/**
+ * owns the memory of the pieces of one board, in chunks it keeps until it's gone,
+ * a piece that's deleted goes back on the arena's free list, so creating, capturing, promoting
+ * and resetting pieces doesn't touch the global allocator once the arena has grown,
+ * pieces keep their address for as long as they live
+ */
+class PieceArena {
+   public:
+    /**
+     * the largest piece object the arena has room for, bigger ones go to the global allocator
+     */
+    static constexpr std::size_t maxPieceSize = 112;
+    static constexpr std::size_t piecesPerChunk = 64;
+
+    /**
+     * deleter for the owner of an arena, the arena stays around until the pieces that are still
+     * alive, e.g. in `Player::capturedPieces`, are deleted
+     */
+    struct Detach {
+        void operator()(PieceArena *arena) const;
+    };
+
+   private:
+    std::vector<std::unique_ptr<std::byte[]>> _chunks;
+    void *_free;
+    std::size_t _live;
+    bool _detached;
+
+   public:
+    PieceArena();
+    PieceArena(const PieceArena &) = delete;
+    PieceArena &operator=(const PieceArena &) = delete;
+    /**
+     * memory for an object of `size` bytes from `arena`, or from the global allocator if `arena`
+     * is nullptr or the object doesn't fit
+     */
+    static void *allocate(std::size_t size, PieceArena *arena);
+    /**
+     * gives memory from `allocate()` back to where it came from
+     */
+    static void release(void *ptr);
+    /**
+     * pieces currently allocated from the arena
+     */
+    std::size_t live() const;
+    /**
+     * pieces the arena has room for without growing
+     */
+    std::size_t capacity() const;
+
+   private:
+    ~PieceArena() = default;
+};
+
+}  // namespace chess
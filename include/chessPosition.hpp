@@ -0,0 +1,59 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "chessBase.hpp"
+
+namespace chess {
+
+/**
+ * everything the rules need to know about a position of regular 8x8 chess, as a plain value,
+ * copying one is a `memcpy` so threads can each take their own without sharing or allocating,
+ * see `Board::position()` and `Game::position()` to take one and `Game::loadPosition()` to set
+ * a game up from one
+ */
+struct Position {
+    static constexpr std::uint8_t whiteShortCastle = 1;
+    static constexpr std::uint8_t whiteLongCastle = 2;
+    static constexpr std::uint8_t blackShortCastle = 4;
+    static constexpr std::uint8_t blackLongCastle = 8;
+
+    /**
+     * the FEN letter of the piece on each square (`P`, `n`, ...) or `'\0'` if it's empty,
+     * squares are numbered `(file - 1) + 8 * (rank - 1)`
+     */
+    std::array<char, 64> pieces{};
+    PieceColor sideToMove = PieceColor::white;
+    /**
+     * the castling rights left, a combination of the `...Castle` bits
+     */
+    std::uint8_t castling = 0;
+    /**
+     * the file (1 to 8) of the en passant square, 0 if there is none
+     */
+    std::uint8_t enPassantFile = 0;
+    std::uint16_t halfMoveClock = 0;
+    std::uint16_t fullMoveNumber = 1;
+
+    /**
+     * returns `std::nullopt` if `fen` isn't valid
+     */
+    static std::optional<Position> fromFEN(std::string_view fen);
+    std::string toFEN() const;
+    /**
+     * the FEN letter of the piece on `square` (`e4`), `'\0'` if it's empty or not a square
+     */
+    char at(std::string_view square) const;
+
+    bool operator==(const Position &) const = default;
+};
+
+static_assert(std::is_trivially_copyable_v<Position>);
+static_assert(sizeof(Position) <= 80);
+
+}  // namespace chess
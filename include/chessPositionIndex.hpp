@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "chessArchive.hpp"
+#include "chessMappedFile.hpp"
+
+/**
+ * sorted table of every position reached by the games of a `GameArchive`, all integers are
+ * little endian:
+ *
+ *   file:   "CHSPOS02", u64 number of entries, entries sorted by hash, game and ply
+ *   entry:  u64 `Game::positionHash()`, u32 game index in the archive, u32 ply (0 is the start)
+ */
+
+namespace chess {
+
+struct PositionHit {
+    std::uint32_t game;
+    std::uint32_t ply;
+};
+
+struct PositionIndexConfig {
+    /**
+     * 0 uses one thread per core
+     */
+    int threads = 0;
+    /**
+     * entries each thread sorts in memory before writing them to a temporary run file,
+     * at 16 bytes each, the runs are merged into the index at the end
+     */
+    std::size_t runEntries = 1 << 22;
+    /**
+     * plies of each game to index, 0 indexes whole games
+     */
+    int maxPlies = 0;
+};
+
+/**
+ * replays the games of `archive` on a pool of threads and writes the index to `path`,
+ * the temporary run files are written next to it and removed afterwards,
+ * games stop being indexed at their first illegal move,
+ * returns `false` if a file couldn't be written
+ */
+bool buildPositionIndex(const GameArchive &archive, const std::string &path,
+                        const PositionIndexConfig &config = {});
+
+/**
+ * a memory mapped index written by `buildPositionIndex()`, queries are binary searches
+ */
+class PositionIndex {
+   private:
+    MappedFile _file;
+    std::span<const std::byte> _entries;
+
+   public:
+    /**
+     * returns `std::nullopt` if the file can't be opened or isn't a complete index
+     */
+    static std::optional<PositionIndex> open(const std::string &path);
+    std::size_t size() const;
+    /**
+     * every game and ply where a position with this `Game::positionHash()` was reached,
+     * sorted by game and ply
+     */
+    std::vector<PositionHit> find(std::uint64_t hash) const;
+
+   private:
+    PositionIndex(MappedFile file, std::span<const std::byte> entries);
+    std::uint64_t hashAt(std::size_t entry) const;
+};
+
+}  // namespace chess
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+
+#include "chessBase.hpp"
+
+/**
+ * the binary protocol of `chess_host`, all integers are little endian:
+ *
+ *   frame:    u32 size of the rest, u8 type, payload
+ *   newGame:  (1) u32 tag, u16 FEN length (0 for the standard starting position), FEN
+ *   move:     (2) u32 tag, u64 game, u16 move packed like an archive ply, see `packMove()`
+ *   close:    (3) u32 tag, u64 game
+ *   reply:    (129) u32 tag, u64 game, u8 `Status`, u8 `WinSearchResult`
+ *
+ * every request gets exactly one reply with its tag, a client picks the tags, replies to the
+ * requests of one game come in order, those of different games don't
+ */
+
+namespace chess::protocol {
+
+enum class RequestType : std::uint8_t { newGame = 1, move = 2, close = 3 };
+
+constexpr std::uint8_t replyType = 129;
+
+/**
+ * frames bigger than this are malformed
+ */
+constexpr std::size_t maxFrameSize = 1024;
+
+enum class Status : std::uint8_t {
+    ok,
+    illegalMove,
+    /**
+     * no game has that id, it was never started or it's over
+     */
+    unknownGame,
+    /**
+     * the game ended before the move was looked at
+     */
+    gameOver,
+    invalidPosition,
+};
+
+struct Request {
+    RequestType type;
+    std::uint32_t tag;
+    /**
+     * 0 for `RequestType::newGame`
+     */
+    std::uint64_t game;
+    std::uint16_t move;
+    /**
+     * only for `RequestType::newGame`, empty for the standard starting position
+     */
+    std::string fen;
+};
+
+struct Reply {
+    std::uint32_t tag;
+    std::uint64_t game;
+    Status status;
+    /**
+     * `WinSearchResult::nothing` while the game goes on
+     */
+    WinSearchResult result;
+};
+
+void appendRequest(std::string &out, const Request &request);
+void appendReply(std::string &out, const Reply &reply);
+/**
+ * reads the frame at the start of `bytes` into `request`, returns how many bytes it took, 0 if
+ * the frame isn't complete yet, or `std::nullopt` if it's malformed, after which the stream can't
+ * be read any further
+ */
+std::optional<std::size_t> readRequest(std::span<const std::byte> bytes, Request &request);
+std::optional<std::size_t> readReply(std::span<const std::byte> bytes, Reply &reply);
+
+}  // namespace chess::protocol
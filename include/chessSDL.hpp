@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "SDL_events.h"
+#include "SDL_pixels.h"
+#include "SDL_render.h"
+#include "chessBase.hpp"
+#include "chessBoard.hpp"
+#include "chessGame.hpp"
+
+namespace chess {
+
+struct SDLTextureDeleter {
+    void operator()(SDL_Texture *t);
+};
+
+struct PieceSprite {
+    SDL_Texture *texture;
+    SDL_Rect source;
+};
+
+struct PieceSpriteSheet {
+    int width;
+    int height;
+    int horizontalFrames;
+    int verticalFrames;
+    std::unique_ptr<SDL_Texture, SDLTextureDeleter> texture;
+};
+
+inline std::map<int, std::function<void(SDL_Renderer *ren)>> drawQueue{};
+inline std::map<std::pair<char, PieceColor>, PieceSprite> spriteMap{};
+inline PieceSpriteSheet sheet{};
+
+/**
+ * draws a `Board` and its pieces with an `SDL_Renderer`
+ */
+class BoardRenderer {
+   private:
+    SDL_Renderer *_ren;
+    /**
+     * where the piece of each square is drawn and whether it was moved off its square, by square
+     * index `(file - 1) + side * (rank - 1)`, kept here so the pieces only carry rules state
+     */
+    std::vector<Rect> _pieceDst;
+    std::vector<std::uint8_t> _pieceMoved;
+
+   public:
+    Board &board;
+
+   public:
+    BoardRenderer(Board &board, SDL_Renderer *ren);
+    void draw();
+    void drawSquareOutline(BoardSquare square, Color color);
+    void renderPieces();
+    void highlightSquareUnderCursor(int increment);
+    /**
+     * draws the piece on `square` at `dst` instead of on its square, until it's released
+     */
+    void movePiece(const std::string &square, Rect dst);
+    /**
+     * puts every moved piece back on its square
+     */
+    void releasePieces();
+
+   private:
+    int squareIndex(const std::string &square) const;
+};
+
+/**
+ * a player that picks its moves with the mouse and its promotions with the keyboard,
+ * `event` should be the event `Game::run()` is being called for
+ */
+class SDLPlayer : public Player {
+   private:
+    SDL_Event &_event;
+    BoardRenderer *_renderer;
+    bool _dragging;
+
+   public:
+    /**
+     * without a renderer the selected piece stays on its square instead of following the mouse
+     */
+    SDLPlayer(PieceColor color_, SDL_Event &event);
+    SDLPlayer(PieceColor color_, SDL_Event &event, BoardRenderer &renderer);
+    virtual std::optional<Move> handleEvents(Board &board, SDL_Event event);
+    std::optional<Move> chooseMove(Game &game) override;
+    /**
+     * the default is: `Q` = queen, `R` = rook, `N` = knight, `B` = bishop
+     */
+    std::optional<char> choosePromotion(Game &game, Piece &pawn) override;
+    ~SDLPlayer() override {};
+};
+
+/**
+ * used to render things from `Game::run()` without causing flickers
+ */
+void renderDrawQueue(SDL_Renderer *ren, Color color);
+void createSpriteSheet(std::string path, int width, int height, int horizontalFrames,
+                       int verticalFrames, SDL_Renderer *ren);
+void setPieceSprite(char type, PieceColor color, int hFrame, int vFrame);
+OptionalRef<BoardSquare> getSquareUnderCursor(Board &board);
+
+}  // namespace chess
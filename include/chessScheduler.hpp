@@ -0,0 +1,144 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "chessBase.hpp"
+#include "chessGame.hpp"
+#include "chessPosition.hpp"
+
+namespace chess {
+
+using GameId = std::uint64_t;
+
+struct GameUpdate {
+    GameId id;
+    /**
+     * the move a player chose, in UCI notation, empty if it didn't name two squares
+     */
+    std::string move;
+    /**
+     * whether `move` was legal and made, a refused move leaves the game waiting for another one
+     */
+    bool accepted;
+    /**
+     * `WinSearchResult::nothing` until the game is over
+     */
+    WinSearchResult result;
+    /**
+     * set on the last update of a game, once it has a result or was aborted, the game is gone
+     * when the callback returns
+     */
+    bool finished;
+};
+
+using GameUpdateCallback = std::function<void(const GameUpdate &update)>;
+
+/**
+ * a player whose moves come from elsewhere, like the client of a server, `submit()` queues a move
+ * in UCI notation from any thread and `chooseMove()` takes them in order, a move submitted before
+ * the player's turn is kept until then
+ */
+class RemotePlayer : public Player {
+   private:
+    std::mutex _mutex;
+    std::deque<std::string> _moves;
+
+   public:
+    using Player::Player;
+    /**
+     * queues `uci`, the game has to be woken with `GameScheduler::wake()` to see it
+     */
+    void submit(std::string uci);
+    std::optional<Move> chooseMove(Game &game) override;
+    ~RemotePlayer() override {};
+};
+
+/**
+ * plays many games on a few threads, each game is a coroutine that asks its side to move for a
+ * move with `Player::chooseMove()` and is suspended while the player hasn't decided, so an idle
+ * game costs its board and a coroutine frame but no thread, and is resumed by `wake()` once the
+ * player has something to say
+ *
+ * a game runs on one thread at a time and gives its thread up after every move, the players and
+ * the callback are called from the worker threads, the callback for different games at the same
+ * time, it may call `spawn()`, `wake()` and `abort()`
+ */
+class GameScheduler {
+   private:
+    struct Slot;
+    struct Task;
+
+    GameUpdateCallback _onUpdate;
+    std::mutex _mutex;
+    std::condition_variable _ready;
+    std::condition_variable _idle;
+    std::unordered_map<GameId, std::unique_ptr<Slot>> _games;
+    /**
+     * games to resume, each is queued at most once
+     */
+    std::deque<Slot *> _queue;
+    GameId _nextId;
+    bool _quit;
+    std::vector<std::jthread> _threads;
+
+   public:
+    /**
+     * `threads` 0 uses one thread per core
+     */
+    explicit GameScheduler(GameUpdateCallback onUpdate, int threads = 0);
+    GameScheduler(const GameScheduler &) = delete;
+    GameScheduler &operator=(const GameScheduler &) = delete;
+    /**
+     * stops the threads once the games being run give them up, unfinished games are dropped
+     * without an update
+     */
+    ~GameScheduler();
+    /**
+     * starts a game between two players of the right colors from `position`, or from the
+     * standard starting position, returns `std::nullopt` if the position can't be loaded
+     */
+    std::optional<GameId> spawn(std::unique_ptr<Player> white, std::unique_ptr<Player> black,
+                                const std::optional<Position> &position = std::nullopt);
+    /**
+     * resumes a game waiting for its side to move, to be called once a player may have decided,
+     * a wake while the game is running makes it ask again before it waits, returns `false` if
+     * there's no such game
+     */
+    bool wake(GameId id);
+    /**
+     * ends a game without a result, it gets a last update when it's next resumed
+     */
+    bool abort(GameId id);
+    /**
+     * games that haven't finished
+     */
+    std::size_t games();
+    /**
+     * blocks until every game has finished, games that wait for a wake never do
+     */
+    void wait();
+
+   private:
+    /**
+     * the coroutine of a game, from its first move to its last update
+     */
+    static Task play(Slot &slot, const GameUpdateCallback &onUpdate);
+    void work();
+    /**
+     * queues `slot` or marks it to be queued once it suspends, under `_mutex`
+     */
+    void schedule(Slot &slot);
+};
+
+}  // namespace chess
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+/**
+ * attack sets and square geometry of the 8x8 board, generated at compile time so there's nothing
+ * to initialize at startup, squares are numbered `(file - 1) + 8 * (rank - 1)` from a1
+ * like in `BoardGeometry<8>`, sets of squares are 64-bit masks with bit `square` set
+ */
+
+namespace chess::tables {
+
+using SquareSet = std::uint64_t;
+
+/**
+ * the number of `pos` if it's one of a1 to h8, otherwise -1
+ */
+constexpr int squareIndex(std::string_view pos) {
+    return pos.size() == 2 && pos[0] >= 'a' && pos[0] <= 'h' && pos[1] >= '1' && pos[1] <= '8'
+               ? (pos[0] - 'a') + 8 * (pos[1] - '1')
+               : -1;
+}
+
+constexpr SquareSet bit(int square) {
+    return SquareSet{1} << square;
+}
+
+namespace detail {
+
+constexpr bool onBoard(int file, int rank) {
+    return file >= 0 && file < 8 && rank >= 0 && rank < 8;
+}
+
+constexpr int sign(int n) {
+    return (n > 0) - (n < 0);
+}
+
+constexpr int abs(int n) {
+    return n < 0 ? -n : n;
+}
+
+template <std::size_t N>
+constexpr std::array<SquareSet, 64> leaperAttacks(const std::array<std::array<int, 2>, N> &jumps) {
+    std::array<SquareSet, 64> ret{};
+
+    for (int square = 0; square < 64; square++) {
+        for (auto [fileStep, rankStep] : jumps) {
+            int file = square % 8 + fileStep;
+            int rank = square / 8 + rankStep;
+            ret[square] |= onBoard(file, rank) ? bit(file + 8 * rank) : 0;
+        }
+    }
+
+    return ret;
+}
+
+/**
+ * the squares from `from` towards `to`, excluding `from`, up to and excluding `to` if
+ * `stopAtTo` is set, or to the edge of the board otherwise, empty if they aren't on a line
+ */
+constexpr SquareSet ray(int from, int to, bool stopAtTo) {
+    SquareSet ret = 0;
+    int fileStep = sign(to % 8 - from % 8);
+    int rankStep = sign(to / 8 - from / 8);
+    bool aligned = from != to && (to % 8 == from % 8 || to / 8 == from / 8 ||
+                                  abs(to % 8 - from % 8) == abs(to / 8 - from / 8));
+
+    for (int file = from % 8 + fileStep, rank = from / 8 + rankStep;
+         aligned && onBoard(file, rank) && !(stopAtTo && file + 8 * rank == to);
+         file += fileStep, rank += rankStep) {
+        ret |= bit(file + 8 * rank);
+    }
+
+    return ret;
+}
+
+template <class T, class Function>
+constexpr std::array<std::array<T, 64>, 64> squarePairs(Function fn) {
+    std::array<std::array<T, 64>, 64> ret{};
+
+    for (int from = 0; from < 64; from++) {
+        for (int to = 0; to < 64; to++) {
+            ret[from][to] = fn(from, to);
+        }
+    }
+
+    return ret;
+}
+
+}  // namespace detail
+
+inline constexpr std::array<SquareSet, 64> knightAttacks = detail::leaperAttacks<8>(
+    {{{1, 2}, {2, 1}, {2, -1}, {1, -2}, {-1, -2}, {-2, -1}, {-2, 1}, {-1, 2}}});
+
+inline constexpr std::array<SquareSet, 64> kingAttacks = detail::leaperAttacks<8>(
+    {{{0, 1}, {1, 1}, {1, 0}, {1, -1}, {0, -1}, {-1, -1}, {-1, 0}, {-1, 1}}});
+
+/**
+ * the squares a pawn captures on, indexed by `PieceColor`
+ */
+inline constexpr std::array<std::array<SquareSet, 64>, 2> pawnAttacks = {
+    detail::leaperAttacks<2>({{{-1, 1}, {1, 1}}}),
+    detail::leaperAttacks<2>({{{-1, -1}, {1, -1}}}),
+};
+
+/**
+ * the squares strictly between two squares on the same rank, file or diagonal, empty otherwise
+ */
+inline constexpr auto between = detail::squarePairs<SquareSet>(
+    [](int from, int to) -> SquareSet { return detail::ray(from, to, true); });
+
+/**
+ * the whole rank, file or diagonal through two squares, both included, empty if they aren't
+ * on one
+ */
+inline constexpr auto line = detail::squarePairs<SquareSet>([](int from, int to) -> SquareSet {
+    SquareSet ray = detail::ray(from, to, false) | detail::ray(to, from, false);
+    return ray != 0 ? ray | bit(from) | bit(to) : 0;
+});
+
+/**
+ * `from - to` in files and ranks, as returned by `relativeDistance()`
+ */
+inline constexpr auto offsets = detail::squarePairs<std::array<std::int8_t, 2>>(
+    [](int from, int to) -> std::array<std::int8_t, 2> {
+        return {static_cast<std::int8_t>(from % 8 - to % 8),
+                static_cast<std::int8_t>(from / 8 - to / 8)};
+    });
+
+/**
+ * the absolute value of `offsets`, as returned by `absDistance()`
+ */
+inline constexpr auto distances = detail::squarePairs<std::array<std::int8_t, 2>>(
+    [](int from, int to) -> std::array<std::int8_t, 2> {
+        return {static_cast<std::int8_t>(detail::abs(from % 8 - to % 8)),
+                static_cast<std::int8_t>(detail::abs(from / 8 - to / 8))};
+    });
+
+/**
+ * the number of king moves between two squares
+ */
+inline constexpr auto kingDistance =
+    detail::squarePairs<std::int8_t>([](int from, int to) -> std::int8_t {
+        return std::max(distances[from][to][0], distances[from][to][1]);
+    });
+
+}  // namespace chess::tables
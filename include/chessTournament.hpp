@@ -0,0 +1,126 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "chessBase.hpp"
+#include "chessGame.hpp"
+
+namespace chess {
+
+using MoveFunction = std::function<std::optional<Move>(Game &game)>;
+
+/**
+ * a player whose moves are chosen by a plain function of the game
+ */
+class FunctionPlayer : public Player {
+   public:
+    MoveFunction moveFn;
+
+   public:
+    FunctionPlayer(PieceColor color_, MoveFunction moveFn);
+    std::optional<Move> chooseMove(Game &game) override;
+    ~FunctionPlayer() override {};
+};
+
+/**
+ * creates one of the two competitors for a single game, it's called from the worker threads,
+ * `seed` is different for every game so random players stay reproducible
+ */
+using PlayerFactory = std::function<std::unique_ptr<Player>(PieceColor color, std::uint64_t seed)>;
+
+enum class SprtResult { inconclusive, acceptH0, acceptH1 };
+
+struct TournamentConfig {
+    int games = 100;
+    /**
+     * 0 uses one thread per core
+     */
+    int threads = 0;
+    /**
+     * FEN or EPD positions to start from, each one is played twice with colors reversed,
+     * invalid ones are skipped and the standard starting position is used if none are left
+     */
+    std::vector<std::string> openings{};
+    /**
+     * random legal moves played from the opening before the competitors take over, moves that
+     * end the game are played again, see `TournamentStats::skipped`
+     */
+    int randomPlies = 0;
+    std::uint64_t seed = 0;
+    /**
+     * games longer than this are adjudicated as draws
+     */
+    int maxPlies = 400;
+    /**
+     * a game is adjudicated as a win when one side is ahead by at least `materialMargin`
+     * for `materialPlies` plies in a row, 0 turns it off
+     */
+    int materialMargin = 0;
+    int materialPlies = 8;
+    double elo0 = 0.0;
+    double elo1 = 5.0;
+    double alpha = 0.05;
+    double beta = 0.05;
+    /**
+     * stops scheduling games once the SPRT accepts either hypothesis
+     */
+    bool stopOnSprt = false;
+};
+
+/**
+ * counted from the point of view of the first competitor
+ */
+struct TournamentStats {
+    int wins;
+    int draws;
+    int losses;
+    /**
+     * games lost because a competitor didn't return a legal move
+     */
+    int forfeits;
+    /**
+     * games left out of the score because their random plies kept ending the game before the
+     * competitors moved
+     */
+    int skipped;
+    double seconds;
+
+    int games() const;
+    double score() const;
+    double gamesPerSecond() const;
+};
+
+struct EloEstimate {
+    double elo;
+    /**
+     * half the width of the 95% confidence interval
+     */
+    double error;
+};
+
+EloEstimate estimateElo(int wins, int draws, int losses);
+/**
+ * log-likelihood ratio of H1 (elo = `elo1`) against H0 (elo = `elo0`),
+ * using the normal approximation of the trinomial model
+ */
+double sprtLLR(int wins, int draws, int losses, double elo0, double elo1);
+SprtResult sprtResult(double llr, double alpha, double beta);
+/**
+ * reads one FEN or EPD position per line, EPD operations, empty lines and `#` comments are ignored
+ */
+std::vector<std::string> readOpenings(std::istream &in);
+/**
+ * plays `config.games` games between the two competitors on a pool of worker threads,
+ * `onGameFinished` is called after every game, one call at a time, with the stats so far
+ */
+TournamentStats runTournament(
+    const TournamentConfig &config, PlayerFactory first, PlayerFactory second,
+    std::optional<std::function<void(const TournamentStats &stats)>> onGameFinished = std::nullopt);
+
+}  // namespace chess
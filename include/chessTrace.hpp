@@ -0,0 +1,86 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+/**
+ * optional instrumentation of the library's hot paths, configure with `-DCHESS_ENABLE_TRACE=ON`
+ * (which defines `CHESS_TRACE`) to turn it on, when it's off `CHESS_TRACE_SCOPE()` expands to
+ * nothing and the functions below report no data
+ */
+
+namespace chess::trace {
+
+enum class Op {
+    canMove,
+    isMoveLegal,
+    isKingInCheck,
+    getLegalMoves,
+    lookForWin,
+    makeMove,
+    draw,
+    renderPieces,
+    count
+};
+
+inline constexpr int opCount = static_cast<int>(Op::count);
+inline constexpr int histogramBuckets = 32;
+
+struct OpStats {
+    std::uint64_t calls;
+    std::uint64_t totalNs;
+    /**
+     * bucket `i` counts the calls that took less than `2^i` nanoseconds
+     * and at least `2^(i - 1)`, the last bucket also counts everything slower
+     */
+    std::array<std::uint64_t, histogramBuckets> histogram;
+};
+
+const char *opName(Op op);
+std::int64_t nowNs();
+/**
+ * adds a finished call to the calling thread's counters and trace buffer
+ */
+void record(Op op, std::int64_t startNs, std::int64_t endNs);
+/**
+ * stats of every thread that ever recorded something, added together,
+ * the other threads shouldn't be recording while this is called
+ */
+std::array<OpStats, opCount> collectStats();
+void writeStats(std::ostream &out);
+/**
+ * writes every recorded call in the chrome trace event format, which can be opened with
+ * `chrome://tracing` or https://ui.perfetto.dev,
+ * the other threads shouldn't be recording while this is called
+ */
+void writeChromeTrace(std::ostream &out);
+bool writeChromeTrace(const std::string &path);
+void clear();
+
+class ScopedTimer {
+   private:
+    Op _op;
+    std::int64_t _start;
+
+   public:
+    explicit ScopedTimer(Op op) : _op(op), _start(nowNs()) {}
+    ScopedTimer(const ScopedTimer &) = delete;
+    ScopedTimer &operator=(const ScopedTimer &) = delete;
+    ~ScopedTimer() { record(_op, _start, nowNs()); }
+};
+
+}  // namespace chess::trace
+
+#define CHESS_TRACE_CONCAT_(a, b) a##b
+#define CHESS_TRACE_CONCAT(a, b) CHESS_TRACE_CONCAT_(a, b)
+
+#ifdef CHESS_TRACE
+#define CHESS_TRACE_SCOPE(op)                                                 \
+    ::chess::trace::ScopedTimer CHESS_TRACE_CONCAT(chessTraceScope, __LINE__)( \
+        ::chess::trace::Op::op)
+#else
+#define CHESS_TRACE_SCOPE(op)
+#endif
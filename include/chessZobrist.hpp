@@ -0,0 +1,77 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "chessBase.hpp"
+
+/**
+ * random keys for hashing positions, generated at compile time so hashes are the same
+ * across runs and machines and can be stored on disk
+ */
+
+namespace chess::zobrist {
+
+/**
+ * squares are numbered `(file - 1) + 16 * (rank - 1)` so boards up to 16x16 fit
+ */
+inline constexpr int maxSquares = 256;
+
+constexpr std::uint64_t splitMix64(std::uint64_t &state) {
+    std::uint64_t ret = (state += 0x9e3779b97f4a7c15);
+
+    ret = (ret ^ (ret >> 30)) * 0xbf58476d1ce4e5b9;
+    ret = (ret ^ (ret >> 27)) * 0x94d049bb133111eb;
+
+    return ret ^ (ret >> 31);
+}
+
+/**
+ * 12 pieces for every square, then 4 castling rights, 16 en passant files and the side to move
+ */
+inline constexpr auto keys = [] {
+    std::array<std::uint64_t, 12 * maxSquares + 4 + 16 + 1> ret{};
+    std::uint64_t state = 0x636865737321;
+
+    for (std::uint64_t &key : ret) {
+        key = splitMix64(state);
+    }
+
+    return ret;
+}();
+
+/**
+ * kings also stand for any piece that isn't one of the standard ones
+ */
+constexpr int pieceIndex(PieceColor color, char notation) {
+    std::size_t ret = std::string_view("prnbqk").find(notation);
+
+    return static_cast<int>(ret == std::string_view::npos ? 5 : ret) +
+           (color == PieceColor::black ? 6 : 0);
+}
+
+constexpr std::uint64_t piece(PieceColor color, char notation, int square) {
+    return keys[pieceIndex(color, notation) * maxSquares + square];
+}
+
+/**
+ * 0 for white short, 1 white long, 2 black short, 3 black long
+ */
+constexpr std::uint64_t castling(int right) {
+    return keys[12 * maxSquares + right];
+}
+
+/**
+ * `file` starts at 0
+ */
+constexpr std::uint64_t enPassant(int file) {
+    return keys[12 * maxSquares + 4 + file];
+}
+
+constexpr std::uint64_t blackToMove() {
+    return keys[12 * maxSquares + 4 + 16];
+}
+
+}  // namespace chess::zobrist
@@ -0,0 +1,96 @@
+#include "chessAnalysis.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+
+#include "chessBase.hpp"
+#include "chessBoard.hpp"
+#include "chessEngine.hpp"
+#include "chessGame.hpp"
+#include "chessPosition.hpp"
+
+namespace chess {
+
+AnalysisSession::AnalysisSession(std::unique_ptr<Engine> engine, int lines,
+                                 AnalysisCallback onUpdate)
+    : _engine(std::move(engine)),
+      _lines(lines),
+      _onUpdate(std::move(onUpdate)),
+      _pending(std::nullopt),
+      _generation(0),
+      _quit(false),
+      _thread(&AnalysisSession::run, this) {}
+
+AnalysisSession::~AnalysisSession() {
+    {
+        std::lock_guard lock(_mutex);
+        _quit = true;
+        _signals.stop = true;
+    }
+    _cv.notify_all();
+    _thread.join();
+}
+
+std::uint64_t AnalysisSession::analyze(const Position &position) {
+    std::uint64_t ret = 0;
+
+    {
+        std::lock_guard lock(_mutex);
+        _pending = position;
+        _signals.stop = true;
+        ret = ++_generation;
+    }
+    _cv.notify_all();
+
+    return ret;
+}
+
+void AnalysisSession::stop() {
+    std::lock_guard lock(_mutex);
+    _pending = std::nullopt;
+    _signals.stop = true;
+    _generation++;
+}
+
+void AnalysisSession::run() {
+    HeadlessGame headless;
+    Game &game = headless.game;
+    SearchLimits limits{};
+
+    limits.infinite = true;
+    limits.multiPV = _lines;
+
+    while (true) {
+        std::optional<Position> position = std::nullopt;
+        std::uint64_t generation = 0;
+
+        {
+            std::unique_lock lock(_mutex);
+            _cv.wait(lock, [&] { return _quit || _pending.has_value(); });
+            if (_quit) {
+                break;
+            }
+
+            // cleared under the lock so a retarget after this point stops the new search
+            position = std::exchange(_pending, std::nullopt);
+            generation = _generation;
+            _signals.stop = false;
+        }
+
+        if (game.loadPosition(*position)) {
+            _engine->newGame();
+            _engine->search(game, limits, _signals, [&](const SearchInfo &info) {
+                std::lock_guard lock(_mutex);
+                if (generation == _generation) {
+                    _onUpdate({generation, info});
+                }
+            });
+        }
+    }
+}
+
+}  // namespace chess
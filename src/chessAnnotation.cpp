@@ -0,0 +1,395 @@
+#include "chessAnnotation.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "chessArchive.hpp"
+#include "chessBase.hpp"
+#include "chessBoard.hpp"
+#include "chessEngine.hpp"
+#include "chessGame.hpp"
+#include "chessPiece.hpp"
+#include "chessPosition.hpp"
+
+namespace chess {
+
+/**
+ * what a mate counts as when comparing it with centipawns, minus the moves until it
+ */
+static constexpr int mateValue = 100000;
+static constexpr std::size_t pgnLineLength = 79;
+
+std::optional<PositionAnalysis> AnnotationCache::find(std::uint64_t hash, int depth) {
+    std::lock_guard lock(_mutex);
+    auto it = _analyses.find({hash, depth});
+
+    return it != _analyses.end() ? std::make_optional(it->second) : std::nullopt;
+}
+
+void AnnotationCache::insert(std::uint64_t hash, const PositionAnalysis &analysis) {
+    std::lock_guard lock(_mutex);
+    _analyses.insert_or_assign({hash, analysis.depth}, analysis);
+}
+
+std::size_t AnnotationCache::size() {
+    std::lock_guard lock(_mutex);
+    return _analyses.size();
+}
+
+std::string moveToSAN(Game &game, const Move &move) {
+    std::string ret{};
+    char notation = move.startPiece->notation;
+    bool capture = move.endPiece != nullptr || (notation == 'p' && move.start[0] != move.end[0]);
+
+    if (notation == 'k' && absDistance(move.start, move.end).first == 2) {
+        ret = move.end[0] > move.start[0] ? "O-O" : "O-O-O";
+    } else {
+        if (notation != 'p') {
+            bool ambiguous = false;
+            bool sameFile = false;
+            bool sameRank = false;
+
+            for (const Move &other : game.legalMoves()) {
+                if (other.end == move.end && other.start != move.start &&
+                    other.startPiece->notation == notation) {
+                    ambiguous = true;
+                    sameFile = sameFile || other.start[0] == move.start[0];
+                    sameRank = sameRank || other.start[1] == move.start[1];
+                }
+            }
+
+            ret += static_cast<char>(std::toupper(notation));
+            if (ambiguous && !sameFile) {
+                ret += move.start[0];
+            } else if (ambiguous && !sameRank) {
+                ret += move.start[1];
+            } else if (ambiguous) {
+                ret += move.start;
+            }
+        } else if (capture) {
+            ret += move.start[0];
+        }
+
+        ret += (capture ? "x" : "") + move.end;
+        if (notation == 'p' && (move.end[1] == '8' || move.end[1] == '1')) {
+            ret += std::string("=") + static_cast<char>(std::toupper(move.promotion));
+        }
+    }
+
+    if (game.makeMove(move) == RunResult::turnedPassed) {
+        if (game.isKingInCheck(game.currentPlayer->color)) {
+            ret += game.legalMoves().empty() ? "#" : "+";
+        }
+        game.undoLastMove();
+    }
+
+    return ret;
+}
+
+/**
+ * searches the position `game` is in, positions without a legal move are scored without one
+ */
+static PositionAnalysis analyze(Game &game, Engine &engine, int depth) {
+    PositionAnalysis ret = {0, std::nullopt, "", "", depth};
+
+    if (game.legalMoves().empty()) {
+        ret.mateIn = game.isKingInCheck(game.currentPlayer->color) ? std::make_optional(0)
+                                                                    : std::nullopt;
+    } else {
+        SearchLimits limits{};
+        SearchSignals signals{};
+        limits.depth = depth;
+
+        std::optional<Move> best =
+            engine.search(game, limits, signals, [&](const SearchInfo &info) {
+                ret.score = info.score;
+                ret.mateIn = info.mateIn;
+            });
+        if (best.has_value()) {
+            ret.bestMove = moveToUCI(*best);
+            ret.bestMoveSAN = moveToSAN(game, *best);
+        }
+    }
+
+    return ret;
+}
+
+/**
+ * the analysis in centipawns from the point of view of the side to move, mates included
+ */
+static int centipawns(const PositionAnalysis &analysis) {
+    int ret = analysis.score;
+
+    if (analysis.mateIn.has_value()) {
+        ret = *analysis.mateIn > 0 ? mateValue - *analysis.mateIn : -mateValue - *analysis.mateIn;
+    }
+
+    return ret;
+}
+
+/**
+ * a game of the batch being annotated, `hashes` has the position before every move and the one
+ * after the last
+ */
+struct ReplayedGame {
+    AnnotatedGame game;
+    PieceColor firstToMove;
+    std::vector<std::string> moves;
+    std::vector<std::uint64_t> hashes;
+    std::vector<Position> positions;
+};
+
+/**
+ * a position to search to `depth`
+ */
+struct SearchJob {
+    Position position;
+    std::uint64_t hash;
+    int depth;
+};
+
+/**
+ * the best move is what the search of the position before it found at `depth`, the move played
+ * is scored by searching the position after it one ply less deep, so both look as far ahead and
+ * the best move never loses anything to itself
+ */
+static void annotate(ReplayedGame &replayed, const AnnotationConfig &config, int depth,
+                     AnnotationCache &cache) {
+    PieceColor mover = replayed.firstToMove;
+
+    for (std::size_t i = 0; i < replayed.game.moves.size(); i++) {
+        MoveAnnotation &move = replayed.game.moves[i];
+        PositionAnalysis before = *cache.find(replayed.hashes[i], depth);
+        PositionAnalysis after = *cache.find(replayed.hashes[i + 1], depth - 1);
+        int sign = mover == PieceColor::white ? -1 : 1;
+        bool best = before.bestMove == replayed.moves[i];
+
+        move.score = sign * after.score;
+        move.mateIn = after.mateIn.has_value() ? std::make_optional(sign * *after.mateIn)
+                                               : std::nullopt;
+        move.bestMove = best ? "" : before.bestMoveSAN;
+        move.loss = best ? 0 : std::max(0, centipawns(before) + centipawns(after));
+        move.quality = move.loss >= config.blunder      ? MoveQuality::blunder
+                       : move.loss >= config.mistake    ? MoveQuality::mistake
+                       : move.loss >= config.inaccuracy ? MoveQuality::inaccuracy
+                                                        : MoveQuality::good;
+        mover = mover == PieceColor::white ? PieceColor::black : PieceColor::white;
+    }
+}
+
+AnnotationStats annotateGames(const GameArchive &archive, const AnnotationConfig &config,
+                              AnnotationCache &cache,
+                              const std::function<void(const AnnotatedGame &game)> &onGame) {
+    AnnotationStats ret = {0, 0, 0, 0.0};
+    auto startTime = std::chrono::steady_clock::now();
+    int depth = std::max(config.depth, 2);
+    int threads = threadCount(config.threads);
+    std::size_t batchGames = std::max<std::size_t>(config.batchGames, 1);
+    HeadlessGame headless;
+    Game &game = headless.game;
+
+    for (std::size_t first = 0; first < archive.size(); first += batchGames) {
+        std::vector<ReplayedGame> batch{};
+        std::vector<SearchJob> jobs{};
+        std::set<std::pair<std::uint64_t, int>> queued{};
+        std::atomic<std::size_t> next = 0;
+
+        // every search the batch needs that isn't in the cache yet, once
+        auto queue = [&](const ReplayedGame &replayed, std::size_t ply, int depth) {
+            std::uint64_t hash = replayed.hashes[ply];
+
+            if (queued.insert({hash, depth}).second && !cache.find(hash, depth).has_value()) {
+                jobs.push_back({replayed.positions[ply], hash, depth});
+            }
+        };
+
+        for (std::size_t i = first; i < std::min(first + batchGames, archive.size()); i++) {
+            std::optional<ArchivedGame> archived = archive.game(i);
+            ReplayedGame &replayed = batch.emplace_back();
+
+            replayed.game = {i, "", WinSearchResult::nothing, {}, false};
+            if (archived.has_value() &&
+                game.loadFEN(archived->fen.empty() ? startingFEN : std::string(archived->fen))) {
+                replayed.game.fen = archived->fen;
+                replayed.game.result = archived->result;
+                replayed.firstToMove = game.currentPlayer->color;
+                replayed.hashes.push_back(game.positionHash());
+                replayed.positions.push_back(game.position());
+
+                std::size_t ply = 0;
+                for (; ply < archived->plies(); ply++) {
+                    std::string uci = archived->moveUCI(ply);
+                    std::optional<Move> move = game.moveFromUCI(uci);
+                    std::string san = move.has_value() ? moveToSAN(game, *move) : "";
+
+                    if (!move.has_value() || game.makeMove(*move) != RunResult::turnedPassed) {
+                        break;
+                    }
+                    replayed.game.moves.push_back({san, 0, std::nullopt, "", 0, MoveQuality::good});
+                    replayed.moves.push_back(uci);
+                    replayed.hashes.push_back(game.positionHash());
+                    replayed.positions.push_back(game.position());
+                }
+                replayed.game.complete = ply == archived->plies();
+            }
+
+            for (std::size_t ply = 0; ply < replayed.game.moves.size(); ply++) {
+                queue(replayed, ply, depth);
+                queue(replayed, ply + 1, depth - 1);
+            }
+            ret.positions += replayed.positions.size();
+            replayed.positions.clear();
+        }
+
+        // spreads the searches over the threads, each with its own board and engine
+        auto worker = [&] {
+            HeadlessGame headless;
+            Game &game = headless.game;
+            std::unique_ptr<Engine> engine = config.engineFactory
+                                                 ? config.engineFactory()
+                                                 : std::make_unique<MaterialEngine>();
+
+            for (std::size_t i = next++; i < jobs.size(); i = next++) {
+                SearchJob &job = jobs[i];
+
+                cache.insert(job.hash, game.loadPosition(job.position)
+                                           ? analyze(game, *engine, job.depth)
+                                           : PositionAnalysis{0, std::nullopt, "", "", job.depth});
+            }
+        };
+
+        {
+            std::vector<std::jthread> pool{};
+            for (int i = 0; i < std::min<int>(threads, static_cast<int>(jobs.size())); i++) {
+                pool.emplace_back(worker);
+            }
+        }
+        ret.searched += jobs.size();
+
+        for (ReplayedGame &replayed : batch) {
+            annotate(replayed, config, depth, cache);
+            onGame(replayed.game);
+            ret.games++;
+        }
+    }
+    ret.seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+    return ret;
+}
+
+static std::string resultText(WinSearchResult result) {
+    std::string ret = "1/2-1/2";
+
+    if (result == WinSearchResult::nothing) {
+        ret = "*";
+    } else if (result == WinSearchResult::whiteWinCheckmate) {
+        ret = "1-0";
+    } else if (result == WinSearchResult::blackWinCheckmate) {
+        ret = "0-1";
+    }
+
+    return ret;
+}
+
+/**
+ * `[%eval]` in pawns or moves until mate from white's point of view, empty after a checkmate
+ */
+static std::string evalText(const MoveAnnotation &move) {
+    std::string ret{};
+
+    if (move.mateIn.has_value() && *move.mateIn != 0) {
+        ret = "[%eval #" + std::to_string(*move.mateIn) + "]";
+    } else if (!move.mateIn.has_value()) {
+        std::string pawns = std::to_string(std::abs(move.score) / 100) + "." +
+                            std::to_string(std::abs(move.score) % 100 / 10) +
+                            std::to_string(std::abs(move.score) % 10);
+        ret = "[%eval " + std::string(move.score < 0 ? "-" : "") + pawns + "]";
+    }
+
+    return ret;
+}
+
+std::string toPGN(const AnnotatedGame &game) {
+    std::string ret{};
+    std::string line{};
+    std::string result = resultText(game.result);
+    std::optional<Position> start = Position::fromFEN(game.fen.empty() ? startingFEN : game.fen);
+    int moveNumber = start.has_value() ? start->fullMoveNumber : 1;
+    PieceColor mover = start.has_value() ? start->sideToMove : PieceColor::white;
+    // black's moves are numbered too after a comment or at the start
+    bool numberNext = true;
+
+    // breaks the movetext into lines of at most `pgnLineLength` characters between tokens
+    auto append = [&](const std::string &token) {
+        if (!line.empty() && line.size() + 1 + token.size() > pgnLineLength) {
+            ret += line + "\n";
+            line.clear();
+        }
+        line += (line.empty() ? "" : " ") + token;
+    };
+
+    ret += "[Event \"?\"]\n[Site \"?\"]\n[Date \"????.??.??\"]\n[Round \"?\"]\n";
+    ret += "[White \"?\"]\n[Black \"?\"]\n[Result \"" + result + "\"]\n";
+    if (!game.fen.empty()) {
+        ret += "[SetUp \"1\"]\n[FEN \"" + game.fen + "\"]\n";
+    }
+    ret += "\n";
+
+    for (const MoveAnnotation &move : game.moves) {
+        std::string comment = evalText(move);
+
+        if (mover == PieceColor::white) {
+            append(std::to_string(moveNumber) + ".");
+        } else if (numberNext) {
+            append(std::to_string(moveNumber) + "...");
+        }
+        append(move.san);
+
+        if (move.quality != MoveQuality::good) {
+            append(move.quality == MoveQuality::blunder   ? "$4"
+                   : move.quality == MoveQuality::mistake ? "$2"
+                                                          : "$6");
+            comment += (comment.empty() ? "" : " ") + move.bestMove + " was best";
+        }
+
+        numberNext = !comment.empty();
+        if (!comment.empty()) {
+            bool first = true;
+            std::size_t begin = 0;
+
+            // a word at a time so long comments wrap too
+            while (begin <= comment.size()) {
+                std::size_t end = std::min(comment.find(' ', begin), comment.size());
+                std::string word = comment.substr(begin, end - begin);
+
+                append((first ? "{" : "") + word + (end == comment.size() ? "}" : ""));
+                first = false;
+                begin = end + 1;
+            }
+        }
+
+        moveNumber += mover == PieceColor::black ? 1 : 0;
+        mover = mover == PieceColor::white ? PieceColor::black : PieceColor::white;
+    }
+    append(result);
+    ret += line + "\n";
+
+    return ret;
+}
+
+}  // namespace chess
@@ -0,0 +1,247 @@
+#include "chessArchive.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "chessBase.hpp"
+#include "chessBoard.hpp"
+#include "chessGame.hpp"
+#include "chessMappedFile.hpp"
+
+namespace chess {
+
+static constexpr std::string_view fileMagic = "CHSARC01";
+static constexpr std::string_view indexMagic = "CHSIDX01";
+static constexpr std::size_t recordHeaderSize = 8;
+static constexpr std::string_view promotions = " nbrq";
+
+static bool matchesMagic(std::span<const std::byte> bytes, std::string_view magic) {
+    return bytes.size() >= magic.size() &&
+           std::memcmp(bytes.data(), magic.data(), magic.size()) == 0;
+}
+
+std::optional<std::uint16_t> packMove(std::string_view uci) {
+    std::optional<std::uint16_t> ret = std::nullopt;
+    auto square = [&](std::size_t i) -> int { return (uci[i] - 'a') + 8 * (uci[i + 1] - '1'); };
+    auto isSquare = [&](std::size_t i) -> bool {
+        return uci[i] >= 'a' && uci[i] <= 'h' && uci[i + 1] >= '1' && uci[i + 1] <= '8';
+    };
+
+    if ((uci.size() == 4 || uci.size() == 5) && isSquare(0) && isSquare(2)) {
+        std::size_t promotion = uci.size() == 5 ? promotions.find(uci[4], 1) : 0;
+
+        if (promotion != std::string_view::npos) {
+            ret = static_cast<std::uint16_t>(square(0) | square(2) << 6 | promotion << 12);
+        }
+    }
+
+    return ret;
+}
+
+std::string unpackMove(std::uint16_t packed) {
+    int start = packed & 0x3f;
+    int end = (packed >> 6) & 0x3f;
+    std::size_t promotion = (packed >> 12) & 0x7;
+    std::string ret = {static_cast<char>('a' + start % 8), static_cast<char>('1' + start / 8),
+                       static_cast<char>('a' + end % 8), static_cast<char>('1' + end / 8)};
+
+    if (promotion > 0 && promotion < promotions.size()) {
+        ret.push_back(promotions[promotion]);
+    }
+
+    return ret;
+}
+
+ArchivedGame::ArchivedGame(std::string_view fen, WinSearchResult result,
+                           std::span<const std::byte> plies)
+    : _plies(plies), fen(fen), result(result) {}
+
+std::size_t ArchivedGame::plies() const {
+    return _plies.size() / 2;
+}
+
+std::uint16_t ArchivedGame::packedMove(std::size_t ply) const {
+    return static_cast<std::uint16_t>(readLittleEndian(_plies.subspan(ply * 2, 2)));
+}
+
+std::string ArchivedGame::moveUCI(std::size_t ply) const {
+    return unpackMove(packedMove(ply));
+}
+
+bool ArchivedGame::replay(Game &game, std::optional<std::size_t> plies) const {
+    std::size_t count = std::min(plies.value_or(this->plies()), this->plies());
+    bool ret = game.loadFEN(fen.empty() ? std::string(startingFEN) : std::string(fen));
+
+    for (std::size_t i = 0; i < count && ret; i++) {
+        std::optional<Move> move = game.moveFromUCI(moveUCI(i));
+        ret = move.has_value() && game.makeMove(*move) == RunResult::turnedPassed;
+    }
+
+    return ret;
+}
+
+GameArchive::GameArchive(MappedFile file, std::span<const std::byte> index)
+    : _file(std::move(file)), _index(index) {}
+
+std::optional<GameArchive> GameArchive::open(const std::string &path) {
+    std::optional<GameArchive> ret = std::nullopt;
+    std::optional<MappedFile> file = MappedFile::open(path);
+
+    if (file.has_value()) {
+        std::span<const std::byte> bytes = file->bytes();
+        std::size_t trailer = 8 + indexMagic.size();
+
+        if (bytes.size() >= fileMagic.size() + trailer && matchesMagic(bytes, fileMagic) &&
+            matchesMagic(bytes.last(indexMagic.size()), indexMagic)) {
+            std::uint64_t count = readLittleEndian(bytes.subspan(bytes.size() - trailer, 8));
+            std::size_t available = bytes.size() - trailer - fileMagic.size();
+
+            if (count <= available / 8) {
+                std::span<const std::byte> index =
+                    bytes.subspan(bytes.size() - trailer - count * 8, count * 8);
+                ret = GameArchive(std::move(*file), index);
+            }
+        }
+    }
+
+    return ret;
+}
+
+std::size_t GameArchive::size() const {
+    return _index.size() / 8;
+}
+
+std::optional<ArchivedGame> GameArchive::game(std::size_t index) const {
+    std::optional<ArchivedGame> ret = std::nullopt;
+    std::span<const std::byte> bytes = _file.bytes();
+    std::size_t end = static_cast<std::size_t>(_index.data() - bytes.data());
+
+    if (index < size()) {
+        std::uint64_t offset = readLittleEndian(_index.subspan(index * 8, 8));
+
+        // `end - offset` can't wrap around like `offset + recordHeaderSize` could
+        if (offset >= fileMagic.size() && offset <= end && end - offset >= recordHeaderSize) {
+            std::span<const std::byte> record = bytes.subspan(offset, end - offset);
+            std::size_t fenLength = readLittleEndian(record.subspan(0, 2));
+            auto result = static_cast<WinSearchResult>(readLittleEndian(record.subspan(2, 1)));
+            std::uint64_t plies = readLittleEndian(record.subspan(4, 4));
+
+            if (recordHeaderSize + fenLength + plies * 2 <= record.size()) {
+                const char *fen = reinterpret_cast<const char *>(record.data() + recordHeaderSize);
+                ret = ArchivedGame({fen, fenLength}, result,
+                                   record.subspan(recordHeaderSize + fenLength, plies * 2));
+            }
+        }
+    }
+
+    return ret;
+}
+
+GameArchiveWriter::GameArchiveWriter(std::ofstream out)
+    : _out(std::move(out)), _offsets(), _position(fileMagic.size()) {}
+
+GameArchiveWriter &GameArchiveWriter::operator=(GameArchiveWriter &&other) {
+    if (this != &other) {
+        close();
+        _out = std::move(other._out);
+        _offsets = std::move(other._offsets);
+        _position = other._position;
+    }
+
+    return *this;
+}
+
+GameArchiveWriter::~GameArchiveWriter() {
+    close();
+}
+
+std::optional<GameArchiveWriter> GameArchiveWriter::create(const std::string &path) {
+    std::optional<GameArchiveWriter> ret = std::nullopt;
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+
+    if (out && out.write(fileMagic.data(), fileMagic.size())) {
+        ret = GameArchiveWriter(std::move(out));
+    }
+
+    return ret;
+}
+
+bool GameArchiveWriter::append(const Game &game, WinSearchResult result) {
+    bool ret = game.board.numSquares == 64;
+    std::vector<std::string> moves{};
+
+    for (const Move &move : game.moveLog) {
+        moves.push_back(moveToUCI(move));
+    }
+
+    return ret && append(game.startFEN(), moves, result);
+}
+
+bool GameArchiveWriter::append(std::string_view fen, std::span<const std::string> moves,
+                               WinSearchResult result) {
+    bool ret = _out.is_open() && fen.size() <= UINT16_MAX && moves.size() <= UINT32_MAX;
+    std::string record{};
+
+    if (fen == startingFEN) {
+        fen = {};
+    }
+
+    appendLittleEndian(record, fen.size(), 2);
+    appendLittleEndian(record, static_cast<std::uint64_t>(result), 1);
+    appendLittleEndian(record, 0, 1);
+    appendLittleEndian(record, moves.size(), 4);
+    record.append(fen);
+
+    for (std::size_t i = 0; i < moves.size() && ret; i++) {
+        std::optional<std::uint16_t> packed = packMove(moves[i]);
+
+        ret = packed.has_value();
+        appendLittleEndian(record, packed.value_or(0), 2);
+    }
+
+    if (ret) {
+        ret = static_cast<bool>(
+            _out.write(record.data(), static_cast<std::streamsize>(record.size())));
+    }
+    if (ret) {
+        _offsets.push_back(_position);
+        _position += record.size();
+    }
+
+    return ret;
+}
+
+std::size_t GameArchiveWriter::size() const {
+    return _offsets.size();
+}
+
+bool GameArchiveWriter::close() {
+    bool ret = _out.is_open();
+
+    if (ret) {
+        std::string index{};
+
+        for (std::uint64_t offset : _offsets) {
+            appendLittleEndian(index, offset, 8);
+        }
+        appendLittleEndian(index, _offsets.size(), 8);
+        index.append(indexMagic);
+
+        ret = _out.write(index.data(), static_cast<std::streamsize>(index.size())) &&
+              _out.flush();
+        _out.close();
+    }
+
+    return ret;
+}
+
+}  // namespace chess
@@ -1,37 +1,37 @@
 #include "chessBoard.hpp"
 
-#include <algorithm>
-#include <cmath>
+#include <array>
+#include <cctype>
 #include <memory>
-#include <optional>
+#include <string>
 #include <utility>
 #include <vector>
 
-#include "SDL_mouse.h"
-#include "SDL_pixels.h"
-#include "SDL_rect.h"
-#include "SDL_render.h"
 #include "chessBase.hpp"
+#include "chessGeometry.hpp"
 #include "chessPiece.hpp"
-
-int intSqrt(int n) { return static_cast<int>(std::floor(std::sqrt(n))); }
+#include "chessPieceArena.hpp"
+#include "chessPosition.hpp"
+#include "chessTables.hpp"
+#include "chessTrace.hpp"
 
 namespace chess {
 
 Board::Board(int length, int numSquares, bool flipped, std::pair<int, int> offset,
-             BoardColors colors, bool createPieceMap, SDL_Renderer *ren)
-    : _ren(ren),
+             BoardColors colors, bool createPieceMap)
+    : pieceArena(new PieceArena()),
       length(length),
       numSquares(numSquares),
       offset(offset),
       flipped(flipped),
       colors(colors) {
-    for (int x = 1; x <= intSqrt(numSquares); x++) {
-        for (int y = 1; y <= intSqrt(numSquares); y++) {
-            pieceMap[pairToChessPos({x, y})] = nullptr;
-            squaresMap[pairToChessPos({x, y})] = {};
+    withBoardGeometry(numSquares, [this]<class Geometry>(Geometry) {
+        for (int i = 0; i < Geometry::squares; i++) {
+            std::string pos(Geometry::name(i));
+            pieceMap[pos] = nullptr;
+            squaresMap[pos] = {};
         }
-    }
+    });
 
     updateSquaresPosition();
     updateSquaresColor();
@@ -41,31 +41,48 @@ Board::Board(int length, int numSquares, bool flipped, std::pair<int, int> offse
     }
 }
 
+Board::Board(int numSquares, bool createPieceMap)
+    : Board(0, numSquares, false, {0, 0}, {}, createPieceMap) {}
+
+Board::Board(const Position &position, int length, bool flipped, std::pair<int, int> offset,
+             BoardColors colors)
+    : Board(length, 64, flipped, offset, colors, false) {
+    setPieces(position);
+}
+
 void Board::createDefaultPieceMap() {
     using enum PieceColor;
 
-    for (int x = 1; x <= intSqrt(numSquares); x++) {
-        pieceMap[pairToChessPos({x, 2})] =
-            std::make_unique<Pawn>(pairToChessPos({x, 2}), 1, 'p', white);
-        pieceMap[pairToChessPos({x, 7})] =
-            std::make_unique<Pawn>(pairToChessPos({x, 7}), 1, 'p', black);
-    }
-    pieceMap["a1"] = std::make_unique<Rook>("a1", 5, 'r', white);
-    pieceMap["h1"] = std::make_unique<Rook>("h1", 5, 'r', white);
-    pieceMap["a8"] = std::make_unique<Rook>("a8", 5, 'r', black);
-    pieceMap["h8"] = std::make_unique<Rook>("h8", 5, 'r', black);
-    pieceMap["b1"] = std::make_unique<Knight>("b1", 3, 'n', white);
-    pieceMap["g1"] = std::make_unique<Knight>("g1", 3, 'n', white);
-    pieceMap["b8"] = std::make_unique<Knight>("b8", 3, 'n', black);
-    pieceMap["g8"] = std::make_unique<Knight>("g8", 3, 'n', black);
-    pieceMap["c1"] = std::make_unique<Bishop>("c1", 3, 'b', white);
-    pieceMap["f1"] = std::make_unique<Bishop>("f1", 3, 'b', white);
-    pieceMap["c8"] = std::make_unique<Bishop>("c8", 3, 'b', black);
-    pieceMap["f8"] = std::make_unique<Bishop>("f8", 3, 'b', black);
-    pieceMap["d1"] = std::make_unique<Queen>("d1", 9, 'q', white);
-    pieceMap["d8"] = std::make_unique<Queen>("d8", 9, 'q', black);
-    pieceMap["e1"] = std::make_unique<King>("e1", 0, 'k', white);
-    pieceMap["e8"] = std::make_unique<King>("e8", 0, 'k', black);
+    withBoardGeometry(numSquares, [this]<class Geometry>(Geometry) {
+        // boards too small for a pawn rank don't get its pawns
+        for (int x = 1; x <= Geometry::side; x++) {
+            if (Geometry::contains(x, 2)) {
+                std::string whitePos(Geometry::name(Geometry::index(x, 2)));
+                pieceMap[whitePos] = createPiece('p', whitePos, white, pieceArena.get());
+            }
+            if (Geometry::contains(x, 7)) {
+                std::string blackPos(Geometry::name(Geometry::index(x, 7)));
+                pieceMap[blackPos] = createPiece('p', blackPos, black, pieceArena.get());
+            }
+        }
+    });
+
+    pieceMap["a1"] = createPiece('r', "a1", white, pieceArena.get());
+    pieceMap["h1"] = createPiece('r', "h1", white, pieceArena.get());
+    pieceMap["a8"] = createPiece('r', "a8", black, pieceArena.get());
+    pieceMap["h8"] = createPiece('r', "h8", black, pieceArena.get());
+    pieceMap["b1"] = createPiece('n', "b1", white, pieceArena.get());
+    pieceMap["g1"] = createPiece('n', "g1", white, pieceArena.get());
+    pieceMap["b8"] = createPiece('n', "b8", black, pieceArena.get());
+    pieceMap["g8"] = createPiece('n', "g8", black, pieceArena.get());
+    pieceMap["c1"] = createPiece('b', "c1", white, pieceArena.get());
+    pieceMap["f1"] = createPiece('b', "f1", white, pieceArena.get());
+    pieceMap["c8"] = createPiece('b', "c8", black, pieceArena.get());
+    pieceMap["f8"] = createPiece('b', "f8", black, pieceArena.get());
+    pieceMap["d1"] = createPiece('q', "d1", white, pieceArena.get());
+    pieceMap["d8"] = createPiece('q', "d8", black, pieceArena.get());
+    pieceMap["e1"] = createPiece('k', "e1", white, pieceArena.get());
+    pieceMap["e8"] = createPiece('k', "e8", black, pieceArena.get());
 }
 
 void Board::clear() {
@@ -74,63 +91,100 @@ void Board::clear() {
     }
 }
 
-void Board::updateSquaresColor() {
-    for (auto &[pos, square] : squaresMap) {
-        std::pair<int, int> pair = chessPosToPair(pos);
-        auto &[x, y] = pair;
-        square.color = (x + y) % 2 == 0 ? colors.dark : colors.light;
-    }
-}
+void Board::setPieces(const Position &position) {
+    using enum PieceColor;
 
-void Board::updateSquaresPosition() {
-    for (auto &[pos, square] : squaresMap) {
-        std::pair<int, int> pair = chessPosToPair(pos);
-        auto &[x, y] = pair;
-        auto &[xOffset, yOffset] = offset;
-        int lengthOfSquare = length / intSqrt(numSquares);
-        square.rect = {
-            (std::abs(x - (!flipped * (intSqrt(numSquares) + 1))) - 1) * lengthOfSquare + xOffset,
-            (std::abs(y - (flipped * (intSqrt(numSquares) + 1))) - 1) * lengthOfSquare + yOffset,
-            lengthOfSquare, lengthOfSquare};
-        square.position = pos;
+    if (numSquares == 64) {
+        clear();
+
+        for (int i = 0; i < 64; i++) {
+            char c = position.pieces[i];
+            PieceColor color = std::isupper(c) ? white : black;
+            char notation = static_cast<char>(std::tolower(c));
+            std::string pos(BoardGeometry<8>::name(i));
+            std::unique_ptr<Piece> piece =
+                c != '\0' ? createPiece(notation, pos, color, pieceArena.get()) : nullptr;
+
+            if (piece != nullptr) {
+                int homeRank = color == white ? 1 : 8;
+                int shortCastle =
+                    color == white ? Position::whiteShortCastle : Position::blackShortCastle;
+                int longCastle =
+                    color == white ? Position::whiteLongCastle : Position::blackLongCastle;
+                bool unmoved = false;
+
+                if (notation == 'p') {
+                    unmoved = BoardGeometry<8>::rank(i) == (color == white ? 2 : 7);
+                } else if (notation == 'k') {
+                    unmoved = i == BoardGeometry<8>::index(5, homeRank) &&
+                              (position.castling & (shortCastle | longCastle)) != 0;
+                } else if (notation == 'r') {
+                    unmoved = (i == BoardGeometry<8>::index(8, homeRank) &&
+                               (position.castling & shortCastle) != 0) ||
+                              (i == BoardGeometry<8>::index(1, homeRank) &&
+                               (position.castling & longCastle) != 0);
+                }
+
+                piece->moveCount = unmoved ? 0 : 1;
+                pieceMap.at(pos) = std::move(piece);
+            }
+        }
     }
 }
 
-void Board::draw() {
-    for (auto &[pos, square] : squaresMap) {
-        SDL_SetRenderDrawColor(_ren, square.color.r, square.color.g, square.color.b,
-                               square.color.a);
-        SDL_RenderFillRect(_ren, &square.rect);
-        SDL_SetRenderDrawColor(_ren, colors.outline.r, colors.outline.g, colors.outline.b,
-                               colors.outline.a);
-        SDL_RenderDrawRect(_ren, &square.rect);
+Position Board::position() const {
+    Position ret{};
+    std::array<bool, 64> unmoved{};
+
+    for (auto &[pos, piece] : pieceMap) {
+        int square = numSquares == 64 ? tables::squareIndex(pos) : -1;
+
+        if (piece != nullptr && square >= 0) {
+            ret.pieces[square] = piece->color == PieceColor::white
+                                     ? static_cast<char>(std::toupper(piece->notation))
+                                     : piece->notation;
+            unmoved[square] = piece->moveCount == 0;
+        }
     }
+
+    auto canCastle = [&](int king, int rook, char color) -> bool {
+        return unmoved[king] && unmoved[rook] && ret.pieces[king] == (color == 'w' ? 'K' : 'k') &&
+               ret.pieces[rook] == (color == 'w' ? 'R' : 'r');
+    };
+
+    ret.castling |= canCastle(4, 7, 'w') ? Position::whiteShortCastle : 0;
+    ret.castling |= canCastle(4, 0, 'w') ? Position::whiteLongCastle : 0;
+    ret.castling |= canCastle(60, 63, 'b') ? Position::blackShortCastle : 0;
+    ret.castling |= canCastle(60, 56, 'b') ? Position::blackLongCastle : 0;
+
+    return ret;
 }
 
-void Board::drawSquareOutline(BoardSquare square, SDL_Color color) {
-    SDL_SetRenderDrawColor(_ren, color.r, color.g, color.b, color.a);
-    SDL_RenderDrawRect(_ren, &square.rect);
+void Board::updateSquaresColor() {
+    withBoardGeometry(numSquares, [this]<class Geometry>(Geometry) {
+        for (auto &[pos, square] : squaresMap) {
+            auto [x, y] = chessPosToPair(pos);
+            square.color = Geometry::isDark(Geometry::index(x, y)) ? colors.dark : colors.light;
+        }
+    });
 }
 
-void Board::renderPieces() {
-    for (auto &[pos, piece] : pieceMap) {
-        if (piece != nullptr && spriteMap.contains({piece->notation, piece->color})) {
-            PieceSprite sprite = spriteMap.at({piece->notation, piece->color});
-            auto &[xOffset, yOffset] = offset;
-            std::pair<int, int> pair = chessPosToPair(pos);
-            auto &[x, y] = pair;
-            int lengthOfSquare = length / intSqrt(numSquares);
-            if (piece->_dstOverride) {
-                piece->dst = {
-                    (std::abs(x - (!flipped * (intSqrt(numSquares) + 1))) - 1) * lengthOfSquare +
-                        xOffset,
-                    (std::abs(y - (flipped * (intSqrt(numSquares) + 1))) - 1) * lengthOfSquare +
-                        yOffset,
-                    lengthOfSquare, lengthOfSquare};
-            }
-            SDL_RenderCopy(_ren, sprite.texture, &sprite.source, &piece->dst);
+void Board::updateSquaresPosition() {
+    withBoardGeometry(numSquares, [this]<class Geometry>(Geometry) {
+        for (auto &[pos, square] : squaresMap) {
+            auto [x, y] = chessPosToPair(pos);
+            square.rect = Geometry::rect(Geometry::index(x, y), length, offset, flipped);
+            square.position = pos;
         }
-    }
+    });
+}
+
+int Board::sideLength() const {
+    int ret = 0;
+
+    withBoardGeometry(numSquares, [&]<class Geometry>(Geometry) { ret = Geometry::side; });
+
+    return ret;
 }
 
 void Board::flip() {
@@ -151,6 +205,7 @@ void Board::keepCentered(int areaWidth, int areaHeight) {
 }
 
 bool Board::makeMove(Move move) {
+    CHESS_TRACE_SCOPE(makeMove);
     bool ret = false;
 
     if (move.startPiece == pieceMap.at(move.start).get() &&
@@ -189,6 +244,7 @@ bool Board::makeMove(Move move) {
 }
 
 bool Board::makeMove(Move move, std::vector<std::unique_ptr<Piece>> &capturedPieces) {
+    CHESS_TRACE_SCOPE(makeMove);
     bool ret = false;
 
     if (move.startPiece == pieceMap.at(move.start).get() &&
@@ -226,33 +282,4 @@ bool Board::makeMove(Move move, std::vector<std::unique_ptr<Piece>> &capturedPie
     return ret;
 }
 
-OptionalRef<BoardSquare> Board::getSquareUnderCursor() {
-    OptionalRef<BoardSquare> ret = std::nullopt;
-
-    SDL_Point mousePos{};
-    SDL_GetMouseState(&mousePos.x, &mousePos.y);
-
-    auto it = std::find_if(squaresMap.begin(), squaresMap.end(), [=](auto &a) -> bool {
-        return SDL_PointInRect(&mousePos, &a.second.rect);
-    });
-
-    if (it != squaresMap.end()) {
-        ret = it->second;
-    } else {
-        ret = std::nullopt;
-    }
-
-    return ret;
-}
-
-void Board::highlightSquareUnderCursor(int increment) {
-    OptionalRef<BoardSquare> s = getSquareUnderCursor();
-    updateSquaresColor();
-    if (s.has_value()) {
-        s->get().color.r += s->get().color.r + increment > 255 ? 255 - s->get().color.r : increment;
-        s->get().color.g += s->get().color.g + increment > 255 ? 255 - s->get().color.g : increment;
-        s->get().color.b += s->get().color.b + increment > 255 ? 255 - s->get().color.b : increment;
-    }
-}
-
 }  // namespace chess
\ No newline at end of file
@@ -0,0 +1,335 @@
+#include "chessEngine.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "chessBase.hpp"
+#include "chessBoard.hpp"
+#include "chessGame.hpp"
+#include "chessMaterial.hpp"
+#include "chessMoveList.hpp"
+#include "chessNNUE.hpp"
+#include "chessPiece.hpp"
+#include "chessTables.hpp"
+
+namespace chess {
+
+static constexpr int mateScore = 1000000;
+static constexpr int maxPly = 128;
+
+struct SearchState {
+    Game &game;
+    const SearchLimits &limits;
+    SearchSignals &signals;
+    /**
+     * scores the leaves from the point of view of the side to move
+     */
+    const std::function<int(Game &)> &evaluate;
+    std::chrono::steady_clock::time_point start;
+    std::optional<std::chrono::milliseconds> budget;
+    std::optional<std::chrono::steady_clock::time_point> deadline;
+    std::int64_t nodes;
+    bool aborted;
+    /**
+     * `pv[ply]` is the best line found from `ply` on
+     */
+    std::vector<std::vector<std::string>> pv;
+    /**
+     * `moves[ply]` are the moves being searched at `ply`, kept between nodes so generating them
+     * doesn't allocate
+     */
+    std::deque<MoveList> moves;
+
+    bool shouldStop() {
+        if (!deadline.has_value() && budget.has_value() && !signals.ponder) {
+            deadline = std::chrono::steady_clock::now() + *budget;
+        }
+
+        return signals.stop || (limits.nodes.has_value() && nodes >= *limits.nodes) ||
+               (deadline.has_value() && std::chrono::steady_clock::now() >= *deadline);
+    }
+};
+
+std::optional<std::chrono::milliseconds> timeBudget(const SearchLimits &limits,
+                                                    PieceColor sideToMove) {
+    std::optional<std::chrono::milliseconds> ret = std::nullopt;
+    std::optional<int> time = sideToMove == PieceColor::white ? limits.whiteTime : limits.blackTime;
+    int increment =
+        sideToMove == PieceColor::white ? limits.whiteIncrement : limits.blackIncrement;
+
+    if (limits.moveTime.has_value()) {
+        ret = std::chrono::milliseconds(*limits.moveTime);
+    } else if (time.has_value() && !limits.infinite) {
+        int budget = *time / limits.movesToGo.value_or(30) + increment * 3 / 4;
+        ret = std::chrono::milliseconds(std::max(1, std::min(budget, *time - 50)));
+    }
+
+    return ret;
+}
+
+/**
+ * puts `move` back on the pieces currently on its squares, pieces get replaced when a promotion
+ * is undone so the pointers of moves generated before it can go stale
+ */
+static void refresh(Game &game, Move &move) {
+    move.startPiece = game.board.pieceMap.at(move.start).get();
+    move.endPiece = game.board.pieceMap.at(move.end).get();
+}
+
+/**
+ * fills `ret` with the legal moves of the side to move, one per promotion piece,
+ * captures of valuable pieces first
+ */
+static void orderedMoves(Game &game, MoveList &ret) {
+    auto captured = [](const Move &move) -> int {
+        return move.endPiece != nullptr ? move.endPiece->value : 0;
+    };
+
+    ret.clear();
+    for (const Move &move : game.legalMoves()) {
+        if (move.startPiece->notation == 'p' && (move.end[1] == '8' || move.end[1] == '1')) {
+            for (char promotion : {'q', 'n', 'r', 'b'}) {
+                ret.push_back(move);
+                ret.back().promotion = promotion;
+            }
+        } else {
+            ret.push_back(move);
+        }
+    }
+
+    // an insertion sort keeps the generation order among equal captures without a buffer
+    for (Move *it = ret.begin(); it != ret.end(); it++) {
+        Move *to = std::upper_bound(ret.begin(), it, *it, [&](const Move &a, const Move &b) {
+            return captured(a) > captured(b);
+        });
+        std::rotate(to, it, it + 1);
+    }
+}
+
+/**
+ * material balance from the point of view of the side to move, taken from the material key,
+ * scored by `material::evaluate()` in the endgames it knows
+ */
+static int materialBalance(Game &game) {
+    using enum PieceColor;
+
+    material::Key key = game.materialKey();
+    material::Endgame endgame = material::endgame(key);
+    int whiteKing = -1;
+    int blackKing = -1;
+    int ret = 0;
+
+    // only a lone king's endgame needs to know where the kings are
+    if (endgame == material::Endgame::loneWhiteKing ||
+        endgame == material::Endgame::loneBlackKing) {
+        for (auto &[pos, piece] : game.board.pieceMap) {
+            if (piece != nullptr && piece->notation == 'k') {
+                (piece->color == white ? whiteKing : blackKing) = tables::squareIndex(pos);
+            }
+        }
+    }
+
+    ret = material::evaluate(endgame,
+                             100 * (material::value(key, white) - material::value(key, black)),
+                             whiteKing, blackKing);
+
+    return game.currentPlayer->color == white ? ret : -ret;
+}
+
+static int negamax(SearchState &state, int depth, int alpha, int beta, int ply) {
+    int ret = alpha;
+
+    state.nodes++;
+    state.pv[ply].clear();
+
+    if (state.shouldStop()) {
+        state.aborted = true;
+        ret = 0;
+    } else if (depth == 0 || ply + 1 >= maxPly) {
+        ret = state.evaluate(state.game);
+    } else {
+        while (state.moves.size() <= static_cast<std::size_t>(ply)) {
+            state.moves.emplace_back();
+        }
+
+        MoveList &moves = state.moves[ply];
+        orderedMoves(state.game, moves);
+
+        if (moves.empty()) {
+            ret = state.game.isKingInCheck(state.game.currentPlayer->color) ? -mateScore + ply : 0;
+        }
+
+        for (Move &move : moves) {
+            refresh(state.game, move);
+            if (state.game.makeMove(move) != RunResult::turnedPassed) {
+                continue;
+            }
+
+            int score = -negamax(state, depth - 1, -beta, -ret, ply + 1);
+            state.game.undoLastMove();
+
+            if (state.aborted) {
+                ret = 0;
+                break;
+            }
+
+            if (score > ret) {
+                ret = score;
+                state.pv[ply] = {moveToUCI(move)};
+                state.pv[ply].insert(state.pv[ply].end(), state.pv[ply + 1].begin(),
+                                     state.pv[ply + 1].end());
+            }
+
+            if (ret >= beta) {
+                break;
+            }
+        }
+    }
+
+    return ret;
+}
+
+/**
+ * a move of the root position with the score and the line of its last search
+ */
+struct RootLine {
+    Move move;
+    int score;
+    std::vector<std::string> pv;
+};
+
+/**
+ * searches every root move to `depth` and sorts `lines` best first, only the first `count` have
+ * exact scores, the others scored at most as much as the last of those, returns `false` if the
+ * search was stopped before every move was searched
+ */
+static bool searchRoot(SearchState &state, int depth, std::vector<RootLine> &lines,
+                       std::size_t count) {
+    // the best `count` scores so far, a move has to beat the last one to be among them
+    std::vector<int> best{};
+
+    state.nodes++;
+    for (std::size_t i = 0; i < lines.size() && !state.aborted; i++) {
+        RootLine &line = lines[i];
+        int alpha = best.size() == count ? best.back() : -mateScore - 1;
+
+        refresh(state.game, line.move);
+        if (state.game.makeMove(line.move) != RunResult::turnedPassed) {
+            continue;
+        }
+
+        int score = -negamax(state, depth - 1, -mateScore - 1, -alpha, 1);
+        state.game.undoLastMove();
+
+        if (!state.aborted) {
+            line.score = score;
+            if (score > alpha) {
+                line.pv = {moveToUCI(line.move)};
+                line.pv.insert(line.pv.end(), state.pv[1].begin(), state.pv[1].end());
+                best.insert(std::upper_bound(best.begin(), best.end(), score, std::greater{}),
+                            score);
+                best.resize(std::min(best.size(), count));
+            }
+        }
+    }
+
+    if (!state.aborted) {
+        std::stable_sort(lines.begin(), lines.end(), [](const RootLine &a, const RootLine &b) {
+            return a.score > b.score;
+        });
+    }
+
+    return !state.aborted;
+}
+
+/**
+ * iterative deepening over `negamax`, what every engine shares but the evaluation
+ */
+static std::optional<Move> alphaBeta(Game &game, const SearchLimits &limits,
+                                     SearchSignals &signals, const InfoCallback &onInfo,
+                                     const std::function<int(Game &)> &evaluate) {
+    std::optional<Move> ret = std::nullopt;
+    SearchState state = {game,
+                         limits,
+                         signals,
+                         evaluate,
+                         std::chrono::steady_clock::now(),
+                         timeBudget(limits, game.currentPlayer->color),
+                         std::nullopt,
+                         0,
+                         false,
+                         std::vector<std::vector<std::string>>(maxPly + 1),
+                         {}};
+    MoveList rootMoves{};
+    std::vector<RootLine> lines{};
+
+    orderedMoves(game, rootMoves);
+    for (const Move &move : rootMoves) {
+        lines.push_back({move, -mateScore - 1, {moveToUCI(move)}});
+    }
+
+    std::size_t count = std::min<std::size_t>(std::max(limits.multiPV, 1), lines.size());
+    std::string best = lines.empty() ? "" : lines.front().pv.front();
+
+    for (int depth = 1; depth <= limits.depth.value_or(maxPly - 1) && !lines.empty(); depth++) {
+        if (!searchRoot(state, depth, lines, count)) {
+            break;
+        }
+
+        best = lines.front().pv.front();
+
+        std::optional<int> bestMateIn = std::nullopt;
+        for (std::size_t i = 0; i < count; i++) {
+            int score = lines[i].score;
+            std::optional<int> mateIn = std::nullopt;
+            if (std::abs(score) > mateScore - maxPly) {
+                mateIn = score > 0 ? (mateScore - score + 1) / 2 : -(mateScore + score) / 2;
+            }
+            bestMateIn = i == 0 ? mateIn : bestMateIn;
+
+            onInfo({depth, score, mateIn, state.nodes,
+                    std::chrono::duration_cast<std::chrono::milliseconds>(
+                        std::chrono::steady_clock::now() - state.start)
+                        .count(),
+                    lines[i].pv, static_cast<int>(i) + 1});
+        }
+
+        if (bestMateIn.has_value() && !limits.infinite && !signals.ponder) {
+            break;
+        }
+    }
+
+    if (!best.empty()) {
+        ret = game.moveFromUCI(best);
+    }
+
+    return ret;
+}
+
+std::string MaterialEngine::name() const { return "MaterialEngine"; }
+
+std::optional<Move> MaterialEngine::search(Game &game, const SearchLimits &limits,
+                                           SearchSignals &signals, const InfoCallback &onInfo) {
+    return alphaBeta(game, limits, signals, onInfo, materialBalance);
+}
+
+NNUEEngine::NNUEEngine(std::shared_ptr<const nnue::Network> network)
+    : _evaluator(std::move(network)) {}
+
+std::string NNUEEngine::name() const { return "NNUEEngine"; }
+
+std::optional<Move> NNUEEngine::search(Game &game, const SearchLimits &limits,
+                                       SearchSignals &signals, const InfoCallback &onInfo) {
+    return alphaBeta(game, limits, signals, onInfo,
+                     [this](Game &game) -> int { return _evaluator.evaluate(game); });
+}
+
+}  // namespace chess
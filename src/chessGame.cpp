@@ -3,33 +3,43 @@
 #include <math.h>
 
 #include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <map>
 #include <memory>
-#include <numeric>
 #include <optional>
+#include <span>
 #include <string>
+#include <string_view>
 #include <vector>
 
-#include "SDL_events.h"
-#include "SDL_keycode.h"
-#include "SDL_mouse.h"
-#include "SDL_rect.h"
-#include "SDL_render.h"
 #include "chessBase.hpp"
 #include "chessBoard.hpp"
+#include "chessMappedFile.hpp"
+#include "chessMaterial.hpp"
+#include "chessMoveList.hpp"
 #include "chessPiece.hpp"
-
-extern int intSqrt(int n);
+#include "chessTrace.hpp"
+#include "chessZobrist.hpp"
 
 namespace chess {
 
-static constexpr int rectIdx = 0;
+Player::Player(PieceColor color) : color(color), materialCaptured(0), selectedPiece(nullptr) {
+    // room for every piece the opponent can lose, so captures don't allocate
+    capturedPieces.reserve(16);
+}
+
+std::optional<Move> Player::chooseMove(Game &) { return std::nullopt; }
 
-Player::Player(PieceColor color) : color(color), materialCaptured(0), selectedPiece(nullptr) {}
+std::optional<char> Player::choosePromotion(Game &, Piece &) { return 'q'; }
 
-Game::Game(Board &board, Player &player1, Player &player2, SDL_Event &event)
-    : _event(event),
+Game::Game(Board &board, Player &player1, Player &player2)
+    : _material(material::count(board)),
+      _legalMovesValid(false),
+      _onLine(0),
       running(false),
       board(board),
       player1(player1),
@@ -39,6 +49,11 @@ Game::Game(Board &board, Player &player1, Player &player2, SDL_Event &event)
       turnCount(0),
       moveCount(0) {}
 
+Game::Game(Board &board, Player &player1, Player &player2, const Position &position)
+    : Game(board, player1, player2) {
+    loadPosition(position);
+}
+
 std::optional<RunResult> Game::start() {
     std::optional<RunResult> ret =
         player1.color == player2.color ? std::make_optional(RunResult::invalid) : std::nullopt;
@@ -48,65 +63,29 @@ std::optional<RunResult> Game::start() {
     return ret;
 }
 
-std::optional<Move> Player::handleEvents(Board &board, SDL_Event event) {
-    std::optional<Move> ret = std::nullopt;
-    static std::optional<SDL_Rect> rect = std::nullopt;
-
-    if (event.type == SDL_MOUSEBUTTONDOWN && event.button.button == SDL_BUTTON_LEFT) {
-        std::optional<BoardSquare> startSquare = board.getSquareUnderCursor();
-
-        if (startSquare.has_value()) {
-            rect = startSquare->rect;
-            if (selectedPiece == board.pieceMap.at(startSquare->position).get()) {
-                selectedPiece = nullptr;
-            } else if (board.pieceMap.at(startSquare->position).get() != nullptr) {
-                if (selectedPiece != nullptr) {
-                    ret = {selectedPiece, board.pieceMap.at(startSquare->position).get(),
-                           selectedPiece->position, startSquare->position};
-                } else {
-                    selectedPiece = board.pieceMap.at(startSquare->position).get();
-                    selectedPiece->_dstOverride = false;
-                }
-            }
-        }
-    } else if (event.type == SDL_MOUSEBUTTONUP && event.button.button == SDL_BUTTON_LEFT) {
-        std::optional<BoardSquare> endSquare = board.getSquareUnderCursor();
-        rect = std::nullopt;
-
-        if (selectedPiece != nullptr) {
-            selectedPiece->_dstOverride = true;
-        }
-
-        if (!endSquare.has_value()) {
-            selectedPiece = nullptr;
-        } else if (selectedPiece != nullptr &&
-                   selectedPiece != board.pieceMap.at(endSquare->position).get()) {
-            ret = {selectedPiece, board.pieceMap.at(endSquare->position).get(),
-                   selectedPiece->position, endSquare->position};
-            selectedPiece = nullptr;
-        }
-    }
-
-    if (selectedPiece != nullptr) {
-        int mouseX{};
-        int mouseY{};
-
-        SDL_GetMouseState(&mouseX, &mouseY);
-
-        int lengthOfSquare = board.length / intSqrt(board.numSquares);
-        selectedPiece->dst = {mouseX - lengthOfSquare / 2, mouseY - lengthOfSquare / 2,
-                              lengthOfSquare, lengthOfSquare};
+/**
+ * whether `pos` is a light square, which bishop of `material::Key` a piece standing there is
+ */
+static bool isLightSquare(const std::string &pos) {
+    auto [file, rank] = chessPosToPair(pos);
+    return (file + rank) % 2 == 1;
+}
 
-        if (rect.has_value()) {
-            drawQueue[rectIdx] = [=](SDL_Renderer *ren) -> void {
-                SDL_RenderDrawRect(ren, &*rect);
-            };
-        }
-    } else {
-        drawQueue.erase(rectIdx);
-    }
+/**
+ * `square` numbered `(file - 1) + 16 * (rank - 1)` like `_legalMovesFrom` and checkpoints number
+ * squares, -1 if it isn't a square of a board up to 16x16
+ */
+static int squareIndex(std::string_view square) {
+    // the same files and ranks as `chessPosToPair()`, without copying the square
+    int file = square.length() == 2 ? square[0] - 96 : -1;
+    int rank = square.length() == 2 ? square[1] - 48 : -1;
+    return file >= 1 && file <= maxBoardSide && rank >= 1 && rank <= maxBoardSide
+               ? (file - 1) + maxBoardSide * (rank - 1)
+               : -1;
+}
 
-    return ret;
+static std::string squareName(int index) {
+    return pairToChessPos({index % maxBoardSide + 1, index / maxBoardSide + 1});
 }
 
 void Game::logMove(Move move) {
@@ -122,21 +101,20 @@ void Game::logMove(Move move) {
             (move.startPiece->notation == 'p' ? '\0' : move.startPiece->notation) +
             (move.endPiece != nullptr ? "x" : "") + move.end);
     }
-
-    std::string str{};
-    for (auto &[pos, piece] : board.pieceMap) {
-        str += piece == nullptr ? "" : piece->notation + pos;
-    }
-    _positions.push_back(str);
 }
 
 void Game::undoLastMove() {
     if (!moveLog.empty()) {
         Move lastMove = moveLog.back();
+        lastMove.startPiece = board.pieceMap.at(lastMove.end).get();
 
         if (lastMove.PiecePromoted) {
-            board.pieceMap.at(lastMove.end) =
-                std::make_unique<Pawn>(lastMove.end, 1, 'p', lastMove.startPiece->color);
+            int moveCount = lastMove.startPiece->moveCount;
+            board.pieceMap.at(lastMove.end) = createPiece('p', lastMove.end,
+                                                          lastMove.startPiece->color,
+                                                          board.pieceArena.get());
+            lastMove.startPiece = board.pieceMap.at(lastMove.end).get();
+            lastMove.startPiece->moveCount = moveCount;
         }
 
         board.pieceMap.at(lastMove.end).swap(board.pieceMap.at(lastMove.start));
@@ -151,7 +129,7 @@ void Game::undoLastMove() {
 
             currentPlayer->capturedPieces.back().swap(board.pieceMap.at(capturedPawnPos));
             currentPlayer->capturedPieces.pop_back();
-            currentPlayer->materialCaptured -= lastMove.endPiece->value;
+            currentPlayer->materialCaptured -= 1;
         } else if (lastMove.type == MoveType::shortCastle ||
                    lastMove.type == MoveType::longCastle) {
             std::string pos1 = {
@@ -168,18 +146,289 @@ void Game::undoLastMove() {
         } else if (lastMove.endPiece != nullptr) {
             currentPlayer->capturedPieces.back().swap(board.pieceMap.at(lastMove.end));
             currentPlayer->capturedPieces.pop_back();
-            currentPlayer->materialCaptured -= lastMove.endPiece->value;
+            currentPlayer->materialCaptured -= board.pieceMap.at(lastMove.end)->value;
+        }
+
+        if (!_movesUntilDrawLog.empty()) {
+            movesUntilDraw = _movesUntilDrawLog.back();
+            _movesUntilDrawLog.pop_back();
+        }
+        if (!_materialLog.empty()) {
+            _material = _materialLog.back();
+            _materialLog.pop_back();
         }
 
         moveCount--;
-        turnCount -= lastMove.startPiece->color == PieceColor::black ? 1 : 0;
+        turnCount -= lastMove.startPiece->color == PieceColor::white ? 1 : 0;
         moveLog.pop_back();
         moveLogText.pop_back();
         _positions.pop_back();
+        _onLine = std::min(_onLine, moveLog.size());
+        _legalMovesValid = false;
+        bindLastMove();
+    }
+}
+
+void Game::bindLastMove() {
+    if (!moveLog.empty()) {
+        Move &last = moveLog.back();
+        last.startPiece = board.pieceMap.at(last.end).get();
+
+        if (last.endPiece != nullptr) {
+            Player &mover = last.startPiece->color == player1.color ? player1 : player2;
+            last.endPiece = mover.capturedPieces.back().get();
+        }
+    } else if (_fenLastMove.has_value()) {
+        _fenLastMove->startPiece = board.pieceMap.at(_fenLastMove->end).get();
+    }
+}
+
+void Game::bindCaptures(const std::function<bool(std::size_t ply)> &captured) {
+    // the sides take turns, the side to move made every other move counting back from the last
+    Player *mover = (moveLog.size() % 2 == 0) == (currentPlayer == &player1) ? &player1 : &player2;
+    std::array<std::size_t, 2> next{};
+
+    for (std::size_t i = 0; i < moveLog.size(); i++) {
+        std::size_t &index = next[mover == &player1 ? 0 : 1];
+        bool capture = captured(i) && index < mover->capturedPieces.size();
+
+        moveLog[i].startPiece = nullptr;
+        moveLog[i].endPiece = capture ? mover->capturedPieces[index].get() : nullptr;
+        index += capture || moveLog[i].type == MoveType::enPassant ? 1 : 0;
+        mover = mover == &player1 ? &player2 : &player1;
+    }
+}
+
+std::optional<Game::Checkpoint> Game::checkpoint() {
+    Checkpoint ret{};
+    std::size_t count = 0;
+    bool fits = true;
+
+    auto save = [&](const Piece &piece) {
+        fits = fits && count < ret.pieces.size();
+        if (fits) {
+            char letter = piece.color == PieceColor::white
+                              ? static_cast<char>(std::toupper(piece.notation))
+                              : piece.notation;
+            ret.pieces[count++] = {letter, static_cast<std::uint8_t>(squareIndex(piece.position)),
+                                   static_cast<std::uint16_t>(piece.moveCount)};
+        }
+    };
+
+    for (auto &[pos, piece] : board.pieceMap) {
+        if (piece != nullptr) {
+            save(*piece);
+        }
+    }
+    ret.onBoard = static_cast<std::uint8_t>(count);
+    for (const std::unique_ptr<Piece> &piece : player1.capturedPieces) {
+        save(*piece);
+    }
+    ret.capturedByPlayer1 = static_cast<std::uint8_t>(count - ret.onBoard);
+    for (const std::unique_ptr<Piece> &piece : player2.capturedPieces) {
+        save(*piece);
+    }
+    ret.capturedByPlayer2 = static_cast<std::uint8_t>(count - ret.onBoard - ret.capturedByPlayer1);
+
+    ret.sideToMove = currentPlayer->color;
+    ret.movesUntilDraw = movesUntilDraw;
+    ret.turnCount = turnCount;
+    ret.moveCount = moveCount;
+    ret.material = _material;
+
+    return fits ? std::make_optional(ret) : std::nullopt;
+}
+
+std::optional<Game::Checkpoint> &Game::checkpointSlot(std::size_t ply) {
+    std::vector<std::optional<Checkpoint>> &checkpoints =
+        ply <= _onLine ? _checkpoints : _branchCheckpoints;
+    std::size_t index = ply / checkpointInterval;
+
+    if (checkpoints.size() <= index) {
+        checkpoints.resize(index + 1);
+    }
+
+    return checkpoints[index];
+}
+
+void Game::saveCheckpoint() {
+    if (moveLog.size() % checkpointInterval == 0) {
+        std::optional<Checkpoint> &slot = checkpointSlot(moveLog.size());
+
+        // the line's checkpoints stay what they were, a branch's ply can be reached another way
+        if (!slot.has_value() || moveLog.size() > _onLine) {
+            slot = lookForPromotion() == nullptr ? checkpoint() : std::nullopt;
+        }
+    }
+}
+
+bool Game::takeBack(Checkpoint &checkpoint, std::size_t ply) const {
+    using enum PieceColor;
+
+    const Move &move = moveLog[ply];
+    PieceColor mover = checkpoint.sideToMove == white ? black : white;
+    bool byPlayer1 = mover == player1.color;
+    std::uint8_t &captured =
+        byPlayer1 ? checkpoint.capturedByPlayer1 : checkpoint.capturedByPlayer2;
+    bool castle = move.type == MoveType::shortCastle || move.type == MoveType::longCastle;
+    bool capture = !castle && (move.endPiece != nullptr || move.type == MoveType::enPassant);
+    int rookSquare = squareIndex(move.start) + (move.type == MoveType::shortCastle ? 1 : -1);
+    auto onBoard = std::span(checkpoint.pieces).first(checkpoint.onBoard);
+    auto at = [&](int square) {
+        return std::ranges::find(onBoard, static_cast<std::uint8_t>(square),
+                                 &CheckpointPiece::square);
+    };
+    auto piece = at(squareIndex(move.end));
+    auto rook = castle ? at(rookSquare) : onBoard.begin();
+    bool ret = piece != onBoard.end() && rook != onBoard.end() && (!capture || captured > 0);
+
+    if (ret) {
+        piece->letter = move.PiecePromoted ? (mover == white ? 'P' : 'p') : piece->letter;
+        piece->square = static_cast<std::uint8_t>(squareIndex(move.start));
+        piece->moveCount--;
+
+        if (castle) {
+            int rookStart = rookSquare + (move.type == MoveType::shortCastle ? 2 : -3);
+            rook->square = static_cast<std::uint8_t>(rookStart);
+        } else if (capture) {
+            // the mover's last captured piece goes back on the board, it kept its square
+            std::size_t last = checkpoint.onBoard + checkpoint.capturedByPlayer1 +
+                               (byPlayer1 ? 0 : checkpoint.capturedByPlayer2) - 1;
+            auto begin = checkpoint.pieces.begin();
+
+            std::rotate(begin + checkpoint.onBoard, begin + last, begin + last + 1);
+            checkpoint.onBoard++;
+            captured--;
+        }
+
+        checkpoint.sideToMove = mover;
+        checkpoint.movesUntilDraw = _movesUntilDrawLog[ply];
+        checkpoint.turnCount -= mover == white ? 1 : 0;
+        checkpoint.moveCount--;
+        checkpoint.material = _materialLog[ply];
+    }
+
+    return ret;
+}
+
+void Game::placePieces(std::span<const CheckpointPiece> pieces, std::size_t onBoard,
+                       std::size_t capturedByPlayer1) {
+    board.clear();
+    player1.capturedPieces.clear();
+    player2.capturedPieces.clear();
+    player1.materialCaptured = 0;
+    player2.materialCaptured = 0;
+
+    for (std::size_t i = 0; i < pieces.size(); i++) {
+        std::string pos = squareName(pieces[i].square);
+        char letter = pieces[i].letter;
+        PieceColor color = std::isupper(letter) ? PieceColor::white : PieceColor::black;
+        std::unique_ptr<Piece> piece = createPiece(static_cast<char>(std::tolower(letter)), pos,
+                                                   color, board.pieceArena.get());
+        piece->moveCount = pieces[i].moveCount;
+
+        if (i < onBoard) {
+            board.pieceMap.at(pos) = std::move(piece);
+        } else {
+            Player &owner = i < onBoard + capturedByPlayer1 ? player1 : player2;
+            owner.materialCaptured += piece->value;
+            owner.capturedPieces.push_back(std::move(piece));
+        }
     }
 }
 
+void Game::restore(const Checkpoint &checkpoint, std::size_t ply) {
+    std::size_t end =
+        checkpoint.onBoard + checkpoint.capturedByPlayer1 + checkpoint.capturedByPlayer2;
+
+    placePieces(std::span(checkpoint.pieces).first(end), checkpoint.onBoard,
+                checkpoint.capturedByPlayer1);
+    currentPlayer = player1.color == checkpoint.sideToMove ? &player1 : &player2;
+    movesUntilDraw = checkpoint.movesUntilDraw;
+    turnCount = checkpoint.turnCount;
+    moveCount = checkpoint.moveCount;
+    _material = checkpoint.material;
+    player1.selectedPiece = nullptr;
+    player2.selectedPiece = nullptr;
+
+    // the logs are those of the line up to the checkpoint
+    if (ply <= moveLog.size()) {
+        moveLog.erase(moveLog.begin() + ply, moveLog.end());
+        moveLogText.erase(moveLogText.begin() + ply, moveLogText.end());
+        _positions.erase(_positions.begin() + ply, _positions.end());
+        _movesUntilDrawLog.erase(_movesUntilDrawLog.begin() + ply, _movesUntilDrawLog.end());
+        _materialLog.erase(_materialLog.begin() + ply, _materialLog.end());
+    }
+    for (std::size_t i = moveLog.size(); i < ply; i++) {
+        moveLog.push_back(_line[i].move);
+        moveLogText.push_back(_line[i].text);
+        _positions.push_back(_line[i].position);
+        _movesUntilDrawLog.push_back(_line[i].movesUntilDraw);
+        _materialLog.push_back(_line[i].material);
+    }
+
+    _onLine = ply;
+    _legalMovesValid = false;
+    // the moves still point at the pieces `placePieces()` replaced
+    bindCaptures([this](std::size_t i) { return moveLog[i].endPiece != nullptr; });
+    bindLastMove();
+}
+
+bool Game::seekToPly(std::size_t ply) {
+    // moves made off the line since the last seek replace the rest of it
+    if (_onLine < moveLog.size()) {
+        _line.erase(_line.begin() + _onLine, _line.end());
+        _checkpoints.resize(moveLog.size() / checkpointInterval + 1);
+        for (std::size_t i = _onLine / checkpointInterval + 1; i < _checkpoints.size(); i++) {
+            _checkpoints[i] =
+                i < _branchCheckpoints.size() ? _branchCheckpoints[i] : std::nullopt;
+        }
+        for (std::size_t i = _onLine; i < moveLog.size(); i++) {
+            _line.push_back({moveLog[i], moveLogText[i], _positions[i], _movesUntilDrawLog[i],
+                             _materialLog[i]});
+        }
+        _onLine = moveLog.size();
+    }
+
+    bool ret = ply <= _line.size();
+    auto distance = [ply](std::size_t from) { return from > ply ? from - ply : ply - from; };
+
+    if (ret) {
+        std::optional<std::size_t> closest = std::nullopt;
+        std::size_t moves = distance(moveLog.size());
+
+        for (std::size_t i = 0; i < _checkpoints.size(); i++) {
+            if (_checkpoints[i].has_value() && distance(i * checkpointInterval) < moves) {
+                closest = i;
+                moves = distance(i * checkpointInterval);
+            }
+        }
+        if (closest.has_value()) {
+            restore(*_checkpoints[*closest], *closest * checkpointInterval);
+        }
+
+        while (moveLog.size() > ply) {
+            undoLastMove();
+        }
+        while (moveLog.size() < ply) {
+            Move move = _line[moveLog.size()].move;
+            move.startPiece = board.pieceMap.at(move.start).get();
+            move.endPiece = board.pieceMap.at(move.end).get();
+            move.PiecePromoted = false;
+
+            makeMove(move);
+        }
+    }
+
+    return ret;
+}
+
+std::size_t Game::lineLength() const {
+    return _onLine < moveLog.size() ? moveLog.size() : _line.size();
+}
+
 bool Game::isKingInCheck(PieceColor color) {
+    CHESS_TRACE_SCOPE(isKingInCheck);
     bool ret = false;
     std::string kingPos{};
 
@@ -200,16 +449,21 @@ bool Game::isKingInCheck(PieceColor color) {
 }
 
 bool Game::isMoveLegal(Move &move, const Player &player) {
+    CHESS_TRACE_SCOPE(isMoveLegal);
     bool ret = false;
-    std::optional<MoveType> type = move.startPiece->canMove(
-        board.pieceMap, move.end,
-        moveLog.empty() ? std::nullopt : std::make_optional(moveLog.back()));
-
-    if (move.startPiece != nullptr && player.color == move.startPiece->color && type.has_value()) {
+    bool matchesBoard = move.startPiece != nullptr && board.pieceMap.contains(move.start) &&
+                        board.pieceMap.contains(move.end) &&
+                        board.pieceMap.at(move.start).get() == move.startPiece &&
+                        board.pieceMap.at(move.end).get() == move.endPiece;
+    std::optional<MoveType> type =
+        matchesBoard ? move.startPiece->canMove(board.pieceMap, move.end, lastMove())
+                     : std::nullopt;
+
+    if (matchesBoard && player.color == move.startPiece->color && type.has_value()) {
         move.type = type;
         board.makeMove(move, currentPlayer->capturedPieces);
 
-        ret = !isKingInCheck(currentPlayer->color);
+        ret = !isKingInCheck(player.color);
 
         board.pieceMap.at(move.end).swap(board.pieceMap.at(move.start));
         board.pieceMap.at(move.start)->position = move.start;
@@ -239,51 +493,131 @@ bool Game::isMoveLegal(Move &move, const Player &player) {
     return ret;
 }
 
-std::vector<Move> Game::getLegalMoves(Piece &piece, Player &player) {
+std::vector<Move> Game::getLegalMoves(Player &player) {
     std::vector<Move> ret{};
+    std::vector<Piece *> pieces{};
+
+    for (auto &[pos, piece] : board.pieceMap) {
+        if (piece != nullptr && piece->color == player.color) {
+            pieces.push_back(piece.get());
+        }
+    }
+
+    for (Piece *piece : pieces) {
+        std::vector<Move> moves = getLegalMoves(*piece, player);
+        ret.insert(ret.end(), moves.begin(), moves.end());
+    }
+
+    return ret;
+}
+
+bool Game::getLegalMoves(Player &player, MoveList &moves) {
+    bool ret = true;
+    std::array<Piece *, maxBoardSide * maxBoardSide> pieces{};
+    std::size_t numPieces = 0;
+
+    // `isMoveLegal()` moves pieces around, so they're collected before any of them is tried
+    for (auto &[pos, piece] : board.pieceMap) {
+        if (piece != nullptr && piece->color == player.color && numPieces < pieces.size()) {
+            pieces[numPieces++] = piece.get();
+        }
+    }
+
+    for (std::size_t i = 0; i < numPieces; i++) {
+        ret = getLegalMoves(*pieces[i], player, moves) && ret;
+    }
+
+    return ret;
+}
+
+std::vector<Move> Game::getLegalMoves(Piece &piece, Player &player) {
+    MoveList moves{};
+
+    getLegalMoves(piece, player, moves);
+
+    return {moves.begin(), moves.end()};
+}
+
+bool Game::getLegalMoves(Piece &piece, Player &player, MoveList &moves) {
+    CHESS_TRACE_SCOPE(getLegalMoves);
+    bool ret = true;
 
     for (auto &[pos, square] : board.squaresMap) {
         Move move = {&piece, board.pieceMap.at(pos).get(), piece.position, pos};
         if (isMoveLegal(move, player)) {
-            ret.push_back(move);
+            ret = moves.push_back(move) && ret;
         }
     }
 
     return ret;
 }
 
+std::span<const Move> Game::legalMoves() {
+    if (_legalMoves == nullptr) {
+        _legalMoves = std::make_unique<MoveList>();
+    }
+
+    if (!_legalMovesValid) {
+        MoveList &moves = *_legalMoves;
+        moves.clear();
+        getLegalMoves(*currentPlayer, moves);
+        _legalMovesFrom.fill({0, 0});
+        _legalMovesValid = true;
+
+        // the moves of a piece are generated together, so each square's moves are one range
+        for (std::size_t i = 0; i < moves.size(); i++) {
+            int square = squareIndex(moves[i].start);
+            if (square >= 0) {
+                auto &[begin, end] = _legalMovesFrom[square];
+                begin = begin == end ? static_cast<std::uint16_t>(i) : begin;
+                end = static_cast<std::uint16_t>(i + 1);
+            }
+        }
+    }
+
+    return *_legalMoves;
+}
+
+std::span<const Move> Game::legalMovesFrom(const std::string &square) {
+    std::span<const Move> ret{};
+    std::span<const Move> moves = legalMoves();
+    int index = squareIndex(square);
+
+    if (index >= 0) {
+        auto [begin, end] = _legalMovesFrom[index];
+        ret = moves.subspan(begin, end - begin);
+    }
+
+    return ret;
+}
+
+bool Game::isLegalMove(const std::string &start, const std::string &end) {
+    return std::ranges::any_of(legalMovesFrom(start),
+                               [&](const Move &move) { return move.end == end; });
+}
+
+void Game::invalidateLegalMoves() {
+    _legalMovesValid = false;
+    _line.clear();
+    _onLine = 0;
+    _checkpoints.clear();
+    _branchCheckpoints.clear();
+    _material = material::count(board);
+}
+
+material::Key Game::materialKey() const { return _material; }
+
 WinSearchResult Game::lookForWin() {
+    CHESS_TRACE_SCOPE(lookForWin);
     WinSearchResult ret = WinSearchResult::nothing;
-    int numWhiteLegalMoves{};
-    int numBlackLegalMoves{};
-
-    numWhiteLegalMoves = std::accumulate(
-        board.pieceMap.begin(), board.pieceMap.end(), 0, [this](int val, auto &a) -> int {
-            Player &p = player1.color == PieceColor::white ? player1 : player2;
-            return a.second != nullptr && a.second->color == PieceColor::white
-                       ? val + getLegalMoves(*a.second, p).size()
-                       : val;
-        });
-
-    numBlackLegalMoves = std::accumulate(
-        board.pieceMap.begin(), board.pieceMap.end(), 0, [this](int val, auto &a) -> int {
-            Player &p = player1.color == PieceColor::black ? player1 : player2;
-            return a.second != nullptr && a.second->color == PieceColor::black
-                       ? val + getLegalMoves(*a.second, p).size()
-                       : val;
-        });
-
-    if (numWhiteLegalMoves == 0) {
-        if (isKingInCheck(PieceColor::white)) {
-            ret = WinSearchResult::blackWinCheckmate;
-            moveLogText.back() += "#";
-        } else {
-            ret = WinSearchResult::stalemateDraw;
-        }
-    } else if (numBlackLegalMoves == 0) {
-        if (isKingInCheck(PieceColor::black)) {
-            ret = WinSearchResult::whiteWinCheckmate;
-            moveLogText.back() += "#";
+
+    if (legalMoves().empty()) {
+        if (isKingInCheck(currentPlayer->color)) {
+            ret = currentPlayer->color == PieceColor::white ? WinSearchResult::blackWinCheckmate
+                                                            : WinSearchResult::whiteWinCheckmate;
+            if (!moveLogText.empty() && !moveLogText.back().ends_with('#')) {
+                moveLogText.back() += "#";
+            }
         } else {
             ret = WinSearchResult::stalemateDraw;
         }
@@ -293,30 +627,14 @@ WinSearchResult Game::lookForWin() {
         ret = movesUntilDraw == 0 ? WinSearchResult::fiftyMoveDraw : WinSearchResult::nothing;
     }
 
-    if (ret == WinSearchResult::nothing) {
-        auto getMaterial = [this](Player &p) -> int {
-            return std::accumulate(
-                board.pieceMap.begin(), board.pieceMap.end(), 0, [&](int val, auto &a) -> int {
-                    return a.second != nullptr && a.second->color == p.color ? val + a.second->value
-                                                                             : val;
-                });
-        };
-        auto hasPawn = [this](Player &p) -> bool {
-            return std::find_if(board.pieceMap.begin(), board.pieceMap.end(), [&](auto &a) -> bool {
-                       return a.second != nullptr && a.second->notation == 'p' &&
-                              a.second->color == p.color;
-                   }) == board.pieceMap.end();
-        };
-
-        ret = getMaterial(player1) < 5 && hasPawn(player1) && getMaterial(player2) < 5 &&
-                      hasPawn(player2)
-                  ? WinSearchResult::materialDraw
-                  : WinSearchResult::nothing;
+    if (ret == WinSearchResult::nothing &&
+        material::endgame(_material) == material::Endgame::insufficientMaterial) {
+        ret = WinSearchResult::materialDraw;
     }
 
     if (ret == WinSearchResult::nothing && _positions.size() > 2) {
-        std::map<std::string, int> map{};
-        for (std::string &pos : _positions) {
+        std::map<std::uint64_t, int> map{};
+        for (std::uint64_t pos : _positions) {
             map[pos] = map.contains(pos) ? map[pos] + 1 : 1;
 
             if (map[pos] == 3) {
@@ -342,83 +660,132 @@ Piece *Game::lookForPromotion() {
     return ret;
 }
 
+bool Game::promote(Piece *pawn, char notation) {
+    bool ret = notation == 'q' || notation == 'r' || notation == 'n' || notation == 'b';
+
+    if (ret) {
+        std::unique_ptr<Piece> &square = board.pieceMap.at(pawn->position);
+        int moveCount = pawn->moveCount;
+        _material -= material::piece(pawn->color, 'p', false);
+        _material += material::piece(pawn->color, notation, isLightSquare(pawn->position));
+        // the new piece keeps the pawn's moves, so `undoLastMove()` can give them back
+        square = createPiece(notation, pawn->position, pawn->color, board.pieceArena.get());
+        square->moveCount = moveCount;
+
+        if (!moveLog.empty()) {
+            // a different promotion than the line's leaves it
+            if (moveLog.size() <= _onLine && _line[moveLog.size() - 1].move.promotion != notation) {
+                _onLine = moveLog.size() - 1;
+            }
+            moveLog.back().startPiece = square.get();
+            moveLog.back().PiecePromoted = true;
+            moveLog.back().promotion = notation;
+            moveLogText.back() += std::string("=") + notation;
+        }
+        if (!_positions.empty()) {
+            _positions.back() = positionHash();
+        }
+        _legalMovesValid = false;
+        if (!moveLog.empty()) {
+            saveCheckpoint();
+        }
+    }
+
+    return ret;
+}
+
 RunResult Game::defaultPromotionHandler(Piece *piece) {
-    RunResult ret = RunResult::still;
+    RunResult ret = RunResult::awaitPromotion;
 
-    Pawn pawn = *reinterpret_cast<Pawn *>(piece);
-    switch (_event.type) {
-        case SDL_KEYUP:
-            switch (_event.key.keysym.sym) {
-                case SDLK_q:
-                    board.pieceMap.at(pawn.position) =
-                        std::make_unique<Queen>(pawn.position, 9, 'q', pawn.color);
-                    moveLog.back().startPiece = board.pieceMap.at(pawn.position).get();
-                    moveLog.back().PiecePromoted = true;
-                    moveLogText.back() += "=q";
-                    break;
-                case SDLK_r:
-                    board.pieceMap.at(pawn.position) =
-                        std::make_unique<Rook>(pawn.position, 5, 'r', pawn.color);
-                    moveLog.back().startPiece = board.pieceMap.at(pawn.position).get();
-                    moveLog.back().PiecePromoted = true;
-                    moveLogText.back() += "=r";
-                    break;
-                case SDLK_n:
-                    board.pieceMap.at(pawn.position) =
-                        std::make_unique<Knight>(pawn.position, 3, 'n', pawn.color);
-                    moveLog.back().startPiece = board.pieceMap.at(pawn.position).get();
-                    moveLog.back().PiecePromoted = true;
-                    moveLogText.back() += "=n";
-                    break;
-                case SDLK_b:
-                    board.pieceMap.at(pawn.position) =
-                        std::make_unique<Bishop>(pawn.position, 3, 'b', pawn.color);
-                    moveLog.back().startPiece = board.pieceMap.at(pawn.position).get();
-                    moveLog.back().PiecePromoted = true;
-                    moveLogText.back() += "=b";
-                    break;
-            }
-            break;
-        default:
-            ret = RunResult::awaitPromotion;
-            break;
+    Player &owner = piece->color == player1.color ? player1 : player2;
+    std::optional<char> notation = owner.choosePromotion(*this, *piece);
+
+    if (notation.has_value() && promote(piece, *notation)) {
+        ret = RunResult::still;
     }
 
     return ret;
 }
 
+RunResult Game::handlePromotion(
+    Piece *piece, const std::optional<std::function<RunResult(Piece *piece)>> &promotionFn) {
+    return promotionFn.has_value() ? (*promotionFn)(piece) : defaultPromotionHandler(piece);
+}
+
 RunResult Game::run(std::optional<std::function<RunResult(Piece *piece)>> promotionFn) {
     RunResult ret = RunResult::still;
 
     if (running) {
-        std::optional<Move> move = currentPlayer->handleEvents(board, _event);
-
         Piece *piece = lookForPromotion();
         if (piece != nullptr) {
-            if (promotionFn.has_value()) {
-                ret = (*promotionFn)(piece);
-            } else {
-                ret = defaultPromotionHandler(piece);
+            ret = handlePromotion(piece, promotionFn);
+        }
+
+        if (ret == RunResult::still) {
+            std::optional<Move> move = currentPlayer->chooseMove(*this);
+
+            if (move.has_value()) {
+                ret = makeMove(*move, promotionFn);
             }
         }
+    }
+
+    return ret;
+}
+
+RunResult Game::makeMove(Move move,
+                         std::optional<std::function<RunResult(Piece *piece)>> promotionFn) {
+    return isMoveLegal(move, *currentPlayer) ? applyMove(move, promotionFn) : RunResult::still;
+}
 
-        if (ret == RunResult::still && move.has_value() && isMoveLegal(*move, *currentPlayer) &&
-            board.makeMove(*move, currentPlayer->capturedPieces)) {
-            logMove(*move);
+RunResult Game::applyMove(
+    Move &move, const std::optional<std::function<RunResult(Piece *piece)>> &promotionFn) {
+    RunResult ret = RunResult::still;
 
-            currentPlayer->materialCaptured += move->endPiece != nullptr
-                                                   ? currentPlayer->capturedPieces.back()->value
-                                               : move->type == MoveType::enPassant ? 1
-                                                                                   : 0;
+    // the first move checkpoints where the game started, the others the ply they lead to
+    if (moveLog.empty()) {
+        saveCheckpoint();
+    }
+
+    if (board.makeMove(move, currentPlayer->capturedPieces)) {
+        logMove(move);
+        _movesUntilDrawLog.push_back(movesUntilDraw);
+        _materialLog.push_back(_material);
+        if (move.endPiece != nullptr) {
+            _material -= material::piece(move.endPiece->color, move.endPiece->notation,
+                                         isLightSquare(move.end));
+        } else if (move.type == MoveType::enPassant) {
+            _material -= material::piece(
+                move.startPiece->color == PieceColor::white ? PieceColor::black : PieceColor::white,
+                'p', false);
+        }
 
-            move->startPiece->moveCount++;
-            currentPlayer = (currentPlayer == &player1) ? &player2 : &player1;
-            movesUntilDraw = move->startPiece->notation == 'p' || move->endPiece != nullptr
-                                 ? 50
-                                 : movesUntilDraw - 1;
+        currentPlayer->materialCaptured += move.endPiece != nullptr
+                                               ? currentPlayer->capturedPieces.back()->value
+                                           : move.type == MoveType::enPassant ? 1
+                                                                              : 0;
+
+        move.startPiece->moveCount++;
+        currentPlayer = (currentPlayer == &player1) ? &player2 : &player1;
+        movesUntilDraw = move.startPiece->notation == 'p' || move.endPiece != nullptr
+                             ? 50
+                             : movesUntilDraw - 1;
+
+        ret = RunResult::turnedPassed;
+        _positions.push_back(positionHash());
+        _legalMovesValid = false;
+        if (_onLine + 1 == moveLog.size() && _onLine < _line.size() &&
+            _line[_onLine].move.start == move.start && _line[_onLine].move.end == move.end) {
+            _onLine++;
+        }
 
-            ret = RunResult::turnedPassed;
+        Piece *piece = lookForPromotion();
+        if (piece != nullptr && move.promotion != '\0') {
+            promote(piece, move.promotion);
+        } else if (piece != nullptr && handlePromotion(piece, promotionFn) != RunResult::still) {
+            ret = RunResult::awaitPromotion;
         }
+        saveCheckpoint();
     }
 
     return ret;
@@ -437,6 +804,12 @@ void Game::reset(std::optional<std::function<void()>> boardResetFn) {
     player1.capturedPieces.clear();
     player2.capturedPieces.clear();
     _positions.clear();
+    _fenLastMove = std::nullopt;
+    _movesUntilDrawLog.clear();
+    _materialLog.clear();
+    _startFEN.clear();
+    _legalMoves.reset();
+    invalidateLegalMoves();
 
     running = false;
     movesUntilDraw = 50;
@@ -449,4 +822,505 @@ void Game::reset(std::optional<std::function<void()>> boardResetFn) {
     currentPlayer = player1.color == PieceColor::white ? &player1 : &player2;
 }
 
-}  // namespace chess
\ No newline at end of file
+std::optional<Move> Game::lastMove() {
+    return moveLog.empty() ? _fenLastMove : std::make_optional(moveLog.back());
+}
+
+bool Game::loadFEN(const std::string &fen) {
+    std::optional<Position> position = Position::fromFEN(fen);
+    bool ret = position.has_value() && loadPosition(*position);
+
+    if (ret) {
+        _startFEN = fen;
+    }
+
+    return ret;
+}
+
+bool Game::loadPosition(const Position &position) {
+    using enum PieceColor;
+
+    bool ret = board.numSquares == 64 && std::ranges::count(position.pieces, 'K') == 1 &&
+               std::ranges::count(position.pieces, 'k') == 1;
+
+    if (ret) {
+        reset([&] { board.setPieces(position); });
+
+        PieceColor sideToMove = position.sideToMove;
+        currentPlayer = player1.color == sideToMove ? &player1 : &player2;
+        movesUntilDraw = std::max(50 - position.halfMoveClock, 0);
+        turnCount = sideToMove == white ? position.fullMoveNumber - 1 : position.fullMoveNumber;
+        moveCount = (position.fullMoveNumber - 1) * 2 + (sideToMove == black ? 1 : 0);
+        _startFEN = position.toFEN();
+
+        if (position.enPassantFile >= 1 && position.enPassantFile <= 8) {
+            char file = static_cast<char>('a' + position.enPassantFile - 1);
+            std::string start = {file, sideToMove == white ? '7' : '2'};
+            std::string end = {file, sideToMove == white ? '5' : '4'};
+            Piece *pawn = board.pieceMap.at(end).get();
+
+            if (pawn != nullptr && pawn->notation == 'p' && pawn->color != sideToMove) {
+                _fenLastMove = Move{pawn, nullptr, start, end, MoveType::normal};
+            }
+        }
+    }
+
+    return ret;
+}
+
+Position Game::position() {
+    Position ret = board.position();
+
+    ret.sideToMove = currentPlayer->color;
+    ret.enPassantFile = static_cast<std::uint8_t>(enPassantFile());
+    ret.halfMoveClock = static_cast<std::uint16_t>(std::max(50 - movesUntilDraw, 0));
+    ret.fullMoveNumber = static_cast<std::uint16_t>(
+        currentPlayer->color == PieceColor::white ? turnCount + 1 : turnCount);
+
+    return ret;
+}
+
+static constexpr std::string_view stateMagic = "CHSGAM02";
+/**
+ * the promotions of `Game::saveState()` by number, 0 for none
+ */
+static constexpr std::string_view statePromotions = "-qrnb";
+
+/**
+ * FNV-1a of a state without its checksum
+ */
+static std::uint64_t stateChecksum(std::span<const std::byte> state) {
+    std::uint64_t ret = 0xcbf29ce484222325;
+
+    for (std::byte byte : state) {
+        ret = (ret ^ static_cast<std::uint64_t>(byte)) * 0x100000001b3;
+    }
+
+    return ret;
+}
+
+std::string Game::saveState() const {
+    using enum PieceColor;
+
+    std::string ret(stateMagic);
+    const Player &whitePlayer = player1.color == white ? player1 : player2;
+    const Player &blackPlayer = player1.color == white ? player2 : player1;
+    std::size_t onBoard = std::ranges::count_if(
+        board.pieceMap, [](const auto &square) { return square.second != nullptr; });
+
+    auto appendSquare = [&](const std::string &square) {
+        appendLittleEndian(ret, static_cast<std::uint8_t>(squareIndex(square)), 1);
+    };
+    auto appendPiece = [&](const Piece &piece) {
+        char letter = piece.color == white ? static_cast<char>(std::toupper(piece.notation))
+                                           : piece.notation;
+        appendLittleEndian(ret, static_cast<std::uint8_t>(letter), 1);
+        appendSquare(piece.position);
+        appendLittleEndian(ret, static_cast<std::uint16_t>(piece.moveCount), 2);
+    };
+
+    appendLittleEndian(ret, board.numSquares, 2);
+    appendLittleEndian(ret, currentPlayer->color == white ? 0 : 1, 1);
+    appendLittleEndian(ret, running ? 1 : 0, 1);
+    appendLittleEndian(ret, static_cast<std::uint16_t>(movesUntilDraw), 2);
+    appendLittleEndian(ret, static_cast<std::uint32_t>(turnCount), 4);
+    appendLittleEndian(ret, static_cast<std::uint32_t>(moveCount), 4);
+    appendLittleEndian(ret, _startFEN.size(), 2);
+    ret += _startFEN;
+    appendLittleEndian(ret, _fenLastMove.has_value() ? 1 : 0, 1);
+    if (_fenLastMove.has_value()) {
+        appendSquare(_fenLastMove->start);
+        appendSquare(_fenLastMove->end);
+    }
+
+    appendLittleEndian(ret, onBoard, 2);
+    appendLittleEndian(ret, whitePlayer.capturedPieces.size(), 2);
+    appendLittleEndian(ret, blackPlayer.capturedPieces.size(), 2);
+    for (const auto &[pos, piece] : board.pieceMap) {
+        if (piece != nullptr) {
+            appendPiece(*piece);
+        }
+    }
+    for (const Player *player : {&whitePlayer, &blackPlayer}) {
+        for (const std::unique_ptr<Piece> &piece : player->capturedPieces) {
+            appendPiece(*piece);
+        }
+    }
+
+    appendLittleEndian(ret, moveLog.size(), 4);
+    for (std::size_t i = 0; i < moveLog.size(); i++) {
+        const Move &move = moveLog[i];
+        std::size_t promotion = statePromotions.find(move.promotion, 1);
+        std::string_view text = std::string_view(moveLogText[i]).substr(0, UINT8_MAX);
+
+        appendSquare(move.start);
+        appendSquare(move.end);
+        appendLittleEndian(ret,
+                           static_cast<std::uint64_t>(move.type.value_or(MoveType::normal)) |
+                               (move.endPiece != nullptr ? 4 : 0) | (move.PiecePromoted ? 8 : 0) |
+                               (promotion != std::string_view::npos ? promotion << 4 : 0),
+                           1);
+        appendLittleEndian(ret, static_cast<std::uint16_t>(_movesUntilDrawLog[i]), 2);
+        appendLittleEndian(ret, _positions[i], 8);
+        appendLittleEndian(ret, text.size(), 1);
+        ret += text;
+    }
+    appendLittleEndian(ret, stateChecksum(std::as_bytes(std::span(ret))), 8);
+
+    return ret;
+}
+
+bool Game::loadState(std::span<const std::byte> blob) {
+    using enum PieceColor;
+
+    std::span<const std::byte> state = blob.first(blob.size() >= 8 ? blob.size() - 8 : 0);
+    auto chars = [&](std::size_t offset, std::size_t size) -> std::string_view {
+        return {reinterpret_cast<const char *>(state.data()) + offset, size};
+    };
+
+    bool ret = state.size() >= stateMagic.size() && chars(0, stateMagic.size()) == stateMagic &&
+               readLittleEndian(blob.last(8)) == stateChecksum(state);
+    std::size_t offset = stateMagic.size();
+
+    // every read checks there's enough left, once one fails the rest read nothing
+    auto read = [&](std::size_t size) -> std::uint64_t {
+        ret = ret && state.size() - offset >= size;
+        std::uint64_t value = ret ? readLittleEndian(state.subspan(offset, size)) : 0;
+        offset += ret ? size : 0;
+        return value;
+    };
+    auto readText = [&](std::size_t size) -> std::string {
+        ret = ret && state.size() - offset >= size;
+        std::string value = ret ? std::string(chars(offset, size)) : "";
+        offset += ret ? size : 0;
+        return value;
+    };
+    auto readSquare = [&]() -> std::string {
+        std::string square = squareName(static_cast<int>(read(1)));
+        ret = ret && board.pieceMap.contains(square);
+        return square;
+    };
+    auto opponent = [](PieceColor color) { return color == white ? black : white; };
+
+    ret = ret && read(2) == static_cast<std::uint64_t>(board.numSquares);
+    PieceColor sideToMove = read(1) == 0 ? white : black;
+    bool wasRunning = read(1) != 0;
+    int untilDraw = static_cast<std::int16_t>(read(2));
+    int turns = static_cast<int>(read(4));
+    int moves = static_cast<int>(read(4));
+    std::string fen = readText(read(2));
+    std::optional<Move> fenLastMove = std::nullopt;
+    if (read(1) != 0) {
+        std::string start = readSquare();
+        fenLastMove = Move{nullptr, nullptr, start, readSquare(), MoveType::normal};
+    }
+
+    std::size_t onBoard = read(2);
+    std::size_t capturedByWhite = read(2);
+    std::size_t capturedByBlack = read(2);
+    std::vector<CheckpointPiece> pieces{};
+    std::vector<bool> occupied(maxBoardSide * maxBoardSide, false);
+    for (std::size_t i = 0; ret && i < onBoard + capturedByWhite + capturedByBlack; i++) {
+        auto letter = static_cast<char>(read(1));
+        int square = squareIndex(readSquare());
+        auto pieceMoveCount = static_cast<std::uint16_t>(read(2));
+
+        ret = ret && letter != '\0' && std::string_view("pnbrqkPNBRQK").contains(letter);
+        pieces.push_back({letter, static_cast<std::uint8_t>(square), pieceMoveCount});
+        occupied[square] = occupied[square] || i < onBoard;
+    }
+
+    // the captures each side made, which have to be those of its captured pieces
+    std::size_t plies = read(4);
+    std::vector<Move> log{};
+    std::vector<std::string> texts{};
+    std::vector<std::uint64_t> positions{};
+    std::vector<int> untilDrawLog{};
+    std::vector<bool> captured{};
+    std::array<std::size_t, 2> captures{};
+    PieceColor mover = plies % 2 == 0 ? sideToMove : opponent(sideToMove);
+
+    ret = ret && plies <= (state.size() - offset) / 14;
+    for (std::size_t i = 0; ret && i < plies; i++) {
+        std::string start = readSquare();
+        std::string end = readSquare();
+        std::uint64_t flags = read(1);
+        auto type = static_cast<MoveType>(flags & 3);
+        bool promoted = (flags & 8) != 0;
+        char promotion = (flags >> 4) < statePromotions.size() ? statePromotions[flags >> 4] : '?';
+
+        ret = ret && promotion != '?' && (!promoted || promotion != '-');
+        log.push_back({nullptr, nullptr, start, end, type, promoted,
+                       promotion != '-' ? promotion : '\0'});
+        captured.push_back((flags & 4) != 0);
+        untilDrawLog.push_back(static_cast<std::int16_t>(read(2)));
+        positions.push_back(read(8));
+        texts.push_back(readText(read(1)));
+
+        captures[mover == white ? 0 : 1] += captured.back() || type == MoveType::enPassant;
+        mover = opponent(mover);
+    }
+    ret = ret && offset == state.size() && captures[0] == capturedByWhite &&
+          captures[1] == capturedByBlack;
+    // `bindLastMove()` needs the piece that made the last move
+    ret = ret && (log.empty() ? !fenLastMove.has_value() || occupied[squareIndex(fenLastMove->end)]
+                              : occupied[squareIndex(log.back().end)]);
+
+    if (ret) {
+        if (player1.color != white) {
+            std::rotate(pieces.begin() + onBoard, pieces.begin() + onBoard + capturedByWhite,
+                        pieces.end());
+        }
+        reset([] {});
+        placePieces(pieces, onBoard, player1.color == white ? capturedByWhite : capturedByBlack);
+
+        currentPlayer = player1.color == sideToMove ? &player1 : &player2;
+        running = wasRunning;
+        movesUntilDraw = untilDraw;
+        turnCount = turns;
+        moveCount = moves;
+        _startFEN = std::move(fen);
+        _fenLastMove = std::move(fenLastMove);
+        moveLog = std::move(log);
+        moveLogText = std::move(texts);
+        _positions = std::move(positions);
+        _movesUntilDrawLog = std::move(untilDrawLog);
+        _material = material::count(board);
+        _materialLog.resize(moveLog.size());
+
+        bindCaptures([&](std::size_t i) { return captured[i]; });
+
+        // the material before each move, taking the moves back from the current one
+        material::Key key = _material;
+        mover = sideToMove;
+        for (std::size_t i = moveLog.size(); i-- > 0;) {
+            const Move &move = moveLog[i];
+            PieceColor side = mover = opponent(mover);
+            bool light = isLightSquare(move.end);
+
+            if (move.PiecePromoted) {
+                key -= material::piece(side, move.promotion, light);
+                key += material::piece(side, 'p', false);
+            }
+            if (move.endPiece != nullptr) {
+                key += material::piece(opponent(side), move.endPiece->notation, light);
+            } else if (move.type == MoveType::enPassant) {
+                key += material::piece(opponent(side), 'p', false);
+            }
+            _materialLog[i] = key;
+        }
+
+        bindLastMove();
+
+        // the checkpoints of the moves, worked out backwards from the current ply
+        saveCheckpoint();
+        std::optional<Checkpoint> taken = checkpoint();
+        for (std::size_t ply = moveLog.size(); ply-- > 0 && taken.has_value();) {
+            taken = takeBack(*taken, ply) ? taken : std::nullopt;
+            if (ply % checkpointInterval == 0) {
+                checkpointSlot(ply) = taken;
+            }
+        }
+    }
+
+    return ret;
+}
+
+const std::string &Game::startFEN() const {
+    return _startFEN;
+}
+
+std::string Game::getFEN() { return position().toFEN(); }
+
+std::uint64_t Game::positionHash() {
+    std::uint64_t ret = currentPlayer->color == PieceColor::black ? zobrist::blackToMove() : 0;
+
+    for (auto &[pos, piece] : board.pieceMap) {
+        if (piece != nullptr) {
+            auto [file, rank] = chessPosToPair(pos);
+            ret ^= zobrist::piece(piece->color, piece->notation, (file - 1) + 16 * (rank - 1));
+        }
+    }
+
+    auto canCastle = [this](const std::string &kingPos, const std::string &rookPos) -> bool {
+        auto king = board.pieceMap.find(kingPos);
+        auto rook = board.pieceMap.find(rookPos);
+        return king != board.pieceMap.end() && rook != board.pieceMap.end() &&
+               king->second != nullptr && king->second->notation == 'k' &&
+               king->second->moveCount == 0 && rook->second != nullptr &&
+               rook->second->notation == 'r' && rook->second->moveCount == 0 &&
+               king->second->color == rook->second->color;
+    };
+
+    ret ^= canCastle("e1", "h1") ? zobrist::castling(0) : 0;
+    ret ^= canCastle("e1", "a1") ? zobrist::castling(1) : 0;
+    ret ^= canCastle("e8", "h8") ? zobrist::castling(2) : 0;
+    ret ^= canCastle("e8", "a8") ? zobrist::castling(3) : 0;
+
+    int file = enPassantFile();
+    ret ^= file != 0 ? zobrist::enPassant(file - 1) : 0;
+
+    return ret;
+}
+
+int Game::enPassantFile() {
+    int ret = 0;
+    std::optional<Move> last = lastMove();
+
+    if (last.has_value() && last->startPiece != nullptr && last->startPiece->notation == 'p' &&
+        absDistance(last->start, last->end).second == 2) {
+        auto [file, rank] = chessPosToPair(last->end);
+        int passedRank = (rank + chessPosToPair(last->start).second) / 2;
+        std::string passed = pairToChessPos({file, passedRank});
+
+        // only a pawn next to the pushed one can take it, and only if its king isn't left in check
+        for (int side : {-1, 1}) {
+            auto square = board.pieceMap.find(pairToChessPos({file + side, rank}));
+            Piece *pawn = square != board.pieceMap.end() ? square->second.get() : nullptr;
+
+            if (pawn != nullptr && pawn->notation == 'p' && pawn->color == currentPlayer->color) {
+                Move capture = {pawn, nullptr, pawn->position, passed};
+                ret = isMoveLegal(capture, *currentPlayer) ? file : ret;
+            }
+        }
+    }
+
+    return ret;
+}
+
+std::optional<Move> Game::moveFromUCI(const std::string &uci) {
+    std::optional<Move> ret = std::nullopt;
+    std::string start = uci.substr(0, 2);
+    std::string end = uci.length() >= 4 ? uci.substr(2, 2) : "";
+    char promotion = uci.length() == 5 ? uci[4] : '\0';
+
+    if ((uci.length() == 4 || (uci.length() == 5 && std::string("qrnb").find(promotion) !=
+                                                         std::string::npos)) &&
+        board.pieceMap.contains(start) && board.pieceMap.contains(end)) {
+        ret = Move{board.pieceMap.at(start).get(), board.pieceMap.at(end).get(), start, end};
+        ret->promotion = promotion;
+    }
+
+    return ret;
+}
+
+MoveError Game::findLegalMove(std::string_view text, Move &move) {
+    MoveError ret = MoveError::malformed;
+    std::span<const Move> legal = legalMoves();
+    const Move *found = nullptr;
+    char promotion = '\0';
+    // squares past the board's side aren't any move's, like `p4` on an 8x8 board
+    auto onBoard = [side = board.sideLength()](std::string_view square) {
+        int index = squareIndex(square);
+        return index >= 0 && index % maxBoardSide < side && index / maxBoardSide < side;
+    };
+
+    // SAN's check, mate and annotation marks say nothing about which move it is
+    while (!text.empty() && std::string_view("+#!?").contains(text.back())) {
+        text.remove_suffix(1);
+    }
+
+    if ((text.size() == 4 || text.size() == 5) && onBoard(text.substr(0, 2)) &&
+        onBoard(text.substr(2, 2))) {
+        // UCI, no SAN has two squares without a piece letter or `x` before the second one
+        std::string_view end = text.substr(2, 2);
+        auto [begin, stop] = _legalMovesFrom[squareIndex(text.substr(0, 2))];
+
+        promotion = text.size() == 5 ? text[4] : '\0';
+        ret = promotion == '\0' || std::string_view("qrnb").contains(promotion)
+                  ? MoveError::illegal
+                  : MoveError::malformed;
+        for (const Move &candidate : legal.subspan(begin, stop - begin)) {
+            found = ret == MoveError::illegal && candidate.end == end ? &candidate : found;
+        }
+    } else if (text == "O-O" || text == "O-O-O" || text == "0-0" || text == "0-0-0") {
+        MoveType type = text.size() == 3 ? MoveType::shortCastle : MoveType::longCastle;
+
+        ret = MoveError::illegal;
+        for (const Move &candidate : legal) {
+            found = candidate.type == type ? &candidate : found;
+        }
+    } else {
+        // SAN: [piece] [file] [rank] [x] square [=promotion]
+        char notation = !text.empty() && std::string_view("NBRQK").contains(text.front())
+                            ? static_cast<char>(std::tolower(text.front()))
+                            : 'p';
+        text.remove_prefix(notation != 'p' ? 1 : 0);
+
+        if (notation == 'p' && text.size() >= 2 && text[text.size() - 2] == '=') {
+            promotion = static_cast<char>(std::tolower(text.back()));
+            text.remove_suffix(2);
+        } else if (notation == 'p' && !text.empty() &&
+                   std::string_view("QRNB").contains(text.back())) {
+            promotion = static_cast<char>(std::tolower(text.back()));
+            text.remove_suffix(1);
+        }
+
+        std::string_view end = text.size() >= 2 ? text.substr(text.size() - 2) : "";
+        std::string_view from = text.substr(0, text.size() - end.size());
+        from.remove_suffix(from.ends_with('x') ? 1 : 0);
+
+        // a file, a rank, both or neither, a pawn always moves along its file unless it captures
+        auto isFile = [](char c) { return c >= 'a' && c < 'a' + maxBoardSide; };
+        auto isRank = [](char c) { return c >= '1' && c < '1' + maxBoardSide; };
+        char file = !from.empty() && isFile(from.front()) ? from.front() : '\0';
+        from.remove_prefix(file != '\0' ? 1 : 0);
+        char rank = from.size() == 1 && isRank(from.front()) ? from.front() : '\0';
+        from.remove_prefix(rank != '\0' ? 1 : 0);
+        file = notation == 'p' && file == '\0' && !end.empty() ? end.front() : file;
+
+        bool valid = onBoard(end) && from.empty() && (notation != 'p' || rank == '\0') &&
+                     (promotion == '\0' || std::string_view("qrnb").contains(promotion));
+        ret = valid ? MoveError::illegal : MoveError::malformed;
+        for (const Move &candidate : legal) {
+            if (valid && candidate.startPiece->notation == notation && candidate.end == end &&
+                (file == '\0' || candidate.start[0] == file) &&
+                (rank == '\0' || candidate.start[1] == rank) &&
+                (candidate.type == MoveType::normal || candidate.type == MoveType::enPassant)) {
+                ret = found != nullptr ? MoveError::ambiguous : ret;
+                found = &candidate;
+            }
+        }
+    }
+
+    if (found != nullptr && ret == MoveError::illegal) {
+        char lastRank = found->startPiece->color == PieceColor::white ? '8' : '1';
+        bool promotes = found->startPiece->notation == 'p' && found->end[1] == lastRank;
+
+        ret = promotes == (promotion != '\0') ? MoveError::none : MoveError::promotion;
+        move = *found;
+        move.promotion = promotion;
+    }
+
+    return ret;
+}
+
+MoveError Game::tryApplyMove(std::string_view text) {
+    Move move{nullptr, nullptr, "", ""};
+    MoveError ret = findLegalMove(text, move);
+
+    if (ret == MoveError::none) {
+        applyMove(move, std::nullopt);
+    }
+
+    return ret;
+}
+
+MoveBatchResult Game::tryApplyMoves(std::span<const std::string_view> moves) {
+    MoveBatchResult ret{0, MoveError::none};
+
+    while (ret.error == MoveError::none && ret.applied < moves.size()) {
+        ret.error = tryApplyMove(moves[ret.applied]);
+        ret.applied += ret.error == MoveError::none ? 1 : 0;
+    }
+
+    return ret;
+}
+
+HeadlessGame::HeadlessGame(bool createPieceMap)
+    : board(64, createPieceMap),
+      white(PieceColor::white),
+      black(PieceColor::black),
+      game(board, white, black) {}
+
+}  // namespace chess
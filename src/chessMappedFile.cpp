@@ -0,0 +1,124 @@
+#include "chessMappedFile.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <optional>
+#include <span>
+#include <string>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define CHESS_HAS_MMAP
+#endif
+
+namespace chess {
+
+MappedFile::MappedFile() : _data(nullptr), _size(0), _buffer(nullptr) {}
+
+MappedFile::MappedFile(MappedFile &&other) noexcept
+    : _data(std::exchange(other._data, nullptr)),
+      _size(std::exchange(other._size, 0)),
+      _buffer(std::exchange(other._buffer, nullptr)) {}
+
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept {
+    if (this != &other) {
+        release();
+        _data = std::exchange(other._data, nullptr);
+        _size = std::exchange(other._size, 0);
+        _buffer = std::exchange(other._buffer, nullptr);
+    }
+
+    return *this;
+}
+
+MappedFile::~MappedFile() {
+    release();
+}
+
+void MappedFile::release() {
+    if (_buffer != nullptr) {
+        delete[] _buffer;
+    }
+#ifdef CHESS_HAS_MMAP
+    else if (_data != nullptr) {
+        munmap(const_cast<std::byte *>(_data), _size);
+    }
+#endif
+
+    _data = nullptr;
+    _size = 0;
+    _buffer = nullptr;
+}
+
+std::optional<MappedFile> MappedFile::open(const std::string &path) {
+    std::optional<MappedFile> ret = std::nullopt;
+
+#ifdef CHESS_HAS_MMAP
+    int fd = ::open(path.c_str(), O_RDONLY);
+    struct stat info{};
+
+    if (fd >= 0 && fstat(fd, &info) == 0) {
+        MappedFile file{};
+
+        file._size = static_cast<std::size_t>(info.st_size);
+        if (file._size == 0) {
+            ret = std::move(file);
+        } else {
+            void *data = mmap(nullptr, file._size, PROT_READ, MAP_SHARED, fd, 0);
+
+            if (data != MAP_FAILED) {
+                file._data = static_cast<const std::byte *>(data);
+                ret = std::move(file);
+            }
+        }
+    }
+
+    if (fd >= 0) {
+        close(fd);
+    }
+#else
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+
+    if (in) {
+        MappedFile file{};
+
+        file._size = static_cast<std::size_t>(in.tellg());
+        file._buffer = new std::byte[file._size];
+        file._data = file._buffer;
+        in.seekg(0);
+        if (in.read(reinterpret_cast<char *>(file._buffer),
+                    static_cast<std::streamsize>(file._size))) {
+            ret = std::move(file);
+        }
+    }
+#endif
+
+    return ret;
+}
+
+std::span<const std::byte> MappedFile::bytes() const {
+    return {_data, _size};
+}
+
+std::uint64_t readLittleEndian(std::span<const std::byte> bytes) {
+    std::uint64_t ret = 0;
+
+    for (std::size_t i = bytes.size(); i > 0; i--) {
+        ret = (ret << 8) | std::to_integer<std::uint64_t>(bytes[i - 1]);
+    }
+
+    return ret;
+}
+
+void appendLittleEndian(std::string &out, std::uint64_t value, std::size_t bytes) {
+    for (std::size_t i = 0; i < bytes; i++) {
+        out.push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+    }
+}
+
+}  // namespace chess
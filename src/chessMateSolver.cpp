@@ -0,0 +1,198 @@
+#include "chessMateSolver.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "chessBase.hpp"
+#include "chessBoard.hpp"
+#include "chessGame.hpp"
+#include "chessMoveList.hpp"
+#include "chessPosition.hpp"
+
+namespace chess {
+
+/**
+ * a proof or disproof number that can't be reached, the position is disproven or proven
+ */
+static constexpr std::uint32_t infinity = 1u << 30;
+
+static std::uint32_t saturate(std::int64_t value) {
+    return static_cast<std::uint32_t>(std::clamp<std::int64_t>(value, 0, infinity));
+}
+
+bool MateResult::complete() const { return unknown.empty(); }
+
+MateSolver::MateSolver(std::size_t tableEntries)
+    : _table(std::bit_ceil(std::max<std::size_t>(tableEntries, 1)), Entry{0, 0, 0}),
+      _board(64, false),
+      _white(PieceColor::white),
+      _black(PieceColor::black),
+      _game(_board, _white, _black),
+      _attacker(PieceColor::white),
+      _nodes(0),
+      _maxNodes(0) {}
+
+std::uint64_t MateSolver::key(std::uint64_t hash, int plies) const {
+    // the same position is a different node with fewer plies left or the other side attacking
+    return hash ^ (static_cast<std::uint64_t>(plies + 1) * 0x9e3779b97f4a7c15ull) ^
+           (_attacker == PieceColor::black ? 0xd1b54a32d192ed03ull : 0);
+}
+
+void MateSolver::refresh(Move &move) {
+    move.startPiece = _game.board.pieceMap.at(move.start).get();
+    move.endPiece = _game.board.pieceMap.at(move.end).get();
+}
+
+void MateSolver::generate(MoveList &moves) {
+    moves.clear();
+    for (const Move &move : _game.legalMoves()) {
+        if (move.startPiece->notation == 'p' && (move.end[1] == '8' || move.end[1] == '1')) {
+            for (char promotion : {'q', 'r', 'b', 'n'}) {
+                moves.push_back(move);
+                moves.back().promotion = promotion;
+            }
+        } else {
+            moves.push_back(move);
+        }
+    }
+}
+
+std::pair<std::uint32_t, std::uint32_t> MateSolver::search(std::uint64_t nodeKey, int plies,
+                                                           std::uint32_t proofLimit,
+                                                           std::uint32_t disproofLimit) {
+    bool attacking = _game.currentPlayer->color == _attacker;
+    Children &children = _children[plies];
+    std::uint32_t proof = 1;
+    std::uint32_t disproof = 1;
+
+    _nodes++;
+    generate(children.moves);
+
+    if (children.moves.empty()) {
+        bool mated = !attacking && _game.isKingInCheck(_game.currentPlayer->color);
+        proof = mated ? 0 : infinity;
+        disproof = mated ? infinity : 0;
+    } else if (plies <= 0) {
+        proof = infinity;
+        disproof = 0;
+    } else {
+        for (std::size_t i = 0; i < children.moves.size(); i++) {
+            Entry entry = {0, 1, 1};
+
+            refresh(children.moves[i]);
+            if (_game.makeMove(children.moves[i]) == RunResult::turnedPassed) {
+                children.keys[i] = key(_game.positionHash(), plies - 1);
+                entry = _table[children.keys[i] & (_table.size() - 1)];
+
+                if (plies == 1) {
+                    // the attacker's last move, only a mate counts and that's all there is to see
+                    bool mated = _game.isKingInCheck(_game.currentPlayer->color) &&
+                                 _game.legalMoves().empty();
+                    entry = {children.keys[i], mated ? 0 : infinity, mated ? infinity : 0};
+                    _nodes++;
+                } else if (entry.key != children.keys[i] ||
+                           (entry.proof == 0 && entry.disproof == 0)) {
+                    entry = {children.keys[i], 1, 1};
+                }
+                _game.undoLastMove();
+            } else {
+                entry = {0, infinity, 0};
+            }
+
+            children.proof[i] = entry.proof;
+            children.disproof[i] = entry.disproof;
+        }
+
+        while (true) {
+            std::int64_t sum = 0;
+            std::uint32_t least = infinity;
+            std::uint32_t second = infinity;
+            std::size_t best = 0;
+
+            // an attacker needs one move that mates, a defender one move that doesn't
+            for (std::size_t i = 0; i < children.moves.size(); i++) {
+                std::uint32_t smallest = attacking ? children.proof[i] : children.disproof[i];
+
+                sum += attacking ? children.disproof[i] : children.proof[i];
+                if (smallest < least) {
+                    second = least;
+                    least = smallest;
+                    best = i;
+                } else if (smallest < second) {
+                    second = smallest;
+                }
+            }
+
+            proof = attacking ? least : saturate(sum);
+            disproof = attacking ? saturate(sum) : least;
+            if (proof >= proofLimit || disproof >= disproofLimit || _nodes >= _maxNodes) {
+                break;
+            }
+
+            std::uint32_t childProof =
+                attacking ? std::min<std::uint32_t>(proofLimit, saturate(second + 1ll))
+                          : saturate(std::int64_t{proofLimit} - proof + children.proof[best]);
+            std::uint32_t childDisproof =
+                attacking
+                    ? saturate(std::int64_t{disproofLimit} - disproof + children.disproof[best])
+                    : std::min<std::uint32_t>(disproofLimit, saturate(second + 1ll));
+            Move &move = children.moves[best];
+
+            refresh(move);
+            _game.makeMove(move);
+            std::tie(children.proof[best], children.disproof[best]) =
+                search(children.keys[best], plies - 1, childProof, childDisproof);
+            _game.undoLastMove();
+        }
+    }
+
+    _table[nodeKey & (_table.size() - 1)] = {nodeKey, proof, disproof};
+
+    return {proof, disproof};
+}
+
+MateResult MateSolver::solve(const Position &position, int moves, std::int64_t maxNodes) {
+    MateResult ret = {{}, {}, {}, 0};
+    int plies = 2 * moves - 1;
+    MoveList rootMoves{};
+
+    _nodes = 0;
+    _maxNodes = maxNodes;
+    if (_game.loadPosition(position)) {
+        _attacker = _game.currentPlayer->color;
+        _children.resize(std::max<std::size_t>(_children.size(), std::max(plies, 0) + 1));
+        generate(rootMoves);
+    }
+
+    for (Move &move : rootMoves) {
+        std::string uci = moveToUCI(move);
+        std::pair<std::uint32_t, std::uint32_t> result = {infinity, 0};
+
+        refresh(move);
+        if (plies > 0 && _game.makeMove(move) == RunResult::turnedPassed) {
+            result = _nodes < _maxNodes ? search(key(_game.positionHash(), plies - 1), plies - 1,
+                                                 infinity, infinity)
+                                        : std::pair<std::uint32_t, std::uint32_t>{1, 1};
+            _game.undoLastMove();
+        }
+
+        if (result.first == 0) {
+            ret.mates.push_back(uci);
+        } else if (result.second == 0) {
+            ret.refuted.push_back(uci);
+        } else {
+            ret.unknown.push_back(uci);
+        }
+    }
+    ret.nodes = _nodes;
+
+    return ret;
+}
+
+}  // namespace chess
@@ -0,0 +1,53 @@
+#include "chessMaterial.hpp"
+
+#include <algorithm>
+
+#include "chessBase.hpp"
+#include "chessBoard.hpp"
+#include "chessPiece.hpp"
+#include "chessTables.hpp"
+
+namespace chess::material {
+
+Key count(const Board &board) {
+    Key ret = 0;
+
+    for (auto &[pos, piece] : board.pieceMap) {
+        if (piece != nullptr) {
+            auto [file, rank] = chessPosToPair(pos);
+            ret += material::piece(piece->color, piece->notation, (file + rank) % 2 == 1);
+        }
+    }
+
+    return ret;
+}
+
+/**
+ * king moves from `square` to the closest of the 4 center squares
+ */
+static int centerDistance(int square) {
+    int file = square % 8;
+    int rank = square / 8;
+    return std::max(std::max(3 - file, file - 4), std::max(3 - rank, rank - 4));
+}
+
+int evaluate(Endgame endgame, int balance, int whiteKing, int blackKing) {
+    int ret = balance;
+    bool kingsKnown = whiteKing >= 0 && blackKing >= 0;
+
+    if (endgame == Endgame::insufficientMaterial) {
+        ret = 0;
+    } else if (endgame == Endgame::drawish) {
+        ret = balance / 8;
+    } else if ((endgame == Endgame::loneWhiteKing || endgame == Endgame::loneBlackKing) &&
+               kingsKnown) {
+        int lone = endgame == Endgame::loneWhiteKing ? whiteKing : blackKing;
+        int mopUp =
+            20 * centerDistance(lone) + 10 * (7 - tables::kingDistance[whiteKing][blackKing]);
+        ret += endgame == Endgame::loneWhiteKing ? -mopUp : mopUp;
+    }
+
+    return ret;
+}
+
+}  // namespace chess::material
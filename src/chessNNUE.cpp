@@ -0,0 +1,311 @@
+#include "chessNNUE.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "chessBase.hpp"
+#include "chessGame.hpp"
+#include "chessMappedFile.hpp"
+#include "chessPosition.hpp"
+#include "chessZobrist.hpp"
+
+#if defined(__AVX2__) && !defined(CHESS_NNUE_SCALAR)
+#define CHESS_NNUE_AVX2
+#include <immintrin.h>
+#elif defined(__SSE2__) && !defined(CHESS_NNUE_SCALAR)
+#define CHESS_NNUE_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace chess::nnue {
+
+static constexpr std::string_view networkMagic = "CHSNNUE1";
+static constexpr std::size_t headerSize = 16;
+static constexpr std::size_t fileSize =
+    headerSize + (inputs * hidden + hidden + 2 * hidden) * sizeof(std::int16_t) + 4;
+static constexpr std::string_view pieceTypes = "pnbrqk";
+
+static_assert(hidden % 16 == 0, "the accumulators are updated 16 values at a time");
+
+/**
+ * the input of `piece` (a FEN letter) on `square` as seen by `perspective` (0 white, 1 black)
+ */
+static int featureIndex(int perspective, char piece, int square) {
+    int color = std::isupper(piece) ? 0 : 1;
+    int type = static_cast<int>(pieceTypes.find(static_cast<char>(std::tolower(piece))));
+
+    return ((color == perspective ? 0 : 1) * 6 + type) * 64 +
+           (perspective == 0 ? square : square ^ 56);
+}
+
+static bool isPiece(char piece) {
+    return piece != '\0' &&
+           pieceTypes.find(static_cast<char>(std::tolower(piece))) != std::string_view::npos;
+}
+
+static void addWeights(std::array<std::int16_t, hidden> &values, const std::int16_t *weights) {
+#if defined(CHESS_NNUE_AVX2)
+    for (int i = 0; i < hidden; i += 16) {
+        __m256i *value = reinterpret_cast<__m256i *>(values.data() + i);
+        __m256i weight = _mm256_load_si256(reinterpret_cast<const __m256i *>(weights + i));
+        _mm256_store_si256(value, _mm256_add_epi16(_mm256_load_si256(value), weight));
+    }
+#elif defined(CHESS_NNUE_SSE2)
+    for (int i = 0; i < hidden; i += 8) {
+        __m128i *value = reinterpret_cast<__m128i *>(values.data() + i);
+        __m128i weight = _mm_load_si128(reinterpret_cast<const __m128i *>(weights + i));
+        _mm_store_si128(value, _mm_add_epi16(_mm_load_si128(value), weight));
+    }
+#else
+    for (int i = 0; i < hidden; i++) {
+        values[i] = static_cast<std::int16_t>(values[i] + weights[i]);
+    }
+#endif
+}
+
+static void subtractWeights(std::array<std::int16_t, hidden> &values,
+                            const std::int16_t *weights) {
+#if defined(CHESS_NNUE_AVX2)
+    for (int i = 0; i < hidden; i += 16) {
+        __m256i *value = reinterpret_cast<__m256i *>(values.data() + i);
+        __m256i weight = _mm256_load_si256(reinterpret_cast<const __m256i *>(weights + i));
+        _mm256_store_si256(value, _mm256_sub_epi16(_mm256_load_si256(value), weight));
+    }
+#elif defined(CHESS_NNUE_SSE2)
+    for (int i = 0; i < hidden; i += 8) {
+        __m128i *value = reinterpret_cast<__m128i *>(values.data() + i);
+        __m128i weight = _mm_load_si128(reinterpret_cast<const __m128i *>(weights + i));
+        _mm_store_si128(value, _mm_sub_epi16(_mm_load_si128(value), weight));
+    }
+#else
+    for (int i = 0; i < hidden; i++) {
+        values[i] = static_cast<std::int16_t>(values[i] - weights[i]);
+    }
+#endif
+}
+
+/**
+ * the hidden values clipped to [0, `activationMax`] times `weights`, summed
+ */
+static std::int32_t clippedDot(const std::array<std::int16_t, hidden> &values,
+                               const std::int16_t *weights) {
+    std::int32_t ret = 0;
+
+#if defined(CHESS_NNUE_AVX2)
+    __m256i sum = _mm256_setzero_si256();
+    __m256i low = _mm256_setzero_si256();
+    __m256i high = _mm256_set1_epi16(activationMax);
+
+    for (int i = 0; i < hidden; i += 16) {
+        __m256i value = _mm256_load_si256(reinterpret_cast<const __m256i *>(values.data() + i));
+        __m256i weight = _mm256_load_si256(reinterpret_cast<const __m256i *>(weights + i));
+        value = _mm256_min_epi16(_mm256_max_epi16(value, low), high);
+        sum = _mm256_add_epi32(sum, _mm256_madd_epi16(value, weight));
+    }
+
+    __m128i half = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+    half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0x4e));
+    half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0xb1));
+    ret = _mm_cvtsi128_si32(half);
+#elif defined(CHESS_NNUE_SSE2)
+    __m128i sum = _mm_setzero_si128();
+    __m128i low = _mm_setzero_si128();
+    __m128i high = _mm_set1_epi16(activationMax);
+
+    for (int i = 0; i < hidden; i += 8) {
+        __m128i value = _mm_load_si128(reinterpret_cast<const __m128i *>(values.data() + i));
+        __m128i weight = _mm_load_si128(reinterpret_cast<const __m128i *>(weights + i));
+        value = _mm_min_epi16(_mm_max_epi16(value, low), high);
+        sum = _mm_add_epi32(sum, _mm_madd_epi16(value, weight));
+    }
+
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4e));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xb1));
+    ret = _mm_cvtsi128_si32(sum);
+#else
+    for (int i = 0; i < hidden; i++) {
+        std::int32_t value = std::clamp<std::int32_t>(values[i], 0, activationMax);
+        ret += value * weights[i];
+    }
+#endif
+
+    return ret;
+}
+
+std::unique_ptr<Network> Network::load(const std::string &path) {
+    std::unique_ptr<Network> ret = nullptr;
+    std::optional<MappedFile> file = MappedFile::open(path);
+
+    if (file.has_value()) {
+        std::span<const std::byte> bytes = file->bytes();
+
+        if (bytes.size() == fileSize &&
+            std::memcmp(bytes.data(), networkMagic.data(), networkMagic.size()) == 0 &&
+            readLittleEndian(bytes.subspan(8, 4)) == inputs &&
+            readLittleEndian(bytes.subspan(12, 4)) == hidden) {
+            std::size_t offset = headerSize;
+            auto next16 = [&]() -> std::int16_t {
+                offset += 2;
+                return static_cast<std::int16_t>(readLittleEndian(bytes.subspan(offset - 2, 2)));
+            };
+
+            ret = std::make_unique<Network>();
+            for (std::int16_t &weight : ret->featureWeights) {
+                weight = next16();
+            }
+            for (std::int16_t &bias : ret->featureBiases) {
+                bias = next16();
+            }
+            for (std::int16_t &weight : ret->outputWeights) {
+                weight = next16();
+            }
+            ret->outputBias = static_cast<std::int32_t>(readLittleEndian(bytes.subspan(offset, 4)));
+        }
+    }
+
+    return ret;
+}
+
+std::unique_ptr<Network> Network::generate(std::uint64_t seed) {
+    static constexpr std::array<int, 5> pieceValues = {1, 3, 3, 5, 9};
+    // a piece adds this much to its counting value, 9 queens stay under `activationMax`
+    static constexpr int countWeight = 16;
+    // so a pawn counts 100 once scaled: 16 * 255 * 400 / (255 * 64)
+    static constexpr int pawnWeight = activationMax;
+    static constexpr int countingValues = 2 * static_cast<int>(pieceValues.size());
+
+    std::unique_ptr<Network> ret = std::make_unique<Network>();
+    std::uint64_t state = seed;
+    auto random = [&](int bound) -> std::int16_t {
+        return static_cast<std::int16_t>(
+            static_cast<int>(zobrist::splitMix64(state) % (2 * bound + 1)) - bound);
+    };
+
+    for (int feature = 0; feature < inputs; feature++) {
+        int type = feature / 64 % 6;
+        int counting = feature / (6 * 64) * static_cast<int>(pieceValues.size()) + type;
+
+        for (int i = 0; i < hidden; i++) {
+            ret->featureWeights[feature * hidden + i] =
+                i >= countingValues ? random(8)
+                : i == counting && type < static_cast<int>(pieceValues.size())
+                    ? countWeight
+                    : 0;
+        }
+    }
+
+    for (int i = 0; i < hidden; i++) {
+        int type = i % static_cast<int>(pieceValues.size());
+        int sign = i < static_cast<int>(pieceValues.size()) ? 1 : -1;
+
+        ret->featureBiases[i] = i >= countingValues ? random(16) : 0;
+        ret->outputWeights[i] =
+            i >= countingValues ? random(4)
+                                : static_cast<std::int16_t>(sign * pawnWeight * pieceValues[type]);
+        ret->outputWeights[hidden + i] = i >= countingValues ? random(4) : 0;
+    }
+    ret->outputBias = 0;
+
+    return ret;
+}
+
+bool Network::save(const std::string &path) const {
+    std::string out(networkMagic);
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+
+    out.reserve(fileSize);
+    appendLittleEndian(out, inputs, 4);
+    appendLittleEndian(out, hidden, 4);
+    for (std::int16_t weight : featureWeights) {
+        appendLittleEndian(out, static_cast<std::uint16_t>(weight), 2);
+    }
+    for (std::int16_t bias : featureBiases) {
+        appendLittleEndian(out, static_cast<std::uint16_t>(bias), 2);
+    }
+    for (std::int16_t weight : outputWeights) {
+        appendLittleEndian(out, static_cast<std::uint16_t>(weight), 2);
+    }
+    appendLittleEndian(out, static_cast<std::uint32_t>(outputBias), 4);
+
+    return file && file.write(out.data(), static_cast<std::streamsize>(out.size())) &&
+           file.flush();
+}
+
+Evaluator::Evaluator(std::shared_ptr<const Network> network)
+    : _network(std::move(network)), _position(), _accumulator() {
+    // the empty board, every square of the first position evaluated counts as changed
+    _position.pieces.fill('\0');
+    _accumulator.values[0] = _network->featureBiases;
+    _accumulator.values[1] = _network->featureBiases;
+}
+
+int Evaluator::evaluate(const Position &position) {
+    for (int square = 0; square < 64; square++) {
+        char before = _position.pieces[square];
+        char after = position.pieces[square];
+
+        if (before != after) {
+            for (int perspective = 0; perspective < 2; perspective++) {
+                if (isPiece(before)) {
+                    subtractWeights(_accumulator.values[perspective],
+                                    &_network->featureWeights[featureIndex(perspective, before,
+                                                                           square) *
+                                                              hidden]);
+                }
+                if (isPiece(after)) {
+                    addWeights(_accumulator.values[perspective],
+                               &_network->featureWeights[featureIndex(perspective, after, square) *
+                                                         hidden]);
+                }
+            }
+        }
+    }
+    _position = position;
+
+    return forward(*_network, _accumulator, position.sideToMove);
+}
+
+int Evaluator::evaluate(Game &game) { return evaluate(game.position()); }
+
+const Accumulator &Evaluator::accumulator() const { return _accumulator; }
+
+Accumulator Evaluator::refresh(const Network &network, const Position &position) {
+    Accumulator ret{};
+
+    for (int perspective = 0; perspective < 2; perspective++) {
+        ret.values[perspective] = network.featureBiases;
+        for (int square = 0; square < 64; square++) {
+            if (isPiece(position.pieces[square])) {
+                addWeights(ret.values[perspective],
+                           &network.featureWeights[featureIndex(perspective,
+                                                                position.pieces[square], square) *
+                                                   hidden]);
+            }
+        }
+    }
+
+    return ret;
+}
+
+int Evaluator::forward(const Network &network, const Accumulator &accumulator,
+                       PieceColor sideToMove) {
+    int us = sideToMove == PieceColor::white ? 0 : 1;
+    const std::int16_t *weights = network.outputWeights.data();
+    std::int64_t sum = network.outputBias + clippedDot(accumulator.values[us], weights) +
+                       clippedDot(accumulator.values[1 - us], weights + hidden);
+
+    return static_cast<int>(sum * evalScale / (activationMax * outputQuantization));
+}
+
+}  // namespace chess::nnue
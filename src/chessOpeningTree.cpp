@@ -0,0 +1,268 @@
+#include "chessOpeningTree.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "chessArchive.hpp"
+#include "chessBase.hpp"
+#include "chessBoard.hpp"
+#include "chessGame.hpp"
+#include "chessMappedFile.hpp"
+
+namespace chess {
+
+static constexpr std::string_view treeMagic = "CHSOPN02";
+static constexpr std::size_t headerSize = 24;
+static constexpr std::size_t positionSize = 16;
+static constexpr std::size_t moveSize = 28;
+/**
+ * games a worker takes from the archive at a time
+ */
+static constexpr std::size_t gamesPerChunk = 64;
+
+struct MoveStats {
+    std::uint64_t position;
+    std::uint32_t games;
+    std::uint32_t whiteWins;
+    std::uint32_t draws;
+    std::uint32_t blackWins;
+};
+
+/**
+ * the moves played from one position, keyed by packed move
+ */
+using PositionStats = std::unordered_map<std::uint16_t, MoveStats>;
+using TreeStats = std::unordered_map<std::uint64_t, PositionStats>;
+
+static void count(MoveStats &stats, WinSearchResult result) {
+    stats.games++;
+    stats.whiteWins += result == WinSearchResult::whiteWinCheckmate ? 1 : 0;
+    stats.blackWins += result == WinSearchResult::blackWinCheckmate ? 1 : 0;
+    stats.draws += result != WinSearchResult::nothing &&
+                           result != WinSearchResult::whiteWinCheckmate &&
+                           result != WinSearchResult::blackWinCheckmate
+                       ? 1
+                       : 0;
+}
+
+static void merge(TreeStats &into, TreeStats &from) {
+    for (auto &[position, moves] : from) {
+        PositionStats &target = into[position];
+
+        if (target.empty()) {
+            target = std::move(moves);
+        } else {
+            for (auto &[move, stats] : moves) {
+                auto [it, inserted] = target.try_emplace(move, stats);
+
+                if (!inserted) {
+                    it->second.games += stats.games;
+                    it->second.whiteWins += stats.whiteWins;
+                    it->second.draws += stats.draws;
+                    it->second.blackWins += stats.blackWins;
+                }
+            }
+        }
+    }
+    from.clear();
+}
+
+static bool writeTree(const TreeStats &tree, const std::string &path, std::uint32_t minGames) {
+    std::vector<std::uint64_t> positions{};
+    std::string positionBytes{};
+    std::string moveBytes{};
+    std::uint64_t moveCount = 0;
+
+    for (auto &[position, moves] : tree) {
+        positions.push_back(position);
+    }
+    std::sort(positions.begin(), positions.end());
+
+    for (std::uint64_t position : positions) {
+        std::vector<std::pair<std::uint16_t, MoveStats>> moves{};
+
+        for (auto &[move, stats] : tree.at(position)) {
+            if (stats.games >= minGames) {
+                moves.emplace_back(move, stats);
+            }
+        }
+
+        if (!moves.empty()) {
+            std::sort(moves.begin(), moves.end(), [](auto &a, auto &b) -> bool {
+                return a.second.games != b.second.games ? a.second.games > b.second.games
+                                                        : a.first < b.first;
+            });
+
+            appendLittleEndian(positionBytes, position, 8);
+            appendLittleEndian(positionBytes, moveCount, 4);
+            appendLittleEndian(positionBytes, moves.size(), 4);
+
+            for (auto &[move, stats] : moves) {
+                appendLittleEndian(moveBytes, stats.position, 8);
+                appendLittleEndian(moveBytes, move, 2);
+                appendLittleEndian(moveBytes, 0, 2);
+                appendLittleEndian(moveBytes, stats.games, 4);
+                appendLittleEndian(moveBytes, stats.whiteWins, 4);
+                appendLittleEndian(moveBytes, stats.draws, 4);
+                appendLittleEndian(moveBytes, stats.blackWins, 4);
+            }
+            moveCount += moves.size();
+        }
+    }
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    std::string header(treeMagic);
+
+    appendLittleEndian(header, positionBytes.size() / positionSize, 8);
+    appendLittleEndian(header, moveCount, 8);
+
+    return out.write(header.data(), static_cast<std::streamsize>(header.size())) &&
+           out.write(positionBytes.data(), static_cast<std::streamsize>(positionBytes.size())) &&
+           out.write(moveBytes.data(), static_cast<std::streamsize>(moveBytes.size())) &&
+           out.flush();
+}
+
+static OpeningMove readMove(std::span<const std::byte> bytes) {
+    auto read32 = [&](std::size_t offset) -> std::uint32_t {
+        return static_cast<std::uint32_t>(readLittleEndian(bytes.subspan(offset, 4)));
+    };
+
+    return {unpackMove(static_cast<std::uint16_t>(readLittleEndian(bytes.subspan(8, 2)))),
+            readLittleEndian(bytes.subspan(0, 8)),
+            read32(12),
+            read32(16),
+            read32(20),
+            read32(24)};
+}
+
+bool buildOpeningTree(const GameArchive &archive, const std::string &path,
+                      const OpeningTreeConfig &config) {
+    std::atomic<std::size_t> nextChunk = 0;
+    int threads = threadCount(config.threads);
+    std::vector<TreeStats> threadStats(threads);
+
+    auto worker = [&](TreeStats &tree) {
+        HeadlessGame headless;
+        Game &game = headless.game;
+
+        for (std::size_t chunk = nextChunk++; chunk * gamesPerChunk < archive.size();
+             chunk = nextChunk++) {
+            std::size_t end = std::min(archive.size(), (chunk + 1) * gamesPerChunk);
+
+            for (std::size_t i = chunk * gamesPerChunk; i < end; i++) {
+                std::optional<ArchivedGame> archived = archive.game(i);
+                std::size_t plies = archived.has_value() ? archived->plies() : 0;
+                bool legal = archived.has_value() &&
+                             game.loadFEN(archived->fen.empty() ? std::string(startingFEN)
+                                                                : std::string(archived->fen));
+
+                plies = std::min(plies, static_cast<std::size_t>(std::max(config.maxPlies, 0)));
+
+                for (std::size_t ply = 0; ply < plies && legal; ply++) {
+                    std::uint64_t position = game.positionHash();
+                    std::optional<Move> move = game.moveFromUCI(archived->moveUCI(ply));
+                    legal = move.has_value() && game.makeMove(*move) == RunResult::turnedPassed;
+
+                    if (legal) {
+                        MoveStats &stats = tree[position].try_emplace(archived->packedMove(ply))
+                                               .first->second;
+                        stats.position = game.positionHash();
+                        count(stats, archived->result);
+                    }
+                }
+            }
+        }
+    };
+
+    {
+        std::vector<std::jthread> pool{};
+        for (TreeStats &tree : threadStats) {
+            pool.emplace_back(worker, std::ref(tree));
+        }
+    }
+
+    for (std::size_t i = 1; i < threadStats.size(); i++) {
+        merge(threadStats[0], threadStats[i]);
+    }
+
+    return writeTree(threadStats[0], path, config.minGames);
+}
+
+OpeningTree::OpeningTree(MappedFile file, std::span<const std::byte> positions,
+                         std::span<const std::byte> moves)
+    : _file(std::move(file)), _positions(positions), _moves(moves) {}
+
+std::optional<OpeningTree> OpeningTree::open(const std::string &path) {
+    std::optional<OpeningTree> ret = std::nullopt;
+    std::optional<MappedFile> file = MappedFile::open(path);
+
+    if (file.has_value()) {
+        std::span<const std::byte> bytes = file->bytes();
+
+        if (bytes.size() >= headerSize &&
+            std::memcmp(bytes.data(), treeMagic.data(), treeMagic.size()) == 0) {
+            std::uint64_t positions = readLittleEndian(bytes.subspan(8, 8));
+            std::uint64_t moves = readLittleEndian(bytes.subspan(16, 8));
+            std::size_t available = bytes.size() - headerSize;
+
+            if (positions <= available / positionSize &&
+                moves == (available - positions * positionSize) / moveSize) {
+                std::span<const std::byte> positionBytes =
+                    bytes.subspan(headerSize, positions * positionSize);
+                std::span<const std::byte> moveBytes =
+                    bytes.subspan(headerSize + positionBytes.size(), moves * moveSize);
+                ret = OpeningTree(std::move(*file), positionBytes, moveBytes);
+            }
+        }
+    }
+
+    return ret;
+}
+
+std::size_t OpeningTree::size() const {
+    return _positions.size() / positionSize;
+}
+
+std::vector<OpeningMove> OpeningTree::moves(std::uint64_t position) const {
+    std::vector<OpeningMove> ret{};
+    std::size_t low = 0;
+    std::size_t high = size();
+
+    while (low < high) {
+        std::size_t middle = low + (high - low) / 2;
+
+        if (readLittleEndian(_positions.subspan(middle * positionSize, 8)) < position) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    if (low < size() && readLittleEndian(_positions.subspan(low * positionSize, 8)) == position) {
+        std::span<const std::byte> entry = _positions.subspan(low * positionSize, positionSize);
+        std::uint64_t first = readLittleEndian(entry.subspan(8, 4));
+        std::uint64_t count = readLittleEndian(entry.subspan(12, 4));
+
+        for (std::uint64_t i = first; i < first + count && (i + 1) * moveSize <= _moves.size();
+             i++) {
+            ret.push_back(readMove(_moves.subspan(i * moveSize, moveSize)));
+        }
+    }
+
+    return ret;
+}
+
+}  // namespace chess
@@ -1,22 +1,95 @@
 #include "chessPiece.hpp"
 
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdlib>
 #include <memory>
 #include <optional>
+#include <string>
 #include <utility>
 
 #include "chessBase.hpp"
 #include "chessBoard.hpp"
+#include "chessGeometry.hpp"
+#include "chessPieceArena.hpp"
+#include "chessTables.hpp"
+#include "chessTrace.hpp"
 
 namespace chess {
 
+/**
+ * whether every square strictly between two squares of the 8x8 board is empty
+ */
+static bool isPathClear(const std::map<std::string, std::unique_ptr<Piece>> &pieceMap, int from,
+                        int to) {
+    bool ret = true;
+
+    for (tables::SquareSet squares = tables::between[from][to]; squares != 0 && ret;
+         squares &= squares - 1) {
+        ret = pieceMap.at(std::string(BoardGeometry<8>::name(std::countr_zero(squares)))) ==
+              nullptr;
+    }
+
+    return ret;
+}
+
+/**
+ * whether a piece sliding along ranks and files (`straight`) and/or diagonals (`diagonal`)
+ * can go from `from` to `to` without jumping over anything, what's on `to` isn't checked,
+ * squares of the 8x8 board take the paths from `chessTables.hpp`
+ */
+static bool canSlide(const std::map<std::string, std::unique_ptr<Piece>> &pieceMap,
+                     const std::string &from, const std::string &to, bool straight,
+                     bool diagonal) {
+    bool ret = false;
+    int start = tables::squareIndex(from);
+    int end = tables::squareIndex(to);
+    std::pair<int, int> absDist = absDistance(from, to);
+    bool aligned = absDist != std::pair(0, 0) &&
+                   ((straight && (absDist.first == 0 || absDist.second == 0)) ||
+                    (diagonal && absDist.first == absDist.second));
+
+    if (aligned && start >= 0 && end >= 0) {
+        ret = isPathClear(pieceMap, start, end);
+    } else if (aligned) {
+        std::pair<int, int> dist = relativeDistance(to, from);
+        std::pair<int, int> dir = {(dist.first > 0) - (dist.first < 0),
+                                   (dist.second > 0) - (dist.second < 0)};
+        std::pair<int, int> p = chessPosToPair(from);
+
+        ret = true;
+        for (int i = 1; i < std::max(absDist.first, absDist.second) && ret; i++) {
+            std::string square =
+                pairToChessPos({p.first + dir.first * i, p.second + dir.second * i});
+            ret = pieceMap.at(square) == nullptr;
+        }
+    }
+
+    return ret;
+}
+
 Piece::Piece(std::string position, int value, char notation, PieceColor color)
-    : _dstOverride(true),
-      position(position),
+    : position(position),
       value(value),
       notation(notation),
       color(color),
       moveCount(0) {}
 
+static_assert(std::max({sizeof(Pawn), sizeof(Rook), sizeof(Knight), sizeof(Bishop), sizeof(Queen),
+                        sizeof(King)}) <= PieceArena::maxPieceSize,
+              "every piece has to fit in a block of the arena");
+
+void *Piece::operator new(std::size_t size) { return PieceArena::allocate(size, nullptr); }
+
+void *Piece::operator new(std::size_t size, PieceArena *arena) {
+    return PieceArena::allocate(size, arena);
+}
+
+void Piece::operator delete(void *ptr) { PieceArena::release(ptr); }
+
+void Piece::operator delete(void *ptr, PieceArena *) { PieceArena::release(ptr); }
+
 std::vector<std::string> Piece::getVision(const Board &board, std::optional<Move> lastMove) {
     std::vector<std::string> ret;
     for (auto &[pos, square] : board.squaresMap) {
@@ -31,6 +104,7 @@ std::vector<std::string> Piece::getVision(const Board &board, std::optional<Move
 
 std::optional<MoveType> Pawn::canMove(const std::map<std::string, std::unique_ptr<Piece>> &pieceMap,
                                       std::string where, std::optional<Move> lastMove) {
+    CHESS_TRACE_SCOPE(canMove);
     std::optional<MoveType> ret = std::nullopt;
 
     if (pieceMap.contains(where)) {
@@ -65,7 +139,8 @@ std::optional<MoveType> Pawn::canMove(const std::map<std::string, std::unique_pt
                         break;
                     }
                 }
-            } else if (absDist == std::pair(1, 1) && lastMove->startPiece->notation == 'p' &&
+            } else if (absDist == std::pair(1, 1) && lastMove.has_value() &&
+                       lastMove->startPiece->notation == 'p' &&
                        lastMove->startPiece->color != color && lastMove->end[0] == where[0] &&
                        absDistance(position, lastMove->end) == std::pair(1, 0) &&
                        !isAhead(lastMove->end, where) &&
@@ -79,34 +154,14 @@ std::optional<MoveType> Pawn::canMove(const std::map<std::string, std::unique_pt
 }
 
 std::optional<MoveType> Rook::canMove(const std::map<std::string, std::unique_ptr<Piece>> &pieceMap,
-                                      std::string where, std::optional<Move> lastMove) {
+                                      std::string where, std::optional<Move>) {
+    CHESS_TRACE_SCOPE(canMove);
     std::optional<MoveType> ret = std::nullopt;
 
-    if (pieceMap.contains(where)) {
-        std::pair<int, int> absDist = absDistance(position, where);
-
-        if (pieceMap.at(where) != nullptr && pieceMap.at(where)->color == color) {
-            ret = std::nullopt;
-        } else if (absDist.first == 0 || absDist.second == 0) {
-            std::pair<int, int> dist = relativeDistance(position, where);
-            std::pair<int, int> dir = {dist.first / (dist.first == 0 ? 1 : absDist.first) * -1,
-                                       dist.second / (dist.second == 0 ? 1 : absDist.second) * -1};
-
-            for (int i = 1; i <= std::max(absDist.first, absDist.second); i++) {
-                std::pair<int, int> p = chessPosToPair(position);
-                std::string np = pairToChessPos({
-                    p.first + dir.first * i,
-                    p.second + dir.second * i,
-                });
-
-                if (np == where) {
-                    ret = MoveType::normal;
-                } else if (pieceMap.at(np) != nullptr) {
-                    ret = std::nullopt;
-                    break;
-                }
-            }
-        }
+    if (pieceMap.contains(where) &&
+        (pieceMap.at(where) == nullptr || pieceMap.at(where)->color != color) &&
+        canSlide(pieceMap, position, where, true, false)) {
+        ret = MoveType::normal;
     }
 
     return ret;
@@ -114,15 +169,25 @@ std::optional<MoveType> Rook::canMove(const std::map<std::string, std::unique_pt
 
 std::optional<MoveType> Knight::canMove(
     const std::map<std::string, std::unique_ptr<Piece>> &pieceMap, std::string where,
-    std::optional<Move> lastMove) {
+    std::optional<Move>) {
+    CHESS_TRACE_SCOPE(canMove);
     std::optional<MoveType> ret = std::nullopt;
 
     if (pieceMap.contains(where)) {
-        std::pair<int, int> absDist = absDistance(position, where);
+        int from = tables::squareIndex(position);
+        int to = tables::squareIndex(where);
+        bool jumps = false;
+
+        if (from >= 0 && to >= 0) {
+            jumps = (tables::knightAttacks[from] & tables::bit(to)) != 0;
+        } else {
+            std::pair<int, int> absDist = absDistance(position, where);
+            jumps = absDist == std::pair(2, 1) || absDist == std::pair(1, 2);
+        }
 
         if (pieceMap.at(where) != nullptr && pieceMap.at(where)->color == color) {
             ret = std::nullopt;
-        } else if (absDist == std::pair(2, 1) || absDist == std::pair(1, 2)) {
+        } else if (jumps) {
             ret = MoveType::normal;
         }
     }
@@ -132,34 +197,14 @@ std::optional<MoveType> Knight::canMove(
 
 std::optional<MoveType> Bishop::canMove(
     const std::map<std::string, std::unique_ptr<Piece>> &pieceMap, std::string where,
-    std::optional<Move> lastMove) {
+    std::optional<Move>) {
+    CHESS_TRACE_SCOPE(canMove);
     std::optional<MoveType> ret = std::nullopt;
 
-    if (pieceMap.contains(where)) {
-        std::pair<int, int> absDist = absDistance(position, where);
-
-        if (pieceMap.at(where) != nullptr && pieceMap.at(where)->color == color) {
-            ret = std::nullopt;
-        } else if (absDist.first == absDist.second) {
-            std::pair<int, int> dist = relativeDistance(position, where);
-            std::pair<int, int> dir = {dist.first / absDist.first * -1,
-                                       dist.second / absDist.second * -1};
-
-            for (int i = 1; i <= absDist.first; i++) {
-                std::pair<int, int> p = chessPosToPair(position);
-                std::string np = pairToChessPos({
-                    p.first + dir.first * i,
-                    p.second + dir.second * i,
-                });
-
-                if (np == where) {
-                    ret = MoveType::normal;
-                } else if (pieceMap.at(np) != nullptr) {
-                    ret = std::nullopt;
-                    break;
-                }
-            }
-        }
+    if (pieceMap.contains(where) &&
+        (pieceMap.at(where) == nullptr || pieceMap.at(where)->color != color) &&
+        canSlide(pieceMap, position, where, false, true)) {
+        ret = MoveType::normal;
     }
 
     return ret;
@@ -167,46 +212,22 @@ std::optional<MoveType> Bishop::canMove(
 
 std::optional<MoveType> Queen::canMove(
     const std::map<std::string, std::unique_ptr<Piece>> &pieceMap, std::string where,
-    std::optional<Move> lastMove) {
+    std::optional<Move>) {
+    CHESS_TRACE_SCOPE(canMove);
     std::optional<MoveType> ret = std::nullopt;
 
-    if (pieceMap.contains(where)) {
-        std::pair<int, int> absDist = absDistance(position, where);
-        std::pair<int, int> dist = relativeDistance(position, where);
-        std::pair<int, int> dir = {0, 0};
-
-        if (pieceMap.at(where) != nullptr && pieceMap.at(where)->color == color) {
-            ret = std::nullopt;
-        } else if (absDist.first == absDist.second) {
-            dir = {dist.first / absDist.first * -1, dist.second / absDist.second * -1};
-        } else if (absDist.first == 0 || absDist.second == 0) {
-            dir = {dist.first / (dist.first == 0 ? 1 : absDist.first) * -1,
-                   dist.second / (dist.second == 0 ? 1 : absDist.second) * -1};
-        }
-
-        if (dir != std::pair(0, 0)) {
-            for (int i = 1; i <= std::max(absDist.first, absDist.second); i++) {
-                std::pair<int, int> p = chessPosToPair(position);
-                std::string np = pairToChessPos({
-                    p.first + dir.first * i,
-                    p.second + dir.second * i,
-                });
-
-                if (np == where) {
-                    ret = MoveType::normal;
-                } else if (pieceMap.at(np) != nullptr) {
-                    ret = std::nullopt;
-                    break;
-                }
-            }
-        }
+    if (pieceMap.contains(where) &&
+        (pieceMap.at(where) == nullptr || pieceMap.at(where)->color != color) &&
+        canSlide(pieceMap, position, where, true, true)) {
+        ret = MoveType::normal;
     }
 
     return ret;
 }
 
 std::optional<MoveType> King::canMove(const std::map<std::string, std::unique_ptr<Piece>> &pieceMap,
-                                      std::string where, std::optional<Move> lastMove) {
+                                      std::string where, std::optional<Move>) {
+    CHESS_TRACE_SCOPE(canMove);
     std::optional<MoveType> ret = std::nullopt;
 
     if (pieceMap.contains(where)) {
@@ -218,58 +239,89 @@ std::optional<MoveType> King::canMove(const std::map<std::string, std::unique_pt
         } else if (absDist.first <= 1 && absDist.second <= 1) {
             ret = MoveType::normal;
         } else if (absDist == std::pair(2, 0) && moveCount == 0) {
-            if (dist.first > 0) {
-                std::string pos1 = {static_cast<char>(position[0] - 1), position[1]};
-                std::string pos2 = {static_cast<char>(position[0] - 2), position[1]};
-                std::string pos3 = {static_cast<char>(position[0] - 3), position[1]};
-                std::string pos4 = {static_cast<char>(position[0] - 4), position[1]};
-
-                Piece *piece1 = pieceMap.at(pos1).get();
-                Piece *piece2 = pieceMap.at(pos1).get();
-                Piece *piece3 = pieceMap.at(pos3).get();
-                Piece *piece4 = pieceMap.at(pos4).get();
-
-                for (auto &[pos, piece] : pieceMap) {
-                    if (piece == nullptr) {
-                        continue;
-                    }
+            bool isLong = dist.first > 0;
+            int step = isLong ? -1 : +1;
+            auto square = [&](int files) -> std::string {
+                return {static_cast<char>(position[0] + files * step), position[1]};
+            };
+            auto isEmpty = [&](const std::string &pos) -> bool {
+                return pieceMap.contains(pos) && pieceMap.at(pos) == nullptr;
+            };
+            auto rook = pieceMap.find(square(isLong ? 4 : 3));
+            PieceColor enemy = color == PieceColor::white ? PieceColor::black : PieceColor::white;
+
+            if (rook != pieceMap.end() && rook->second != nullptr &&
+                rook->second->notation == 'r' && rook->second->color == color &&
+                rook->second->moveCount == 0 && isEmpty(square(1)) && isEmpty(square(2)) &&
+                (!isLong || isEmpty(square(3))) && !isSquareAttacked(pieceMap, position, enemy) &&
+                !isSquareAttacked(pieceMap, square(1), enemy) &&
+                !isSquareAttacked(pieceMap, square(2), enemy)) {
+                ret = isLong ? MoveType::longCastle : MoveType::shortCastle;
+            }
+        }
+    }
 
-                    if (piece4 != nullptr && piece4->notation == 'r' && piece4->color == color &&
-                        piece1 == nullptr && piece2 == nullptr && piece3 == nullptr &&
-                        piece->color != color && !piece->canMove(pieceMap, pos1).has_value() &&
-                        !piece->canMove(pieceMap, pos2).has_value() &&
-                        !piece->canMove(pieceMap, pos3).has_value()) {
-                        ret = MoveType::longCastle;
-                        break;
-                    }
-                }
-            } else if (dist.first < 0) {
-                std::string pos1 = {static_cast<char>(position[0] + 1), position[1]};
-                std::string pos2 = {static_cast<char>(position[0] + 2), position[1]};
-                std::string pos3 = {static_cast<char>(position[0] + 3), position[1]};
-
-                Piece *piece1 = pieceMap.at(pos1).get();
-                Piece *piece2 = pieceMap.at(pos1).get();
-                Piece *piece3 = pieceMap.at(pos3).get();
-
-                for (auto &[pos, piece] : pieceMap) {
-                    if (piece == nullptr) {
-                        continue;
-                    }
+    return ret;
+}
 
-                    if (piece3 != nullptr && piece3->notation == 'r' && piece3->color == color &&
-                        piece1 == nullptr && piece2 == nullptr && piece->color != color &&
-                        !piece->canMove(pieceMap, pos1).has_value() &&
-                        !piece->canMove(pieceMap, pos2).has_value()) {
-                        ret = MoveType::shortCastle;
-                        break;
-                    }
-                }
-            }
+bool isSquareAttacked(const std::map<std::string, std::unique_ptr<Piece>> &pieceMap,
+                      const std::string &square, PieceColor by) {
+    bool ret = false;
+    int target = tables::squareIndex(square);
+
+    for (auto it = pieceMap.begin(); it != pieceMap.end() && !ret; it++) {
+        Piece *piece = it->second.get();
+
+        if (piece == nullptr || piece->color != by) {
+            continue;
+        }
+
+        int from = tables::squareIndex(piece->position);
+        std::pair<int, int> dist = relativeDistance(square, piece->position);
+
+        if (piece->notation == 'p' && from >= 0 && target >= 0) {
+            ret = (tables::pawnAttacks[static_cast<int>(by)][from] & tables::bit(target)) != 0;
+        } else if (piece->notation == 'p') {
+            ret = std::abs(dist.first) == 1 && dist.second == (by == PieceColor::white ? 1 : -1);
+        } else if (piece->notation == 'k' && from >= 0 && target >= 0) {
+            ret = (tables::kingAttacks[from] & tables::bit(target)) != 0;
+        } else if (piece->notation == 'k') {
+            ret = dist != std::pair(0, 0) && std::abs(dist.first) <= 1 &&
+                  std::abs(dist.second) <= 1;
+        } else {
+            ret = piece->canMove(pieceMap, square) == MoveType::normal;
         }
     }
 
     return ret;
 }
 
-}  // namespace chess
\ No newline at end of file
+std::unique_ptr<Piece> createPiece(char notation, std::string position, PieceColor color,
+                                   PieceArena *arena) {
+    std::unique_ptr<Piece> ret = nullptr;
+
+    switch (notation) {
+        case 'p':
+            ret.reset(new (arena) Pawn(position, 1, 'p', color));
+            break;
+        case 'r':
+            ret.reset(new (arena) Rook(position, 5, 'r', color));
+            break;
+        case 'n':
+            ret.reset(new (arena) Knight(position, 3, 'n', color));
+            break;
+        case 'b':
+            ret.reset(new (arena) Bishop(position, 3, 'b', color));
+            break;
+        case 'q':
+            ret.reset(new (arena) Queen(position, 9, 'q', color));
+            break;
+        case 'k':
+            ret.reset(new (arena) King(position, 0, 'k', color));
+            break;
+    }
+
+    return ret;
+}
+
+}  // namespace chess
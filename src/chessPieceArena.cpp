@@ -0,0 +1,86 @@
+#include "chessPieceArena.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <new>
+
+namespace chess {
+
+/**
+ * every piece is preceded by the arena it came from, nullptr if it came from the global allocator,
+ * the header of a free block holds the next free block instead
+ */
+union BlockHeader {
+    PieceArena *arena;
+    void *next;
+    std::max_align_t align;
+};
+
+static constexpr std::size_t blockSize = sizeof(BlockHeader) + PieceArena::maxPieceSize;
+
+static_assert(PieceArena::maxPieceSize % alignof(std::max_align_t) == 0);
+
+static BlockHeader *headerOf(void *ptr) {
+    return reinterpret_cast<BlockHeader *>(static_cast<std::byte *>(ptr) - sizeof(BlockHeader));
+}
+
+PieceArena::PieceArena() : _free(nullptr), _live(0), _detached(false) {}
+
+void PieceArena::Detach::operator()(PieceArena *arena) const {
+    arena->_detached = true;
+    if (arena->_live == 0) {
+        delete arena;
+    }
+}
+
+void *PieceArena::allocate(std::size_t size, PieceArena *arena) {
+    BlockHeader *header = nullptr;
+
+    if (arena != nullptr && size <= maxPieceSize) {
+        if (arena->_free == nullptr) {
+            arena->_chunks.push_back(std::make_unique<std::byte[]>(blockSize * piecesPerChunk));
+            for (std::size_t i = piecesPerChunk; i-- > 0;) {
+                BlockHeader *block =
+                    reinterpret_cast<BlockHeader *>(arena->_chunks.back().get() + i * blockSize);
+                block->next = arena->_free;
+                arena->_free = block;
+            }
+        }
+
+        header = static_cast<BlockHeader *>(arena->_free);
+        arena->_free = header->next;
+        arena->_live++;
+    } else {
+        header = static_cast<BlockHeader *>(::operator new(sizeof(BlockHeader) + size));
+        arena = nullptr;
+    }
+
+    header->arena = arena;
+
+    return reinterpret_cast<std::byte *>(header) + sizeof(BlockHeader);
+}
+
+void PieceArena::release(void *ptr) {
+    if (ptr != nullptr) {
+        BlockHeader *header = headerOf(ptr);
+        PieceArena *arena = header->arena;
+
+        if (arena != nullptr) {
+            header->next = arena->_free;
+            arena->_free = header;
+            arena->_live--;
+
+            if (arena->_detached && arena->_live == 0) {
+                delete arena;
+            }
+        } else {
+            ::operator delete(header);
+        }
+    }
+}
+
+std::size_t PieceArena::live() const { return _live; }
+
+std::size_t PieceArena::capacity() const { return _chunks.size() * piecesPerChunk; }
+
+}  // namespace chess
@@ -0,0 +1,137 @@
+#include "chessPosition.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <string_view>
+
+#include "chessBase.hpp"
+#include "chessTables.hpp"
+
+namespace chess {
+
+std::optional<Position> Position::fromFEN(std::string_view fen) {
+    std::optional<Position> ret = std::nullopt;
+    Position position{};
+    std::istringstream stream{std::string(fen)};
+    std::string placement{};
+    std::string side{};
+    std::string castling = "-";
+    std::string enPassant = "-";
+    std::string halfMoves = "0";
+    std::string fullMoves = "1";
+    int halfMoveClock{};
+    int fullMoveNumber{};
+    int rank = 8;
+    int file = 1;
+    bool valid = true;
+
+    stream >> placement >> side >> castling >> enPassant >> halfMoves >> fullMoves;
+
+    for (char c : placement) {
+        if (c == '/') {
+            valid = valid && file == 9 && rank > 1;
+            rank--;
+            file = 1;
+        } else if (c >= '1' && c <= '8') {
+            file += c - '0';
+        } else if (std::string_view("prnbqk").find(static_cast<char>(std::tolower(c))) !=
+                       std::string_view::npos &&
+                   file <= 8 && rank >= 1) {
+            position.pieces[(file - 1) + 8 * (rank - 1)] = c;
+            file++;
+        } else {
+            valid = false;
+        }
+    }
+
+    valid = valid && rank == 1 && file == 9 &&
+            std::ranges::count(position.pieces, 'K') == 1 &&
+            std::ranges::count(position.pieces, 'k') == 1;
+    valid = valid && (side == "w" || side == "b");
+    valid = valid && (castling == "-" || std::all_of(castling.begin(), castling.end(), [](char c) {
+                          return c == 'K' || c == 'Q' || c == 'k' || c == 'q';
+                      }));
+    valid = valid && (enPassant == "-" || (enPassant.length() == 2 && enPassant[0] >= 'a' &&
+                                           enPassant[0] <= 'h' &&
+                                           enPassant[1] == (side == "w" ? '6' : '3')));
+    valid = valid &&
+            std::from_chars(halfMoves.data(), halfMoves.data() + halfMoves.size(), halfMoveClock)
+                    .ec == std::errc{} &&
+            std::from_chars(fullMoves.data(), fullMoves.data() + fullMoves.size(), fullMoveNumber)
+                    .ec == std::errc{} &&
+            halfMoveClock >= 0 && halfMoveClock <= 0xffff && fullMoveNumber >= 1 &&
+            fullMoveNumber <= 0xffff;
+
+    if (valid) {
+        position.sideToMove = side == "w" ? PieceColor::white : PieceColor::black;
+        for (char c : castling) {
+            position.castling |= c == 'K'   ? whiteShortCastle
+                                 : c == 'Q' ? whiteLongCastle
+                                 : c == 'k' ? blackShortCastle
+                                 : c == 'q' ? blackLongCastle
+                                            : 0;
+        }
+        position.enPassantFile = enPassant != "-" ? enPassant[0] - 'a' + 1 : 0;
+        position.halfMoveClock = static_cast<std::uint16_t>(halfMoveClock);
+        position.fullMoveNumber = static_cast<std::uint16_t>(fullMoveNumber);
+        ret = position;
+    }
+
+    return ret;
+}
+
+std::string Position::toFEN() const {
+    std::string ret{};
+
+    for (int rank = 8; rank >= 1; rank--) {
+        int empty = 0;
+        for (int file = 1; file <= 8; file++) {
+            char piece = pieces[(file - 1) + 8 * (rank - 1)];
+
+            if (piece == '\0') {
+                empty++;
+            } else {
+                if (empty != 0) {
+                    ret += static_cast<char>('0' + empty);
+                    empty = 0;
+                }
+                ret += piece;
+            }
+        }
+
+        if (empty != 0) {
+            ret += static_cast<char>('0' + empty);
+        }
+        ret += rank == 1 ? ' ' : '/';
+    }
+
+    ret += sideToMove == PieceColor::white ? "w " : "b ";
+
+    std::string rights = std::string((castling & whiteShortCastle) != 0 ? "K" : "") +
+                         ((castling & whiteLongCastle) != 0 ? "Q" : "") +
+                         ((castling & blackShortCastle) != 0 ? "k" : "") +
+                         ((castling & blackLongCastle) != 0 ? "q" : "");
+    ret += rights.empty() ? "-" : rights;
+
+    if (enPassantFile >= 1 && enPassantFile <= 8) {
+        ret += std::string(" ") + static_cast<char>('a' + enPassantFile - 1) +
+               (sideToMove == PieceColor::white ? '6' : '3');
+    } else {
+        ret += " -";
+    }
+
+    ret += " " + std::to_string(halfMoveClock) + " " + std::to_string(fullMoveNumber);
+
+    return ret;
+}
+
+char Position::at(std::string_view square) const {
+    int index = tables::squareIndex(square);
+    return index >= 0 ? pieces[index] : '\0';
+}
+
+}  // namespace chess
@@ -0,0 +1,293 @@
+#include "chessPositionIndex.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include "chessArchive.hpp"
+#include "chessBase.hpp"
+#include "chessBoard.hpp"
+#include "chessGame.hpp"
+#include "chessMappedFile.hpp"
+
+namespace chess {
+
+static constexpr std::string_view indexMagic = "CHSPOS02";
+static constexpr std::size_t headerSize = 16;
+static constexpr std::size_t entrySize = 16;
+/**
+ * games a worker takes from the archive at a time
+ */
+static constexpr std::size_t gamesPerChunk = 64;
+/**
+ * entries read from a run file at a time while merging
+ */
+static constexpr std::size_t mergeBlockEntries = 4096;
+
+struct IndexEntry {
+    std::uint64_t hash;
+    std::uint32_t game;
+    std::uint32_t ply;
+
+    auto operator<=>(const IndexEntry &) const = default;
+};
+
+static void appendEntry(std::string &out, const IndexEntry &entry) {
+    appendLittleEndian(out, entry.hash, 8);
+    appendLittleEndian(out, entry.game, 4);
+    appendLittleEndian(out, entry.ply, 4);
+}
+
+static IndexEntry readEntry(std::span<const std::byte> bytes) {
+    return {readLittleEndian(bytes.subspan(0, 8)),
+            static_cast<std::uint32_t>(readLittleEndian(bytes.subspan(8, 4))),
+            static_cast<std::uint32_t>(readLittleEndian(bytes.subspan(12, 4)))};
+}
+
+/**
+ * sorts `entries` and writes them to `path`, returns `false` if it couldn't be written
+ */
+static bool writeRun(std::vector<IndexEntry> &entries, const std::string &path) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    std::string bytes{};
+
+    std::sort(entries.begin(), entries.end());
+    bytes.reserve(entries.size() * entrySize);
+    for (const IndexEntry &entry : entries) {
+        appendEntry(bytes, entry);
+    }
+
+    return static_cast<bool>(out.write(bytes.data(), static_cast<std::streamsize>(bytes.size())));
+}
+
+/**
+ * reads the entries of a sorted run file a block at a time
+ */
+class RunReader {
+   private:
+    std::ifstream _in;
+    std::vector<std::byte> _block;
+    std::size_t _next;
+
+   public:
+    RunReader(const std::string &path) : _in(path, std::ios::binary), _block(), _next(0) {}
+
+    std::optional<IndexEntry> next() {
+        std::optional<IndexEntry> ret = std::nullopt;
+
+        if (_next == _block.size()) {
+            _block.resize(mergeBlockEntries * entrySize);
+            _in.read(reinterpret_cast<char *>(_block.data()),
+                     static_cast<std::streamsize>(_block.size()));
+            _block.resize(static_cast<std::size_t>(_in.gcount()) / entrySize * entrySize);
+            _next = 0;
+        }
+
+        if (_next < _block.size()) {
+            ret = readEntry(std::span(_block).subspan(_next, entrySize));
+            _next += entrySize;
+        }
+
+        return ret;
+    }
+};
+
+/**
+ * k-way merge of the sorted runs into the index file
+ */
+static bool mergeRuns(const std::vector<std::string> &runs, std::uint64_t count,
+                      const std::string &path) {
+    using Head = std::tuple<IndexEntry, std::size_t>;
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    std::vector<RunReader> readers{};
+    std::priority_queue<Head, std::vector<Head>, std::greater<Head>> heads{};
+    std::string bytes(indexMagic);
+    bool ret = static_cast<bool>(out);
+
+    appendLittleEndian(bytes, count, 8);
+    for (const std::string &run : runs) {
+        readers.emplace_back(run);
+    }
+    for (std::size_t i = 0; i < readers.size(); i++) {
+        std::optional<IndexEntry> entry = readers[i].next();
+        if (entry.has_value()) {
+            heads.emplace(*entry, i);
+        }
+    }
+
+    while (!heads.empty() && ret) {
+        auto [entry, run] = heads.top();
+        heads.pop();
+        appendEntry(bytes, entry);
+
+        std::optional<IndexEntry> next = readers[run].next();
+        if (next.has_value()) {
+            heads.emplace(*next, run);
+        }
+
+        if (bytes.size() >= mergeBlockEntries * entrySize) {
+            ret = static_cast<bool>(
+                out.write(bytes.data(), static_cast<std::streamsize>(bytes.size())));
+            bytes.clear();
+        }
+    }
+
+    if (!bytes.empty() && ret) {
+        ret = static_cast<bool>(
+            out.write(bytes.data(), static_cast<std::streamsize>(bytes.size())));
+    }
+
+    return ret && out.flush();
+}
+
+bool buildPositionIndex(const GameArchive &archive, const std::string &path,
+                        const PositionIndexConfig &config) {
+    std::mutex mutex{};
+    std::vector<std::string> runs{};
+    std::uint64_t count = 0;
+    std::atomic<std::size_t> nextChunk = 0;
+    std::atomic<bool> failed = false;
+    int threads = threadCount(config.threads);
+
+    auto worker = [&] {
+        HeadlessGame headless;
+        Game &game = headless.game;
+        std::vector<IndexEntry> entries{};
+
+        auto flush = [&] {
+            std::string run{};
+            {
+                std::lock_guard lock(mutex);
+                run = path + ".run" + std::to_string(runs.size());
+                runs.push_back(run);
+                count += entries.size();
+            }
+
+            if (!writeRun(entries, run)) {
+                failed = true;
+            }
+            entries.clear();
+        };
+
+        for (std::size_t chunk = nextChunk++; chunk * gamesPerChunk < archive.size() && !failed;
+             chunk = nextChunk++) {
+            std::size_t end = std::min(archive.size(), (chunk + 1) * gamesPerChunk);
+
+            for (std::size_t i = chunk * gamesPerChunk; i < end; i++) {
+                std::optional<ArchivedGame> archived = archive.game(i);
+                std::size_t plies = archived.has_value() ? archived->plies() : 0;
+                bool legal = archived.has_value() &&
+                             game.loadFEN(archived->fen.empty() ? std::string(startingFEN)
+                                                                : std::string(archived->fen));
+
+                if (config.maxPlies > 0) {
+                    plies = std::min(plies, static_cast<std::size_t>(config.maxPlies));
+                }
+
+                for (std::size_t ply = 0; legal; ply++) {
+                    entries.push_back({game.positionHash(), static_cast<std::uint32_t>(i),
+                                       static_cast<std::uint32_t>(ply)});
+
+                    std::optional<Move> move =
+                        ply < plies ? game.moveFromUCI(archived->moveUCI(ply)) : std::nullopt;
+                    legal = move.has_value() && game.makeMove(*move) == RunResult::turnedPassed;
+                }
+
+                if (entries.size() >= config.runEntries) {
+                    flush();
+                }
+            }
+        }
+
+        if (!entries.empty()) {
+            flush();
+        }
+    };
+
+    {
+        std::vector<std::jthread> pool{};
+        for (int i = 0; i < threads; i++) {
+            pool.emplace_back(worker);
+        }
+    }
+
+    bool ret = !failed && mergeRuns(runs, count, path);
+
+    for (const std::string &run : runs) {
+        std::error_code error{};
+        std::filesystem::remove(run, error);
+    }
+
+    return ret;
+}
+
+PositionIndex::PositionIndex(MappedFile file, std::span<const std::byte> entries)
+    : _file(std::move(file)), _entries(entries) {}
+
+std::optional<PositionIndex> PositionIndex::open(const std::string &path) {
+    std::optional<PositionIndex> ret = std::nullopt;
+    std::optional<MappedFile> file = MappedFile::open(path);
+
+    if (file.has_value()) {
+        std::span<const std::byte> bytes = file->bytes();
+
+        if (bytes.size() >= headerSize &&
+            std::memcmp(bytes.data(), indexMagic.data(), indexMagic.size()) == 0) {
+            std::uint64_t count = readLittleEndian(bytes.subspan(8, 8));
+
+            if (count == (bytes.size() - headerSize) / entrySize) {
+                std::span<const std::byte> entries = bytes.subspan(headerSize, count * entrySize);
+                ret = PositionIndex(std::move(*file), entries);
+            }
+        }
+    }
+
+    return ret;
+}
+
+std::size_t PositionIndex::size() const {
+    return _entries.size() / entrySize;
+}
+
+std::uint64_t PositionIndex::hashAt(std::size_t entry) const {
+    return readLittleEndian(_entries.subspan(entry * entrySize, 8));
+}
+
+std::vector<PositionHit> PositionIndex::find(std::uint64_t hash) const {
+    std::vector<PositionHit> ret{};
+    std::size_t low = 0;
+    std::size_t high = size();
+
+    while (low < high) {
+        std::size_t middle = low + (high - low) / 2;
+
+        if (hashAt(middle) < hash) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    for (std::size_t i = low; i < size() && hashAt(i) == hash; i++) {
+        IndexEntry entry = readEntry(_entries.subspan(i * entrySize, entrySize));
+        ret.push_back({entry.game, entry.ply});
+    }
+
+    return ret;
+}
+
+}  // namespace chess
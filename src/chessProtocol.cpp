@@ -0,0 +1,116 @@
+#include "chessProtocol.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+
+#include "chessBase.hpp"
+#include "chessMappedFile.hpp"
+
+namespace chess::protocol {
+
+/**
+ * the frame at the start of `bytes` without its size, empty if it isn't complete yet,
+ * `std::nullopt` if its size is out of range
+ */
+static std::optional<std::span<const std::byte>> frame(std::span<const std::byte> bytes) {
+    std::optional<std::span<const std::byte>> ret = std::span<const std::byte>{};
+
+    if (bytes.size() >= 4) {
+        std::uint64_t size = readLittleEndian(bytes.subspan(0, 4));
+
+        if (size < 1 || size > maxFrameSize) {
+            ret = std::nullopt;
+        } else if (bytes.size() >= 4 + size) {
+            ret = bytes.subspan(4, size);
+        }
+    }
+
+    return ret;
+}
+
+void appendRequest(std::string &out, const Request &request) {
+    std::size_t size = request.type == RequestType::newGame ? 1 + 4 + 2 + request.fen.size()
+                       : request.type == RequestType::move  ? 1 + 4 + 8 + 2
+                                                            : 1 + 4 + 8;
+
+    appendLittleEndian(out, size, 4);
+    appendLittleEndian(out, static_cast<std::uint8_t>(request.type), 1);
+    appendLittleEndian(out, request.tag, 4);
+    if (request.type == RequestType::newGame) {
+        appendLittleEndian(out, request.fen.size(), 2);
+        out += request.fen;
+    } else {
+        appendLittleEndian(out, request.game, 8);
+    }
+    if (request.type == RequestType::move) {
+        appendLittleEndian(out, request.move, 2);
+    }
+}
+
+void appendReply(std::string &out, const Reply &reply) {
+    appendLittleEndian(out, 1 + 4 + 8 + 1 + 1, 4);
+    appendLittleEndian(out, replyType, 1);
+    appendLittleEndian(out, reply.tag, 4);
+    appendLittleEndian(out, reply.game, 8);
+    appendLittleEndian(out, static_cast<std::uint8_t>(reply.status), 1);
+    appendLittleEndian(out, static_cast<std::uint8_t>(reply.result), 1);
+}
+
+std::optional<std::size_t> readRequest(std::span<const std::byte> bytes, Request &request) {
+    std::optional<std::span<const std::byte>> body = frame(bytes);
+    std::optional<std::size_t> ret = std::nullopt;
+
+    if (body.has_value() && body->empty()) {
+        ret = 0;
+    } else if (body.has_value() && body->size() >= 5) {
+        // every request starts with its type and tag
+        auto type = static_cast<RequestType>(readLittleEndian(body->subspan(0, 1)));
+        std::size_t size = body->size();
+
+        request.type = type;
+        request.tag = static_cast<std::uint32_t>(readLittleEndian(body->subspan(1, 4)));
+        request.game = 0;
+        request.move = 0;
+        request.fen.clear();
+
+        if (type == RequestType::newGame && size >= 7 &&
+            size == 7 + readLittleEndian(body->subspan(5, 2))) {
+            const char *fen = reinterpret_cast<const char *>(body->data()) + 7;
+            request.fen.assign(fen, size - 7);
+            ret = 4 + size;
+        } else if ((type == RequestType::move && size == 15) ||
+                   (type == RequestType::close && size == 13)) {
+            request.game = readLittleEndian(body->subspan(5, 8));
+            request.move =
+                type == RequestType::move
+                    ? static_cast<std::uint16_t>(readLittleEndian(body->subspan(13, 2)))
+                    : 0;
+            ret = 4 + size;
+        }
+    }
+
+    return ret;
+}
+
+std::optional<std::size_t> readReply(std::span<const std::byte> bytes, Reply &reply) {
+    std::optional<std::span<const std::byte>> body = frame(bytes);
+    std::optional<std::size_t> ret = std::nullopt;
+
+    if (body.has_value() && body->empty()) {
+        ret = 0;
+    } else if (body.has_value() && body->size() == 15 &&
+               readLittleEndian(body->subspan(0, 1)) == replyType) {
+        reply.tag = static_cast<std::uint32_t>(readLittleEndian(body->subspan(1, 4)));
+        reply.game = readLittleEndian(body->subspan(5, 8));
+        reply.status = static_cast<Status>(readLittleEndian(body->subspan(13, 1)));
+        reply.result = static_cast<WinSearchResult>(readLittleEndian(body->subspan(14, 1)));
+        ret = 4 + body->size();
+    }
+
+    return ret;
+}
+
+}  // namespace chess::protocol
@@ -0,0 +1,255 @@
+#include "chessScheduler.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <coroutine>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <utility>
+
+#include "chessBase.hpp"
+#include "chessBoard.hpp"
+#include "chessGame.hpp"
+#include "chessPosition.hpp"
+
+namespace chess {
+
+void RemotePlayer::submit(std::string uci) {
+    std::lock_guard lock(_mutex);
+    _moves.push_back(std::move(uci));
+}
+
+std::optional<Move> RemotePlayer::chooseMove(Game &game) {
+    std::optional<Move> ret = std::nullopt;
+    std::lock_guard lock(_mutex);
+
+    if (!_moves.empty()) {
+        // a move that doesn't name two squares is still returned, so it gets refused
+        ret = game.moveFromUCI(_moves.front()).value_or(Move{nullptr, nullptr, "", ""});
+        _moves.pop_front();
+    }
+
+    return ret;
+}
+
+/**
+ * started suspended so `spawn()` can queue it, and left suspended at its end so the worker that
+ * ran it sees it's done before destroying it
+ */
+struct GameScheduler::Task {
+    struct promise_type {
+        Task get_return_object() {
+            return {std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+
+    std::coroutine_handle<promise_type> handle;
+};
+
+enum class SlotState { queued, running, waiting };
+
+/**
+ * what a game wants when it gives its thread up, another turn or a wake
+ */
+enum class Suspension { yield, wait };
+
+struct GameScheduler::Slot {
+    GameId id;
+    Board board;
+    std::unique_ptr<Player> white;
+    std::unique_ptr<Player> black;
+    Game game;
+    std::coroutine_handle<> handle;
+    /**
+     * `state` and `woken` are only touched under the scheduler's lock, `suspension` by the
+     * thread running the game
+     */
+    SlotState state;
+    Suspension suspension;
+    bool woken;
+    std::atomic<bool> aborted;
+
+    Slot(std::unique_ptr<Player> white_, std::unique_ptr<Player> black_)
+        : id(0),
+          board(64, true),
+          white(std::move(white_)),
+          black(std::move(black_)),
+          game(board, *white, *black),
+          handle(nullptr),
+          state(SlotState::queued),
+          suspension(Suspension::yield),
+          woken(false),
+          aborted(false) {}
+
+    ~Slot() {
+        if (handle) {
+            handle.destroy();
+        }
+    }
+};
+
+GameScheduler::GameScheduler(GameUpdateCallback onUpdate, int threads)
+    : _onUpdate(std::move(onUpdate)), _nextId(1), _quit(false) {
+    int count = threadCount(threads);
+
+    for (int i = 0; i < count; i++) {
+        _threads.emplace_back([this] { work(); });
+    }
+}
+
+GameScheduler::~GameScheduler() {
+    {
+        std::lock_guard lock(_mutex);
+        _quit = true;
+    }
+    _ready.notify_all();
+    _threads.clear();
+}
+
+GameScheduler::Task GameScheduler::play(Slot &slot, const GameUpdateCallback &onUpdate) {
+    Game &game = slot.game;
+    GameUpdate update = {slot.id, "", false, game.lookForWin(), false};
+
+    while (update.result == WinSearchResult::nothing && !slot.aborted) {
+        Piece *pawn = game.lookForPromotion();
+        std::optional<Move> move =
+            pawn == nullptr ? game.currentPlayer->chooseMove(game) : std::nullopt;
+
+        slot.suspension = Suspension::wait;
+        if (pawn != nullptr && game.defaultPromotionHandler(pawn) == RunResult::still) {
+            // the piece of a promotion the player hadn't picked when it moved
+            update.result = game.lookForWin();
+            slot.suspension = Suspension::yield;
+        } else if (move.has_value()) {
+            update = {slot.id, moveToUCI(*move), game.makeMove(*move) != RunResult::still,
+                      WinSearchResult::nothing, false};
+            update.result = update.accepted ? game.lookForWin() : WinSearchResult::nothing;
+            slot.suspension = Suspension::yield;
+
+            if (update.result == WinSearchResult::nothing) {
+                onUpdate(update);
+            }
+        }
+
+        if (update.result == WinSearchResult::nothing) {
+            co_await std::suspend_always{};
+        }
+    }
+
+    if (update.result == WinSearchResult::nothing) {
+        update = {slot.id, "", false, WinSearchResult::nothing, false};
+    }
+    update.finished = true;
+    onUpdate(update);
+}
+
+void GameScheduler::schedule(Slot &slot) {
+    if (slot.state == SlotState::waiting) {
+        slot.state = SlotState::queued;
+        _queue.push_back(&slot);
+        _ready.notify_one();
+    } else if (slot.state == SlotState::running) {
+        slot.woken = true;
+    }
+}
+
+void GameScheduler::work() {
+    std::unique_lock lock(_mutex);
+
+    while (true) {
+        _ready.wait(lock, [&] { return _quit || !_queue.empty(); });
+        if (_quit) {
+            break;
+        }
+
+        Slot *slot = _queue.front();
+        _queue.pop_front();
+        slot->state = SlotState::running;
+
+        // only the thread that took a game off the queue touches it until it's queued again
+        lock.unlock();
+        slot->handle.resume();
+        lock.lock();
+
+        if (slot->handle.done()) {
+            std::unique_ptr<Slot> finished = std::move(_games.at(slot->id));
+
+            _games.erase(slot->id);
+            if (_games.empty()) {
+                _idle.notify_all();
+            }
+            lock.unlock();
+            finished.reset();
+            lock.lock();
+        } else if (slot->suspension == Suspension::yield || slot->woken) {
+            slot->woken = false;
+            slot->state = SlotState::queued;
+            _queue.push_back(slot);
+        } else {
+            slot->state = SlotState::waiting;
+        }
+    }
+}
+
+std::optional<GameId> GameScheduler::spawn(std::unique_ptr<Player> white,
+                                           std::unique_ptr<Player> black,
+                                           const std::optional<Position> &position) {
+    std::optional<GameId> ret = std::nullopt;
+    auto slot = std::make_unique<Slot>(std::move(white), std::move(black));
+
+    // the board starts with the standard pieces
+    if (!position.has_value() || slot->game.loadPosition(*position)) {
+        std::lock_guard lock(_mutex);
+
+        slot->id = _nextId++;
+        slot->handle = play(*slot, _onUpdate).handle;
+        _queue.push_back(slot.get());
+        ret = slot->id;
+        _games.emplace(slot->id, std::move(slot));
+        _ready.notify_one();
+    }
+
+    return ret;
+}
+
+bool GameScheduler::wake(GameId id) {
+    std::lock_guard lock(_mutex);
+    auto it = _games.find(id);
+
+    if (it != _games.end()) {
+        schedule(*it->second);
+    }
+
+    return it != _games.end();
+}
+
+bool GameScheduler::abort(GameId id) {
+    std::lock_guard lock(_mutex);
+    auto it = _games.find(id);
+
+    if (it != _games.end()) {
+        it->second->aborted = true;
+        schedule(*it->second);
+    }
+
+    return it != _games.end();
+}
+
+std::size_t GameScheduler::games() {
+    std::lock_guard lock(_mutex);
+    return _games.size();
+}
+
+void GameScheduler::wait() {
+    std::unique_lock lock(_mutex);
+    _idle.wait(lock, [&] { return _games.empty(); });
+}
+
+}  // namespace chess
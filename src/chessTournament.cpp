@@ -0,0 +1,279 @@
+#include "chessTournament.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <span>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "chessBase.hpp"
+#include "chessBoard.hpp"
+#include "chessGame.hpp"
+#include "chessMaterial.hpp"
+#include "chessPiece.hpp"
+
+namespace chess {
+
+/**
+ * 2 for a win, 1 for a draw and 0 for a loss of the first competitor, not counted at all unless
+ * the game was `played`
+ */
+struct GameReport {
+    int points;
+    bool forfeit;
+    bool played;
+};
+
+/**
+ * how often `playGame()` plays the random plies again before it gives up on the game
+ */
+static constexpr int openingAttempts = 16;
+
+FunctionPlayer::FunctionPlayer(PieceColor color, MoveFunction moveFn)
+    : Player(color), moveFn(std::move(moveFn)) {}
+
+std::optional<Move> FunctionPlayer::chooseMove(Game &game) { return moveFn(game); }
+
+int TournamentStats::games() const { return wins + draws + losses; }
+
+double TournamentStats::score() const {
+    return games() == 0 ? 0.5 : (wins + draws / 2.0) / games();
+}
+
+double TournamentStats::gamesPerSecond() const { return seconds > 0.0 ? games() / seconds : 0.0; }
+
+static double scoreToElo(double score) {
+    score = std::clamp(score, 1e-6, 1.0 - 1e-6);
+    return -400.0 * std::log10(1.0 / score - 1.0);
+}
+
+static double eloToScore(double elo) { return 1.0 / (1.0 + std::pow(10.0, -elo / 400.0)); }
+
+/**
+ * per game variance of the first competitor's score
+ */
+static double scoreVariance(int wins, int draws, int losses) {
+    int games = wins + draws + losses;
+    double score = (wins + draws / 2.0) / games;
+
+    return (wins * std::pow(1.0 - score, 2) + draws * std::pow(0.5 - score, 2) +
+            losses * std::pow(score, 2)) /
+           games;
+}
+
+EloEstimate estimateElo(int wins, int draws, int losses) {
+    EloEstimate ret = {0.0, 0.0};
+    int games = wins + draws + losses;
+
+    if (games > 0) {
+        double score = (wins + draws / 2.0) / games;
+        double stdError = std::sqrt(scoreVariance(wins, draws, losses) / games);
+        double lower = scoreToElo(score - 1.959964 * stdError);
+        double upper = scoreToElo(score + 1.959964 * stdError);
+
+        ret = {scoreToElo(score), (upper - lower) / 2.0};
+    }
+
+    return ret;
+}
+
+double sprtLLR(int wins, int draws, int losses, double elo0, double elo1) {
+    double ret = 0.0;
+    int games = wins + draws + losses;
+
+    if (games > 0 && scoreVariance(wins, draws, losses) > 0.0) {
+        double score = (wins + draws / 2.0) / games;
+        double s0 = eloToScore(elo0);
+        double s1 = eloToScore(elo1);
+
+        ret = (s1 - s0) * (2.0 * score - s0 - s1) /
+              (2.0 * scoreVariance(wins, draws, losses) / games);
+    }
+
+    return ret;
+}
+
+SprtResult sprtResult(double llr, double alpha, double beta) {
+    SprtResult ret = SprtResult::inconclusive;
+
+    if (llr >= std::log((1.0 - beta) / alpha)) {
+        ret = SprtResult::acceptH1;
+    } else if (llr <= std::log(beta / (1.0 - alpha))) {
+        ret = SprtResult::acceptH0;
+    }
+
+    return ret;
+}
+
+std::vector<std::string> readOpenings(std::istream &in) {
+    std::vector<std::string> ret{};
+    std::string line{};
+
+    while (std::getline(in, line)) {
+        std::istringstream stream(line);
+        std::vector<std::string> fields{};
+        std::string field{};
+
+        while (fields.size() < 6 && stream >> field) {
+            fields.push_back(field);
+        }
+
+        if (fields.size() < 4 || fields[0][0] == '#') {
+            continue;
+        }
+
+        auto isNumber = [](const std::string &s) -> bool {
+            return std::all_of(s.begin(), s.end(), [](char c) { return c >= '0' && c <= '9'; });
+        };
+
+        std::string fen = fields[0] + " " + fields[1] + " " + fields[2] + " " + fields[3];
+        if (fields.size() == 6 && isNumber(fields[4]) && isNumber(fields[5])) {
+            fen += " " + fields[4] + " " + fields[5];
+        }
+        ret.push_back(fen);
+    }
+
+    return ret;
+}
+
+static GameReport playGame(const TournamentConfig &config, const std::string &opening,
+                           bool firstIsWhite, std::uint64_t gameSeed, std::uint64_t openingSeed,
+                           const PlayerFactory &first, const PlayerFactory &second) {
+    using enum PieceColor;
+
+    GameReport ret = {1, false, false};
+    Board board(64, false);
+    std::unique_ptr<Player> whitePlayer = (firstIsWhite ? first : second)(white, gameSeed);
+    std::unique_ptr<Player> blackPlayer = (firstIsWhite ? second : first)(black, gameSeed);
+    Game game(board, *whitePlayer, *blackPlayer);
+    std::mt19937_64 random(openingSeed);
+    std::optional<PieceColor> winner = std::nullopt;
+    int materialStreak = 0;
+
+    // both games of a pair share `openingSeed`, so they get the same random plies after retries
+    for (int attempt = 0; attempt < openingAttempts && !ret.played; attempt++) {
+        ret.played = game.loadFEN(opening);
+        for (int i = 0; i < config.randomPlies && ret.played; i++) {
+            std::span<const Move> moves = game.legalMoves();
+            ret.played = !moves.empty() && game.makeMove(moves[random() % moves.size()]) ==
+                                               RunResult::turnedPassed;
+        }
+        ret.played = ret.played && game.lookForWin() == WinSearchResult::nothing;
+    }
+    bool finished = !ret.played;
+
+    game.start();
+    for (int plies = 0; !finished; plies++) {
+        PieceColor mover = game.currentPlayer->color;
+        RunResult result = game.run();
+        WinSearchResult win = WinSearchResult::nothing;
+
+        if (result != RunResult::turnedPassed) {
+            winner = mover == white ? black : white;
+            ret.forfeit = true;
+            finished = true;
+        } else {
+            win = game.lookForWin();
+        }
+
+        if (win == WinSearchResult::whiteWinCheckmate) {
+            winner = white;
+        } else if (win == WinSearchResult::blackWinCheckmate) {
+            winner = black;
+        }
+
+        int advantage = material::value(game.materialKey(), white) -
+                        material::value(game.materialKey(), black);
+        materialStreak = config.materialMargin > 0 && std::abs(advantage) >= config.materialMargin
+                             ? materialStreak + 1
+                             : 0;
+
+        if (!finished && win == WinSearchResult::nothing && config.materialMargin > 0 &&
+            materialStreak >= config.materialPlies) {
+            winner = advantage > 0 ? white : black;
+        }
+
+        finished = finished || win != WinSearchResult::nothing || winner.has_value() ||
+                   plies + 1 >= config.maxPlies;
+    }
+
+    if (winner.has_value()) {
+        ret.points = (*winner == white) == firstIsWhite ? 2 : 0;
+    }
+
+    return ret;
+}
+
+TournamentStats runTournament(
+    const TournamentConfig &config, PlayerFactory first, PlayerFactory second,
+    std::optional<std::function<void(const TournamentStats &stats)>> onGameFinished) {
+    TournamentStats ret = {0, 0, 0, 0, 0, 0.0};
+    std::vector<std::string> openings = config.openings;
+    std::mutex mutex{};
+    std::atomic<int> nextGame = 0;
+    std::atomic<bool> stop = false;
+    auto startTime = std::chrono::steady_clock::now();
+    int threads = threadCount(config.threads);
+
+    std::erase_if(openings, [](const std::string &fen) -> bool {
+        HeadlessGame headless;
+        Game &game = headless.game;
+        return !game.loadFEN(fen);
+    });
+
+    if (openings.empty()) {
+        openings.push_back(startingFEN);
+    }
+    std::shuffle(openings.begin(), openings.end(), std::mt19937_64(config.seed));
+
+    auto worker = [&] {
+        for (int i = nextGame++; i < config.games && !stop; i = nextGame++) {
+            int pair = i / 2;
+            GameReport report =
+                playGame(config, openings[pair % openings.size()], i % 2 == 0, config.seed + i,
+                         config.seed + pair, first, second);
+
+            std::lock_guard lock(mutex);
+            ret.wins += report.played && report.points == 2 ? 1 : 0;
+            ret.draws += report.played && report.points == 1 ? 1 : 0;
+            ret.losses += report.played && report.points == 0 ? 1 : 0;
+            ret.forfeits += report.forfeit ? 1 : 0;
+            ret.skipped += report.played ? 0 : 1;
+            ret.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                                        startTime)
+                              .count();
+
+            if (onGameFinished.has_value()) {
+                (*onGameFinished)(ret);
+            }
+
+            if (config.stopOnSprt &&
+                sprtResult(sprtLLR(ret.wins, ret.draws, ret.losses, config.elo0, config.elo1),
+                           config.alpha, config.beta) != SprtResult::inconclusive) {
+                stop = true;
+            }
+        }
+    };
+
+    {
+        std::vector<std::jthread> pool{};
+        for (int i = 0; i < threads; i++) {
+            pool.emplace_back(worker);
+        }
+    }
+
+    return ret;
+}
+
+}  // namespace chess
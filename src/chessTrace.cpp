@@ -0,0 +1,175 @@
+#include "chessTrace.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace chess::trace {
+
+/**
+ * each thread keeps at most this many trace events, the counters keep counting after that
+ */
+static constexpr std::size_t maxEventsPerThread = 1 << 20;
+
+struct Event {
+    Op op;
+    std::int64_t startNs;
+    std::int64_t durationNs;
+};
+
+struct ThreadData {
+    int id;
+    std::array<OpStats, opCount> stats;
+    std::vector<Event> events;
+};
+
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadData>> threads;
+};
+
+/**
+ * never destroyed, so the trace can still be written from static destructors and `atexit()`
+ */
+static Registry &registry() {
+    static Registry *ret = new Registry();
+    return *ret;
+}
+
+static const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+
+static ThreadData &localData() {
+    thread_local ThreadData *data = [] {
+        Registry &reg = registry();
+        std::lock_guard lock(reg.mutex);
+        reg.threads.push_back(std::make_unique<ThreadData>());
+        reg.threads.back()->id = static_cast<int>(reg.threads.size());
+        return reg.threads.back().get();
+    }();
+
+    return *data;
+}
+
+const char *opName(Op op) {
+    static constexpr std::array<const char *, opCount> names = {
+        "canMove",    "isMoveLegal", "isKingInCheck", "getLegalMoves",
+        "lookForWin", "makeMove",    "draw",          "renderPieces"};
+
+    return op < Op::count ? names[static_cast<int>(op)] : "unknown";
+}
+
+std::int64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() -
+                                                                epoch)
+        .count();
+}
+
+void record(Op op, std::int64_t startNs, std::int64_t endNs) {
+    ThreadData &data = localData();
+    OpStats &stats = data.stats[static_cast<int>(op)];
+    std::uint64_t duration = static_cast<std::uint64_t>(std::max<std::int64_t>(endNs - startNs, 0));
+
+    stats.calls++;
+    stats.totalNs += duration;
+    stats.histogram[std::min<int>(std::bit_width(duration), histogramBuckets - 1)]++;
+
+    if (data.events.size() < maxEventsPerThread) {
+        data.events.push_back({op, startNs, static_cast<std::int64_t>(duration)});
+    }
+}
+
+std::array<OpStats, opCount> collectStats() {
+    std::array<OpStats, opCount> ret{};
+    Registry &reg = registry();
+    std::lock_guard lock(reg.mutex);
+
+    for (auto &data : reg.threads) {
+        for (int i = 0; i < opCount; i++) {
+            ret[i].calls += data->stats[i].calls;
+            ret[i].totalNs += data->stats[i].totalNs;
+            for (int j = 0; j < histogramBuckets; j++) {
+                ret[i].histogram[j] += data->stats[i].histogram[j];
+            }
+        }
+    }
+
+    return ret;
+}
+
+void writeStats(std::ostream &out) {
+    std::array<OpStats, opCount> stats = collectStats();
+
+    for (int i = 0; i < opCount; i++) {
+        if (stats[i].calls == 0) {
+            continue;
+        }
+
+        out << opName(static_cast<Op>(i)) << ": " << stats[i].calls << " calls, "
+            << stats[i].totalNs / stats[i].calls << " ns avg, histogram (ns):";
+        for (int j = 0; j < histogramBuckets; j++) {
+            if (stats[i].histogram[j] != 0) {
+                out << " <" << (std::uint64_t{1} << j) << ":" << stats[i].histogram[j];
+            }
+        }
+        out << '\n';
+    }
+}
+
+/**
+ * trace event timestamps are in microseconds
+ */
+static std::string toMicroseconds(std::int64_t ns) {
+    std::string fraction = std::to_string(ns % 1000);
+    return std::to_string(ns / 1000) + '.' + std::string(3 - fraction.size(), '0') + fraction;
+}
+
+void writeChromeTrace(std::ostream &out) {
+    Registry &reg = registry();
+    std::lock_guard lock(reg.mutex);
+    bool first = true;
+
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    for (auto &data : reg.threads) {
+        out << (first ? "" : ",") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+            << data->id << ",\"args\":{\"name\":\"thread " << data->id << "\"}}";
+        first = false;
+
+        for (Event &event : data->events) {
+            out << ",{\"name\":\"" << opName(event.op)
+                << "\",\"cat\":\"chess\",\"ph\":\"X\",\"ts\":" << toMicroseconds(event.startNs)
+                << ",\"dur\":" << toMicroseconds(event.durationNs)
+                << ",\"pid\":1,\"tid\":" << data->id << "}";
+        }
+    }
+    out << "]}\n";
+}
+
+bool writeChromeTrace(const std::string &path) {
+    std::ofstream file(path);
+
+    if (file.is_open()) {
+        writeChromeTrace(file);
+    }
+
+    return file.is_open() && file.good();
+}
+
+void clear() {
+    Registry &reg = registry();
+    std::lock_guard lock(reg.mutex);
+
+    for (auto &data : reg.threads) {
+        data->stats = {};
+        data->events.clear();
+    }
+}
+
+}  // namespace chess::trace
@@ -0,0 +1,267 @@
+#include "chessSDL.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "SDL_events.h"
+#include "SDL_image.h"
+#include "SDL_keycode.h"
+#include "SDL_mouse.h"
+#include "SDL_pixels.h"
+#include "SDL_rect.h"
+#include "SDL_render.h"
+#include "chessBase.hpp"
+#include "chessBoard.hpp"
+#include "chessGame.hpp"
+#include "chessPiece.hpp"
+#include "chessTrace.hpp"
+
+namespace chess {
+
+static constexpr int rectIdx = 0;
+static constexpr int targetsIdx = 1;
+
+static SDL_Rect toSDLRect(Rect rect) { return {rect.x, rect.y, rect.w, rect.h}; }
+
+void SDLTextureDeleter::operator()(SDL_Texture *t) {
+    if (t != nullptr) {
+        SDL_DestroyTexture(t);
+    }
+}
+
+void createSpriteSheet(std::string path, int width, int height, int horizontalFrames,
+                       int verticalFrames, SDL_Renderer *ren) {
+    sheet.width = width;
+    sheet.height = height;
+    sheet.horizontalFrames = horizontalFrames;
+    sheet.verticalFrames = verticalFrames;
+    sheet.texture.reset(IMG_LoadTexture(ren, path.c_str()));
+}
+
+void setPieceSprite(char type, PieceColor color, int hFrame, int vFrame) {
+    spriteMap[{type, color}] = {
+        sheet.texture.get(),
+        {hFrame * (sheet.width / sheet.horizontalFrames),
+         vFrame * (sheet.height / sheet.verticalFrames), sheet.width / sheet.horizontalFrames,
+         sheet.height / sheet.verticalFrames}};
+}
+
+void renderDrawQueue(SDL_Renderer *ren, Color color) {
+    for (auto &[idx, fn] : drawQueue) {
+        SDL_SetRenderDrawColor(ren, color.r, color.g, color.b, color.a);
+        fn(ren);
+    }
+}
+
+OptionalRef<BoardSquare> getSquareUnderCursor(Board &board) {
+    OptionalRef<BoardSquare> ret = std::nullopt;
+
+    SDL_Point mousePos{};
+    SDL_GetMouseState(&mousePos.x, &mousePos.y);
+
+    auto it = std::find_if(board.squaresMap.begin(), board.squaresMap.end(), [=](auto &a) -> bool {
+        SDL_Rect rect = toSDLRect(a.second.rect);
+        return SDL_PointInRect(&mousePos, &rect);
+    });
+
+    if (it != board.squaresMap.end()) {
+        ret = it->second;
+    } else {
+        ret = std::nullopt;
+    }
+
+    return ret;
+}
+
+BoardRenderer::BoardRenderer(Board &board, SDL_Renderer *ren)
+    : _ren(ren),
+      _pieceDst(std::max(board.numSquares, 0)),
+      _pieceMoved(std::max(board.numSquares, 0)),
+      board(board) {}
+
+int BoardRenderer::squareIndex(const std::string &square) const {
+    auto [file, rank] = chessPosToPair(square);
+    int side = board.sideLength();
+    int ret = file >= 1 && file <= side && rank >= 1 && rank <= side && square.length() == 2
+                  ? (file - 1) + side * (rank - 1)
+                  : -1;
+
+    return ret < static_cast<int>(_pieceMoved.size()) ? ret : -1;
+}
+
+void BoardRenderer::movePiece(const std::string &square, Rect dst) {
+    int index = squareIndex(square);
+
+    if (index >= 0) {
+        _pieceDst[index] = dst;
+        _pieceMoved[index] = true;
+    }
+}
+
+void BoardRenderer::releasePieces() { std::fill(_pieceMoved.begin(), _pieceMoved.end(), false); }
+
+void BoardRenderer::draw() {
+    CHESS_TRACE_SCOPE(draw);
+    for (auto &[pos, square] : board.squaresMap) {
+        SDL_Rect rect = toSDLRect(square.rect);
+        SDL_SetRenderDrawColor(_ren, square.color.r, square.color.g, square.color.b,
+                               square.color.a);
+        SDL_RenderFillRect(_ren, &rect);
+        SDL_SetRenderDrawColor(_ren, board.colors.outline.r, board.colors.outline.g,
+                               board.colors.outline.b, board.colors.outline.a);
+        SDL_RenderDrawRect(_ren, &rect);
+    }
+}
+
+void BoardRenderer::drawSquareOutline(BoardSquare square, Color color) {
+    SDL_Rect rect = toSDLRect(square.rect);
+    SDL_SetRenderDrawColor(_ren, color.r, color.g, color.b, color.a);
+    SDL_RenderDrawRect(_ren, &rect);
+}
+
+void BoardRenderer::renderPieces() {
+    CHESS_TRACE_SCOPE(renderPieces);
+    for (auto &[pos, piece] : board.pieceMap) {
+        if (piece != nullptr && spriteMap.contains({piece->notation, piece->color})) {
+            PieceSprite sprite = spriteMap.at({piece->notation, piece->color});
+            int index = squareIndex(pos);
+            SDL_Rect dst = toSDLRect(index >= 0 && _pieceMoved[index]
+                                         ? _pieceDst[index]
+                                         : board.squaresMap.at(pos).rect);
+            SDL_RenderCopy(_ren, sprite.texture, &sprite.source, &dst);
+        }
+    }
+}
+
+void BoardRenderer::highlightSquareUnderCursor(int increment) {
+    OptionalRef<BoardSquare> s = getSquareUnderCursor(board);
+    board.updateSquaresColor();
+    if (s.has_value()) {
+        s->get().color.r += s->get().color.r + increment > 255 ? 255 - s->get().color.r : increment;
+        s->get().color.g += s->get().color.g + increment > 255 ? 255 - s->get().color.g : increment;
+        s->get().color.b += s->get().color.b + increment > 255 ? 255 - s->get().color.b : increment;
+    }
+}
+
+SDLPlayer::SDLPlayer(PieceColor color, SDL_Event &event)
+    : Player(color), _event(event), _renderer(nullptr), _dragging(false) {}
+
+SDLPlayer::SDLPlayer(PieceColor color, SDL_Event &event, BoardRenderer &renderer)
+    : Player(color), _event(event), _renderer(&renderer), _dragging(false) {}
+
+std::optional<Move> SDLPlayer::chooseMove(Game &game) {
+    std::optional<Move> ret = handleEvents(game.board, _event);
+
+    // outlines where the selected piece can go, the moves only get generated once per position
+    if (selectedPiece != nullptr) {
+        std::vector<SDL_Rect> targets{};
+        for (const Move &move : game.legalMovesFrom(selectedPiece->position)) {
+            targets.push_back(toSDLRect(game.board.squaresMap.at(move.end).rect));
+        }
+        drawQueue[targetsIdx] = [=](SDL_Renderer *ren) -> void {
+            for (const SDL_Rect &rect : targets) {
+                SDL_RenderDrawRect(ren, &rect);
+            }
+        };
+    } else {
+        drawQueue.erase(targetsIdx);
+    }
+
+    return ret;
+}
+
+std::optional<char> SDLPlayer::choosePromotion(Game &game, Piece &pawn) {
+    std::optional<char> ret = std::nullopt;
+
+    if (_event.type == SDL_KEYUP) {
+        switch (_event.key.keysym.sym) {
+            case SDLK_q:
+                ret = 'q';
+                break;
+            case SDLK_r:
+                ret = 'r';
+                break;
+            case SDLK_n:
+                ret = 'n';
+                break;
+            case SDLK_b:
+                ret = 'b';
+                break;
+        }
+    }
+
+    return ret;
+}
+
+std::optional<Move> SDLPlayer::handleEvents(Board &board, SDL_Event event) {
+    std::optional<Move> ret = std::nullopt;
+    static std::optional<SDL_Rect> rect = std::nullopt;
+
+    if (event.type == SDL_MOUSEBUTTONDOWN && event.button.button == SDL_BUTTON_LEFT) {
+        std::optional<BoardSquare> startSquare = getSquareUnderCursor(board);
+
+        if (startSquare.has_value()) {
+            rect = toSDLRect(startSquare->rect);
+            if (selectedPiece == board.pieceMap.at(startSquare->position).get()) {
+                selectedPiece = nullptr;
+            } else if (board.pieceMap.at(startSquare->position).get() != nullptr) {
+                if (selectedPiece != nullptr) {
+                    ret = {selectedPiece, board.pieceMap.at(startSquare->position).get(),
+                           selectedPiece->position, startSquare->position};
+                } else {
+                    selectedPiece = board.pieceMap.at(startSquare->position).get();
+                    _dragging = true;
+                }
+            }
+        }
+    } else if (event.type == SDL_MOUSEBUTTONUP && event.button.button == SDL_BUTTON_LEFT) {
+        std::optional<BoardSquare> endSquare = getSquareUnderCursor(board);
+        rect = std::nullopt;
+
+        _dragging = false;
+
+        if (!endSquare.has_value()) {
+            selectedPiece = nullptr;
+        } else if (selectedPiece != nullptr &&
+                   selectedPiece != board.pieceMap.at(endSquare->position).get()) {
+            ret = {selectedPiece, board.pieceMap.at(endSquare->position).get(),
+                   selectedPiece->position, endSquare->position};
+            selectedPiece = nullptr;
+        }
+    }
+
+    if (_renderer != nullptr) {
+        _renderer->releasePieces();
+    }
+
+    if (selectedPiece != nullptr) {
+        int mouseX{};
+        int mouseY{};
+
+        SDL_GetMouseState(&mouseX, &mouseY);
+
+        int lengthOfSquare = board.length / board.sideLength();
+        if (_renderer != nullptr && _dragging) {
+            _renderer->movePiece(selectedPiece->position,
+                                 {mouseX - lengthOfSquare / 2, mouseY - lengthOfSquare / 2,
+                                  lengthOfSquare, lengthOfSquare});
+        }
+
+        if (rect.has_value()) {
+            drawQueue[rectIdx] = [=](SDL_Renderer *ren) -> void {
+                SDL_RenderDrawRect(ren, &*rect);
+            };
+        }
+    } else {
+        drawQueue.erase(rectIdx);
+    }
+
+    return ret;
+}
+
+}  // namespace chess
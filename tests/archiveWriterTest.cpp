@@ -0,0 +1,56 @@
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "chessArchive.hpp"
+#include "testSupport.hpp"
+
+using namespace chess;
+using namespace chess::test;
+
+int main() {
+    TempDirectory directory{};
+    std::string firstPath = directory.file("first.arc");
+    std::string secondPath = directory.file("second.arc");
+    std::vector<std::string> moves = {"e2e4", "e7e5"};
+
+    // assigning over a writer finishes the archive it was writing before taking the other one
+    {
+        std::optional<GameArchiveWriter> first = GameArchiveWriter::create(firstPath);
+        std::optional<GameArchiveWriter> second = GameArchiveWriter::create(secondPath);
+        check(first.has_value() && second.has_value(), "create both archives");
+        if (first.has_value() && second.has_value()) {
+            check(first->append("", moves), "append to the first archive");
+            check(second->append("", moves) && second->append("", moves),
+                  "append to the second archive");
+
+            *first = std::move(*second);
+            check(first->size() == 2, "the assigned writer has the second archive's games");
+            check(first->append("", moves), "append through the assigned writer");
+        }
+    }
+
+    std::optional<GameArchive> first = GameArchive::open(firstPath);
+    std::optional<GameArchive> second = GameArchive::open(secondPath);
+    check(first.has_value() && first->size() == 1, "the overwritten writer's archive is complete");
+    check(second.has_value() && second->size() == 3, "the moved writer's archive is complete");
+
+    // an index entry so large that adding the record header to it wraps around
+    std::string corruptPath = directory.file("corrupt.arc");
+    writeArchive(corruptPath, {moves});
+    {
+        std::fstream file(corruptPath, std::ios::binary | std::ios::in | std::ios::out);
+        std::string offset(8, '\xff');
+        offset[0] = '\xfc';
+        file.seekp(static_cast<std::streamoff>(std::filesystem::file_size(corruptPath)) - 24);
+        file.write(offset.data(), static_cast<std::streamsize>(offset.size()));
+    }
+    std::optional<GameArchive> corrupt = GameArchive::open(corruptPath);
+    check(corrupt.has_value() && corrupt->size() == 1 && !corrupt->game(0).has_value(),
+          "a record offset past the end of the file is refused");
+
+    return result();
+}
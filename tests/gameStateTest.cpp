@@ -0,0 +1,57 @@
+#include <cstddef>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "chessBoard.hpp"
+#include "chessGame.hpp"
+#include "testSupport.hpp"
+
+using namespace chess;
+using namespace chess::test;
+
+static bool load(Game &game, const std::string &state) {
+    return game.loadState(std::as_bytes(std::span(state)));
+}
+
+int main() {
+    HeadlessGame headless(true);
+    Game &game = headless.game;
+    std::vector<std::string> fens = {game.getFEN()};
+
+    for (const std::string &move : scriptedGame) {
+        check(game.tryApplyMove(move) == MoveError::none, "play " + move);
+        fens.push_back(game.getFEN());
+    }
+    std::string state = game.saveState();
+
+    HeadlessGame loadedHeadless(true);
+    Game &loaded = loadedHeadless.game;
+
+    check(load(loaded, state) && loaded.getFEN() == fens.back(), "load the state");
+    check(loaded.saveState() == state, "a loaded game saves the same state");
+
+    // the moves come back without being replayed, with the pieces they captured and promoted
+    for (std::size_t ply = loaded.moveLog.size(); ply-- > 0;) {
+        loaded.undoLastMove();
+        check(loaded.getFEN() == fens[ply], "undo back to ply " + std::to_string(ply));
+    }
+    check(loaded.tryApplyMove(scriptedGame.front()) == MoveError::none &&
+              loaded.getFEN() == fens[1],
+          "play on after undoing everything");
+
+    // a damaged state is refused and the game stays as it was
+    std::string before = loaded.getFEN();
+    for (std::size_t i = 0; i < state.size(); i += 7) {
+        std::string flipped = state;
+        flipped[i] = static_cast<char>(flipped[i] ^ 0x10);
+        check(!load(loaded, flipped) && loaded.getFEN() == before,
+              "a state with byte " + std::to_string(i) + " flipped is refused");
+    }
+    for (std::size_t size : {std::size_t{0}, std::size_t{8}, state.size() / 2, state.size() - 1}) {
+        check(!load(loaded, state.substr(0, size)) && loaded.getFEN() == before,
+              "a state cut to " + std::to_string(size) + " bytes is refused");
+    }
+
+    return result();
+}
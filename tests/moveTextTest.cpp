@@ -0,0 +1,90 @@
+#include <array>
+#include <string>
+#include <string_view>
+
+#include "chessBase.hpp"
+#include "chessBoard.hpp"
+#include "chessGame.hpp"
+#include "testSupport.hpp"
+
+using namespace chess;
+using namespace chess::test;
+
+/**
+ * `text` played from `fen` fails with `error` and leaves the game as it was, or, for
+ * `MoveError::none`, leads to `after`
+ */
+static void checkMove(const std::string &fen, std::string_view text, MoveError error,
+                      const std::string &after = "") {
+    HeadlessGame headless;
+    Game &game = headless.game;
+    check(game.loadFEN(fen), "load " + fen);
+    std::string before = game.getFEN();
+
+    check(game.tryApplyMove(text) == error &&
+              game.getFEN() == (error == MoveError::none ? after : before),
+          "play `" + std::string(text) + "` from " + fen);
+}
+
+int main() {
+    using enum MoveError;
+
+    // both knights reach d2, SAN has to say which by file, rank or square
+    std::string knights = "rnbqkb1r/ppp1pppp/5n2/3p4/3P4/5N2/PPP1PPPP/RNBQKB1R w KQkq - 2 3";
+    std::string fromB1 = "rnbqkb1r/ppp1pppp/5n2/3p4/3P4/5N2/PPPNPPPP/R1BQKB1R b KQkq - 3 3";
+    checkMove(knights, "Nd2", ambiguous);
+    checkMove(knights, "Nbd2", none, fromB1);
+    checkMove(knights, "N1d2", none, fromB1);
+    checkMove(knights, "Nb1d2", none, fromB1);
+    checkMove(knights, "b1d2", none, fromB1);
+    checkMove(knights, "Nfd2", none,
+              "rnbqkb1r/ppp1pppp/5n2/3p4/3P4/8/PPPNPPPP/RNBQKB1R b KQkq - 3 3");
+
+    // castling is `O-O` or `0-0` in SAN and the king's move in UCI, never a king move in SAN
+    std::string castles = "r3k2r/8/8/8/8/8/8/R3K2R w KQkq - 0 1";
+    std::string kingside = "r3k2r/8/8/8/8/8/8/R4RK1 b kq - 1 1";
+    std::string queenside = "r3k2r/8/8/8/8/8/8/2KR3R b kq - 1 1";
+    checkMove(castles, "O-O", none, kingside);
+    checkMove(castles, "0-0", none, kingside);
+    checkMove(castles, "e1g1", none, kingside);
+    checkMove(castles, "O-O-O", none, queenside);
+    checkMove(castles, "0-0-0", none, queenside);
+    checkMove(castles, "e1c1", none, queenside);
+    checkMove(castles, "Kg1", illegal);
+
+    // the pawn taken en passant isn't on the square the move names
+    std::string enPassant = "rnbqkbnr/ppppp1pp/8/4Pp2/8/8/PPPP1PPP/RNBQKBNR w KQkq f6 0 3";
+    std::string tookF5 = "rnbqkbnr/ppppp1pp/5P2/8/8/8/PPPP1PPP/RNBQKBNR b KQkq - 0 3";
+    checkMove(enPassant, "exf6", none, tookF5);
+    checkMove(enPassant, "e5f6", none, tookF5);
+
+    // a pawn reaching the last rank has to say what it becomes, and nothing else does
+    std::string lastRank = "7k/P7/8/8/8/8/8/K7 w - - 0 1";
+    std::string queen = "Q6k/8/8/8/8/8/8/K7 b - - 0 1";
+    checkMove(lastRank, "a8", MoveError::promotion);
+    checkMove(lastRank, "a7a8", MoveError::promotion);
+    checkMove(lastRank, "a1b1q", MoveError::promotion);
+    checkMove(lastRank, "a8=Q+", none, queen);
+    checkMove(lastRank, "a8Q", none, queen);
+    checkMove(lastRank, "a7a8q", none, queen);
+    checkMove(lastRank, "a8=N", none, "N6k/8/8/8/8/8/8/K7 b - - 0 1");
+    checkMove(lastRank, "a8=K", malformed);
+    checkMove(lastRank, "a7a8k", malformed);
+
+    // squares the board doesn't have are malformed, squares no legal move goes to are illegal
+    checkMove(startingFEN, "p4", malformed);
+    checkMove(startingFEN, "i1i2", malformed);
+    checkMove(startingFEN, "", malformed);
+    checkMove(startingFEN, "e2e5", illegal);
+
+    // a batch stops at the first move that isn't made, with the moves before it made
+    HeadlessGame batch(true);
+    std::array<std::string_view, 6> moves = {"e4", "e5", "Nf3", "Nc6", "Ke3", "Bc4"};
+    MoveBatchResult result = batch.game.tryApplyMoves(moves);
+    check(result.applied == 4 && result.error == illegal &&
+              batch.game.getFEN() ==
+                  "r1bqkbnr/pppp1ppp/2n5/4p3/4P3/5N2/PPPP1PPP/RNBQKB1R w KQkq - 2 3",
+          "a batch stops at its first illegal move");
+
+    return chess::test::result();
+}
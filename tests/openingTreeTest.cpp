@@ -0,0 +1,49 @@
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "chessArchive.hpp"
+#include "chessOpeningTree.hpp"
+#include "testSupport.hpp"
+
+using namespace chess;
+using namespace chess::test;
+
+int main() {
+    TempDirectory directory{};
+    std::string archivePath = directory.file("games.arc");
+    std::string treePath = directory.file("games.tree");
+
+    // the Queen's Gambit reached by both move orders, declined differently in each game
+    writeArchive(archivePath,
+                 {{"d2d4", "d7d5", "c2c4", "e7e6"}, {"c2c4", "d7d5", "d2d4", "c7c6"}});
+
+    std::optional<GameArchive> archive = GameArchive::open(archivePath);
+    check(archive.has_value() && buildOpeningTree(*archive, treePath), "build the tree");
+    std::optional<OpeningTree> tree = OpeningTree::open(treePath);
+    check(tree.has_value(), "open the tree");
+
+    if (tree.has_value()) {
+        std::uint64_t gambit = hashAfter("", {"d2d4", "d7d5", "c2c4"});
+        std::vector<OpeningMove> replies = tree->moves(gambit);
+        std::vector<OpeningMove> dOrder = tree->moves(hashAfter("", {"d2d4", "d7d5"}));
+        std::vector<OpeningMove> cOrder = tree->moves(hashAfter("", {"c2c4", "d7d5"}));
+        auto played = [&](const std::string &move) {
+            return std::ranges::any_of(replies, [&](const OpeningMove &reply) {
+                return reply.move == move && reply.games == 1;
+            });
+        };
+
+        // the start, 1.d4, 1.d4 d5, 1.c4, 1.c4 d5 and the gambit, which both games share
+        check(tree->size() == 6, "the gambit is one position of the tree");
+        check(replies.size() == 2 && played("e7e6") && played("c7c6"),
+              "the gambit has the replies of both move orders");
+        check(dOrder.size() == 1 && cOrder.size() == 1 && dOrder[0].position == gambit &&
+                  cOrder[0].position == gambit,
+              "both move orders lead to the gambit");
+    }
+
+    return result();
+}
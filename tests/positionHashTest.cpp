@@ -0,0 +1,59 @@
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "chessArchive.hpp"
+#include "chessBase.hpp"
+#include "chessGame.hpp"
+#include "chessPositionIndex.hpp"
+#include "testSupport.hpp"
+
+using namespace chess;
+using namespace chess::test;
+
+int main() {
+    std::string gambit = "rnbqkbnr/ppp1pppp/8/3p4/2PP4/8/PP2PPPP/RNBQKBNR b KQkq";
+    std::uint64_t dFirst = hashAfter("", {"d2d4", "d7d5", "c2c4"});
+    std::uint64_t cFirst = hashAfter("", {"c2c4", "d7d5", "d2d4"});
+
+    // no black pawn can take either pushed pawn, so neither push leaves an en passant square
+    check(dFirst == cFirst, "1.d4 d5 2.c4 and 1.c4 d5 2.d4 hash the same");
+    check(dFirst == hashAfter(gambit + " - 0 2", {}), "1.d4 d5 2.c4 hashes like its FEN");
+    check(dFirst == hashAfter(gambit + " c3 0 2", {}), "a FEN's en passant square nobody can use");
+
+    // exd6 can be played after d5, so the position differs from the one without the push
+    std::uint64_t capturable = hashAfter("", {"e2e4", "a7a6", "e4e5", "d7d5"});
+    std::string advance = "rnbqkbnr/1pp1pppp/p7/3pP3/8/8/PPPP1PPP/RNBQKBNR w KQkq";
+    check(capturable == hashAfter(advance + " d6 0 3", {}), "a usable en passant square counts");
+    check(capturable != hashAfter(advance + " - 0 3", {}), "a usable en passant square differs");
+
+    // bxc6 would leave the white king in check from the rook
+    check(hashAfter("7k/2p5/8/KP5r/8/8/8/8 b - - 0 1", {"c7c5"}) ==
+              hashAfter("7k/8/8/KPp4r/8/8/8/8 w - - 0 2", {}),
+          "an en passant capture that leaves the king in check doesn't count");
+
+    // both move orders are found by the FEN of the position, whichever en passant square it has
+    TempDirectory directory{};
+    std::string archivePath = directory.file("games.arc");
+    std::string indexPath = directory.file("games.idx");
+    writeArchive(archivePath, {{"d2d4", "d7d5", "c2c4"}, {"c2c4", "d7d5", "d2d4"}});
+
+    std::optional<GameArchive> archive = GameArchive::open(archivePath);
+    check(archive.has_value() && buildPositionIndex(*archive, indexPath), "build the index");
+    std::optional<PositionIndex> index = PositionIndex::open(indexPath);
+    check(index.has_value(), "open the index");
+    if (index.has_value()) {
+        for (std::string_view square : {"-", "c3", "d3"}) {
+            std::vector<PositionHit> hits =
+                index->find(hashAfter(gambit + " " + std::string(square) + " 0 2", {}));
+
+            check(hits.size() == 2 && hits[0].game == 0 && hits[0].ply == 3 &&
+                      hits[1].game == 1 && hits[1].ply == 3,
+                  "the index finds both move orders from the FEN with " + std::string(square));
+        }
+    }
+
+    return result();
+}
@@ -0,0 +1,115 @@
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "chessBoard.hpp"
+#include "chessGame.hpp"
+#include "chessMaterial.hpp"
+#include "testSupport.hpp"
+
+using namespace chess;
+using namespace chess::test;
+
+/**
+ * a game whose checkpoints can be looked at
+ */
+class CheckpointedGame : public Game {
+   public:
+    using Game::Game;
+
+    bool hasCheckpoint(std::size_t ply) { return checkpointSlot(ply).has_value(); }
+};
+
+/**
+ * what the game looked like after each ply of `scriptedGame`
+ */
+struct Ply {
+    std::string fen;
+    std::uint64_t hash;
+    material::Key material;
+};
+
+static bool isAt(Game &game, const std::vector<Ply> &plies, std::size_t ply) {
+    return game.moveLog.size() == ply && game.getFEN() == plies[ply].fen &&
+           game.positionHash() == plies[ply].hash && game.materialKey() == plies[ply].material;
+}
+
+/**
+ * the captures of `moveLog` point at the captured pieces, not at ones a restore replaced
+ */
+static bool capturesBound(const Game &game) {
+    bool ret = true;
+
+    for (const Move &move : game.moveLog) {
+        bool found = move.endPiece == nullptr;
+        for (const Player *player : {&game.player1, &game.player2}) {
+            for (const std::unique_ptr<Piece> &piece : player->capturedPieces) {
+                found = found || piece.get() == move.endPiece;
+            }
+        }
+        ret = ret && found;
+    }
+
+    return ret;
+}
+
+static void checkCheckpoints(CheckpointedGame &game, const std::string &when) {
+    for (std::size_t ply = 0; ply <= scriptedGame.size(); ply += Game::checkpointInterval) {
+        check(game.hasCheckpoint(ply), "a checkpoint of ply " + std::to_string(ply) + " " + when);
+    }
+}
+
+/**
+ * seeks back and forth at random and then undoes every move from where the seeks ended
+ */
+static void checkSeeks(Game &game, const std::vector<Ply> &plies, std::uint32_t seed) {
+    std::mt19937 random(seed);
+
+    for (int i = 0; i < 200; i++) {
+        std::size_t ply = random() % plies.size();
+        check(game.seekToPly(ply) && isAt(game, plies, ply) && capturesBound(game),
+              "seek to ply " + std::to_string(ply));
+    }
+    check(!game.seekToPly(plies.size()) && game.lineLength() == plies.size() - 1,
+          "a seek past the end of the line is refused");
+
+    for (std::size_t ply = game.moveLog.size(); ply-- > 0;) {
+        game.undoLastMove();
+        check(isAt(game, plies, ply), "undo back to ply " + std::to_string(ply));
+    }
+}
+
+int main() {
+    Board board(64, true);
+    Player white(PieceColor::white);
+    Player black(PieceColor::black);
+    CheckpointedGame game(board, white, black);
+    std::vector<Ply> plies = {{game.getFEN(), game.positionHash(), game.materialKey()}};
+
+    for (const std::string &move : scriptedGame) {
+        check(game.tryApplyMove(move) == MoveError::none, "play " + move);
+        plies.push_back({game.getFEN(), game.positionHash(), game.materialKey()});
+    }
+
+    // the first seek of a game already finds its checkpoints
+    checkCheckpoints(game, "before any seek");
+    checkSeeks(game, plies, 1);
+
+    // and so does the first seek of a game brought back by `loadState()`
+    check(game.seekToPly(scriptedGame.size()), "seek to the end");
+    std::string state = game.saveState();
+    Board loadedBoard(64, true);
+    Player loadedWhite(PieceColor::white);
+    Player loadedBlack(PieceColor::black);
+    CheckpointedGame loaded(loadedBoard, loadedWhite, loadedBlack);
+
+    check(loaded.loadState(std::as_bytes(std::span(state))), "load the state");
+    checkCheckpoints(loaded, "after loadState()");
+    checkSeeks(loaded, plies, 2);
+
+    return result();
+}
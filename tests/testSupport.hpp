@@ -0,0 +1,97 @@
+#pragma once
+
+#include <unistd.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "chessArchive.hpp"
+#include "chessBase.hpp"
+#include "chessBoard.hpp"
+#include "chessGame.hpp"
+
+namespace chess::test {
+
+inline int failures = 0;
+
+/**
+ * reports `what` if `ok` isn't set, `main()` returns `result()`
+ */
+inline void check(bool ok, const std::string &what) {
+    if (!ok) {
+        std::cerr << "FAILED: " << what << "\n";
+        failures++;
+    }
+}
+
+inline int result() { return failures == 0 ? 0 : 1; }
+
+/**
+ * `positionHash()` of the position reached from `fen` (empty for the standard starting position)
+ * by `moves` in UCI notation
+ */
+inline std::uint64_t hashAfter(const std::string &fen, const std::vector<std::string> &moves) {
+    HeadlessGame headless(true);
+    Game &game = headless.game;
+    bool ok = fen.empty() || game.loadFEN(fen);
+
+    for (const std::string &move : moves) {
+        ok = ok && game.tryApplyMove(move) == MoveError::none;
+    }
+    check(ok, "set up " + fen + " and its moves");
+
+    return game.positionHash();
+}
+
+/**
+ * 52 plies from the standard starting position in UCI notation, with an en passant capture
+ * (ply 5), castling on both sides (plies 11 and 14) and a promotion that captures (ply 33)
+ */
+inline const std::vector<std::string> scriptedGame = {
+    "e2e4", "a7a6", "e4e5", "d7d5", "e5d6", "c7d6", "g1f3", "b8c6", "f1c4", "c8g4", "e1g1",
+    "d8d7", "b1c3", "e8c8", "d2d4", "g4f3", "d1f3", "c6d4", "f3f7", "d4c2", "f7g8", "c2a1",
+    "g8h8", "c8b8", "h2h4", "d7e6", "h4h5", "e6c4", "h5h6", "c4c3", "h6g7", "c3c2", "g7f8q",
+    "a1b3", "f8d8", "b8a7", "h8h7", "b3c5", "c1e3", "c2b2", "e3c5", "d6c5", "f1d1", "b2a2",
+    "d1d7", "a2a1", "g1h2", "a1e5", "g2g3", "e5e4", "d8c8", "e4e1"};
+
+/**
+ * writes an archive of games from the standard starting position, each given as its moves in
+ * UCI notation
+ */
+inline void writeArchive(const std::string &path,
+                         const std::vector<std::vector<std::string>> &games) {
+    std::optional<GameArchiveWriter> writer = GameArchiveWriter::create(path);
+    bool ok = writer.has_value();
+
+    for (const std::vector<std::string> &moves : games) {
+        ok = ok && writer->append("", moves);
+    }
+    check(ok && writer->close(), "write " + path);
+}
+
+/**
+ * a new directory for the files of one test, removed with everything in it when it goes out of
+ * scope
+ */
+class TempDirectory {
+   private:
+    std::filesystem::path _path;
+
+   public:
+    TempDirectory()
+        : _path(std::filesystem::temp_directory_path() /
+                ("chess_test_" + std::to_string(getpid()))) {
+        std::filesystem::create_directories(_path);
+    }
+    TempDirectory(const TempDirectory &) = delete;
+    TempDirectory &operator=(const TempDirectory &) = delete;
+    ~TempDirectory() { std::filesystem::remove_all(_path); }
+
+    std::string file(const std::string &name) const { return (_path / name).string(); }
+};
+
+}  // namespace chess::test
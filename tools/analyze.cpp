@@ -0,0 +1,99 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+
+#include "chessAnalysis.hpp"
+#include "chessBase.hpp"
+#include "chessEngine.hpp"
+#include "chessNNUE.hpp"
+#include "chessPosition.hpp"
+
+using namespace chess;
+
+static void printUsage() {
+    std::cout << "usage: chess_analyze [options]\n"
+                 "reads one FEN per line from stdin and analyzes it until the next one,\n"
+                 "an empty line stops the analysis\n"
+                 "options:\n"
+                 "  --lines N     best moves to show (default 3)\n"
+                 "  --eval NET    evaluate with a network written by chess_nnue\n";
+}
+
+int main(int argc, char **argv) {
+    int ret = 0;
+    int lines = 3;
+    std::unique_ptr<Engine> engine = std::make_unique<MaterialEngine>();
+    bool ok = true;
+
+    for (int i = 1; i < argc && ok; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (!hasValue) {
+            ok = false;
+        } else if (arg == "--lines") {
+            lines = std::atoi(argv[++i]);
+        } else if (arg == "--eval") {
+            std::shared_ptr<const nnue::Network> network = nnue::Network::load(argv[++i]);
+            ok = network != nullptr;
+            if (ok) {
+                engine = std::make_unique<NNUEEngine>(network);
+            }
+        } else {
+            ok = false;
+        }
+    }
+
+    if (!ok || lines < 1) {
+        printUsage();
+        ret = 1;
+    } else {
+        std::mutex outMutex;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        AnalysisSession session(std::move(engine), lines, [&](const AnalysisUpdate &update) {
+            std::lock_guard lock(outMutex);
+            std::int64_t ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                  std::chrono::steady_clock::now() - start)
+                                  .count();
+
+            std::cout << "[" << ms << "ms] #" << update.generation << " depth " << update.info.depth
+                      << " line " << update.info.multiPV << " "
+                      << (update.info.mateIn.has_value()
+                              ? "mate " + std::to_string(*update.info.mateIn)
+                              : std::to_string(update.info.score))
+                      << " pv";
+            for (const std::string &move : update.info.pv) {
+                std::cout << " " << move;
+            }
+            std::cout << std::endl;
+        });
+        std::string line{};
+
+        while (std::getline(std::cin, line)) {
+            std::optional<Position> position = Position::fromFEN(line);
+
+            if (line.empty()) {
+                session.stop();
+            } else if (!position.has_value()) {
+                std::lock_guard lock(outMutex);
+                std::cerr << "invalid fen " << line << "\n";
+            } else {
+                {
+                    std::lock_guard lock(outMutex);
+                    start = std::chrono::steady_clock::now();
+                }
+                // not under `outMutex`, the session holds its own lock while it prints
+                std::uint64_t generation = session.analyze(*position);
+                std::lock_guard lock(outMutex);
+                std::cout << "#" << generation << " " << line << std::endl;
+            }
+        }
+    }
+
+    return ret;
+}
@@ -0,0 +1,77 @@
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <string>
+
+#include "chessAnnotation.hpp"
+#include "chessArchive.hpp"
+#include "chessEngine.hpp"
+#include "chessNNUE.hpp"
+
+using namespace chess;
+
+static void printUsage() {
+    std::cout << "usage: chess_annotate ARCHIVE PGN [options]\n"
+                 "annotates every move of the archive's games with an evaluation, the best move\n"
+                 "and whether it was an inaccuracy, a mistake or a blunder\n"
+                 "options:\n"
+                 "  --depth N     search depth per position (default 4)\n"
+                 "  --threads N   worker threads (default: one per core)\n"
+                 "  --eval NET    evaluate with a network written by chess_nnue\n";
+}
+
+int main(int argc, char **argv) {
+    int ret = 1;
+    AnnotationConfig config{};
+    std::shared_ptr<const nnue::Network> network = nullptr;
+    bool ok = argc >= 3;
+
+    for (int i = 3; i < argc && ok; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (!hasValue) {
+            ok = false;
+        } else if (arg == "--depth") {
+            config.depth = std::atoi(argv[++i]);
+        } else if (arg == "--threads") {
+            config.threads = std::atoi(argv[++i]);
+        } else if (arg == "--eval") {
+            network = nnue::Network::load(argv[++i]);
+            ok = network != nullptr;
+        } else {
+            ok = false;
+        }
+    }
+
+    if (network != nullptr) {
+        config.engineFactory = [network]() -> std::unique_ptr<Engine> {
+            return std::make_unique<NNUEEngine>(network);
+        };
+    }
+
+    std::optional<GameArchive> archive = ok ? GameArchive::open(argv[1]) : std::nullopt;
+    std::ofstream out = ok ? std::ofstream(argv[2]) : std::ofstream();
+
+    if (!ok || config.depth < 1) {
+        printUsage();
+    } else if (!archive.has_value()) {
+        std::cerr << argv[1] << " isn't a game archive\n";
+    } else if (!out) {
+        std::cerr << "can't write " << argv[2] << "\n";
+    } else {
+        AnnotationCache cache{};
+        AnnotationStats stats = annotateGames(*archive, config, cache,
+                                              [&](const AnnotatedGame &game) {
+                                                  out << toPGN(game) << "\n";
+                                              });
+
+        std::cout << stats.games << " games, " << stats.positions << " positions, "
+                  << stats.searched << " searched in " << stats.seconds << "s\n";
+        ret = out.flush() ? 0 : 1;
+    }
+
+    return ret;
+}
@@ -0,0 +1,123 @@
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "chessArchive.hpp"
+#include "chessBase.hpp"
+
+using namespace chess;
+
+static void printUsage() {
+    std::cout << "usage: chess_archive pack ARCHIVE < games\n"
+                 "       chess_archive unpack ARCHIVE [first] [count] > games\n"
+                 "       chess_archive info ARCHIVE\n"
+                 "games are read and written one per line in the form of a UCI position command\n"
+                 "without the leading `position`: startpos|fen FEN [moves ...]\n";
+}
+
+/**
+ * reads `startpos|fen FEN [moves ...]` lines and appends them to the archive
+ */
+static int pack(const std::string &path) {
+    int ret = 0;
+    std::optional<GameArchiveWriter> writer = GameArchiveWriter::create(path);
+    std::string line{};
+
+    if (!writer.has_value()) {
+        std::cerr << "can't write " << path << "\n";
+        ret = 1;
+    }
+
+    for (int lineNumber = 1; ret == 0 && std::getline(std::cin, line); lineNumber++) {
+        std::istringstream stream(line);
+        std::string token{};
+        std::string fen{};
+        std::vector<std::string> moves{};
+
+        stream >> token;
+        if (token == "fen") {
+            while (stream >> token && token != "moves") {
+                fen += (fen.empty() ? "" : " ") + token;
+            }
+        } else if (token == "startpos") {
+            stream >> token;
+        } else if (token.empty()) {
+            continue;
+        }
+
+        while (token == "moves" && stream >> token) {
+            moves.push_back(token);
+            token = "moves";
+        }
+
+        if (!writer->append(fen, moves)) {
+            std::cerr << "line " << lineNumber << ": invalid game\n";
+            ret = 1;
+        }
+    }
+
+    if (ret == 0 && !writer->close()) {
+        std::cerr << "can't write " << path << "\n";
+        ret = 1;
+    }
+
+    return ret;
+}
+
+static int unpack(const GameArchive &archive, std::size_t first, std::size_t count) {
+    int ret = 0;
+
+    for (std::size_t i = first; i < archive.size() && i - first < count && ret == 0; i++) {
+        std::optional<ArchivedGame> game = archive.game(i);
+
+        if (game.has_value()) {
+            std::cout << (game->fen.empty() ? "startpos" : "fen " + std::string(game->fen));
+            for (std::size_t ply = 0; ply < game->plies(); ply++) {
+                std::cout << (ply == 0 ? " moves " : " ") << game->moveUCI(ply);
+            }
+            std::cout << "\n";
+        } else {
+            std::cerr << "game " << i << " is corrupt\n";
+            ret = 1;
+        }
+    }
+
+    return ret;
+}
+
+int main(int argc, char **argv) {
+    int ret = 1;
+    std::vector<std::string> args(argv + 1, argv + argc);
+
+    if (args.size() == 2 && args[0] == "pack") {
+        ret = pack(args[1]);
+    } else if (args.size() >= 2 && (args[0] == "unpack" || args[0] == "info")) {
+        std::optional<GameArchive> archive = GameArchive::open(args[1]);
+
+        if (!archive.has_value()) {
+            std::cerr << args[1] << " isn't a game archive\n";
+        } else if (args[0] == "info") {
+            std::size_t plies = 0;
+
+            for (std::size_t i = 0; i < archive->size(); i++) {
+                std::optional<ArchivedGame> game = archive->game(i);
+                plies += game.has_value() ? game->plies() : 0;
+            }
+            std::cout << archive->size() << " games, " << plies << " plies\n";
+            ret = 0;
+        } else {
+            std::size_t first = args.size() > 2 ? std::strtoull(args[2].c_str(), nullptr, 10) : 0;
+            std::size_t count =
+                args.size() > 3 ? std::strtoull(args[3].c_str(), nullptr, 10) : archive->size();
+            ret = unpack(*archive, first, count);
+        }
+    } else {
+        printUsage();
+    }
+
+    return ret;
+}
@@ -0,0 +1,555 @@
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "chessArchive.hpp"
+#include "chessBase.hpp"
+#include "chessGame.hpp"
+#include "chessPosition.hpp"
+#include "chessProtocol.hpp"
+#include "chessScheduler.hpp"
+
+using namespace chess;
+
+static void printUsage() {
+    std::cout << "usage: chess_host SOCKET [options]\n"
+                 "hosts games for the clients of a Unix domain socket, see chessProtocol.hpp\n"
+                 "options:\n"
+                 "  --threads N       threads playing the games (default: one per core)\n"
+                 "  --max-inflight N  requests of a connection without a reply before it stops\n"
+                 "                    being read (default 4096)\n";
+}
+
+/**
+ * the moves submitted for a game, in order, whichever side they're for
+ */
+struct MoveQueue {
+    std::mutex mutex;
+    std::deque<std::uint16_t> moves;
+};
+
+/**
+ * both players of a hosted game take their moves from the same queue, so every move gets its
+ * answer in the order it was sent, a move for the side not to move is refused
+ */
+class QueuedPlayer : public Player {
+   private:
+    std::shared_ptr<MoveQueue> _queue;
+
+   public:
+    QueuedPlayer(PieceColor color_, std::shared_ptr<MoveQueue> queue)
+        : Player(color_), _queue(std::move(queue)) {}
+
+    std::optional<Move> chooseMove(Game &game) override {
+        std::optional<Move> ret = std::nullopt;
+        std::lock_guard lock(_queue->mutex);
+
+        if (!_queue->moves.empty()) {
+            ret = game.moveFromUCI(unpackMove(_queue->moves.front()))
+                      .value_or(Move{nullptr, nullptr, "", ""});
+            _queue->moves.pop_front();
+        }
+
+        return ret;
+    }
+};
+
+struct Connection {
+    int fd;
+    /**
+     * bytes read and not parsed yet, and bytes being written, only used by the I/O thread
+     */
+    std::string in;
+    std::string sending;
+    std::size_t sent;
+    /**
+     * replies not written yet, requests without a reply and the games it started, under the
+     * host's lock since the game threads reply
+     */
+    std::string out;
+    std::size_t inFlight;
+    std::unordered_set<GameId> games;
+    bool reading;
+    bool writing;
+};
+
+struct HostedGame {
+    std::uint64_t connection;
+    std::shared_ptr<MoveQueue> queue;
+    /**
+     * tags of the moves submitted and not answered yet
+     */
+    std::deque<std::uint32_t> tags;
+    std::optional<std::uint32_t> closeTag;
+};
+
+/**
+ * epoll data of the sockets and descriptors that aren't connections
+ */
+enum : std::uint64_t { listenerId = 0, wakeId = 1, signalId = 2, firstConnectionId = 3 };
+
+struct Host {
+    int epoll;
+    int listener;
+    /**
+     * an eventfd the game threads write to when they queued replies
+     */
+    int wake;
+    std::size_t maxInFlight;
+    std::mutex mutex;
+    std::unordered_map<std::uint64_t, std::unique_ptr<Connection>> connections;
+    std::unordered_map<GameId, HostedGame> games;
+    /**
+     * connections with replies to write
+     */
+    std::vector<std::uint64_t> dirty;
+    std::uint64_t nextConnection;
+    std::uint64_t requests;
+    GameScheduler *scheduler;
+};
+
+static void watch(Host &host, std::uint64_t id, Connection &connection) {
+    epoll_event event{};
+    event.events = (connection.reading ? static_cast<std::uint32_t>(EPOLLIN) : 0) |
+                   (connection.writing ? static_cast<std::uint32_t>(EPOLLOUT) : 0);
+    event.data.u64 = id;
+    epoll_ctl(host.epoll, EPOLL_CTL_MOD, connection.fd, &event);
+}
+
+/**
+ * queues a reply for the connection, under the host's lock
+ */
+static void reply(Host &host, std::uint64_t id, const protocol::Reply &reply) {
+    auto it = host.connections.find(id);
+
+    if (it != host.connections.end()) {
+        Connection &connection = *it->second;
+
+        if (connection.out.empty()) {
+            if (host.dirty.empty()) {
+                std::uint64_t one = 1;
+                write(host.wake, &one, sizeof(one));
+            }
+            host.dirty.push_back(id);
+        }
+        protocol::appendReply(connection.out, reply);
+        connection.inFlight--;
+    }
+}
+
+/**
+ * answers the moves of a game as it plays them, called from the game threads
+ */
+static void onUpdate(Host &host, const GameUpdate &update) {
+    using protocol::Status;
+
+    std::lock_guard lock(host.mutex);
+    auto it = host.games.find(update.id);
+
+    if (it != host.games.end()) {
+        HostedGame &game = it->second;
+
+        if (!update.move.empty() && !game.tags.empty()) {
+            reply(host, game.connection,
+                  {game.tags.front(), update.id,
+                   update.accepted ? Status::ok : Status::illegalMove, update.result});
+            game.tags.pop_front();
+        }
+
+        if (update.finished) {
+            for (std::uint32_t tag : game.tags) {
+                reply(host, game.connection, {tag, update.id, Status::gameOver, update.result});
+            }
+            if (game.closeTag.has_value()) {
+                reply(host, game.connection,
+                      {*game.closeTag, update.id, Status::ok, update.result});
+            }
+
+            auto connection = host.connections.find(game.connection);
+            if (connection != host.connections.end()) {
+                connection->second->games.erase(update.id);
+            }
+            host.games.erase(it);
+        }
+    }
+}
+
+/**
+ * handles one request of a connection, under the host's lock
+ */
+static void handle(Host &host, std::uint64_t id, Connection &connection,
+                   const protocol::Request &request) {
+    using protocol::RequestType;
+    using protocol::Status;
+
+    auto game = host.games.find(request.game);
+    bool owned = game != host.games.end() && game->second.connection == id;
+
+    host.requests++;
+    connection.inFlight++;
+
+    if (request.type == RequestType::newGame) {
+        std::optional<Position> position =
+            request.fen.empty() ? std::nullopt : Position::fromFEN(request.fen);
+        auto queue = std::make_shared<MoveQueue>();
+        std::optional<GameId> started = std::nullopt;
+
+        if (request.fen.empty() || position.has_value()) {
+            started = host.scheduler->spawn(
+                std::make_unique<QueuedPlayer>(PieceColor::white, queue),
+                std::make_unique<QueuedPlayer>(PieceColor::black, queue), position);
+        }
+        if (started.has_value()) {
+            // the game can't report anything before this, its thread waits for the lock
+            host.games.emplace(*started, HostedGame{id, queue, {}, std::nullopt});
+            connection.games.insert(*started);
+        }
+        reply(host, id,
+              {request.tag, started.value_or(0),
+               started.has_value() ? Status::ok : Status::invalidPosition,
+               WinSearchResult::nothing});
+    } else if (!owned || game->second.closeTag.has_value()) {
+        reply(host, id, {request.tag, request.game, Status::unknownGame, WinSearchResult::nothing});
+    } else if (request.type == RequestType::move) {
+        {
+            std::lock_guard lock(game->second.queue->mutex);
+            game->second.queue->moves.push_back(request.move);
+        }
+        game->second.tags.push_back(request.tag);
+        host.scheduler->wake(request.game);
+    } else {
+        game->second.closeTag = request.tag;
+        host.scheduler->abort(request.game);
+    }
+}
+
+/**
+ * parses the requests read so far until the connection has too many without a reply,
+ * returns `false` if one is malformed
+ */
+static bool parse(Host &host, std::uint64_t id, Connection &connection) {
+    std::optional<std::size_t> used = 0;
+    std::size_t offset = 0;
+    protocol::Request request{};
+    std::lock_guard lock(host.mutex);
+
+    while (used.has_value() && connection.inFlight < host.maxInFlight) {
+        std::span<const std::byte> bytes =
+            std::as_bytes(std::span(connection.in)).subspan(offset);
+
+        used = protocol::readRequest(bytes, request);
+        if (used.value_or(0) == 0) {
+            break;
+        }
+        handle(host, id, connection, request);
+        offset += *used;
+    }
+    connection.in.erase(0, offset);
+
+    // back-pressure, a client that doesn't read its replies isn't read either
+    connection.reading = connection.inFlight < host.maxInFlight &&
+                         connection.out.size() < host.maxInFlight * 32;
+
+    return used.has_value();
+}
+
+static void disconnect(Host &host, std::uint64_t id) {
+    std::unique_ptr<Connection> connection = nullptr;
+
+    {
+        std::lock_guard lock(host.mutex);
+        auto it = host.connections.find(id);
+
+        if (it != host.connections.end()) {
+            connection = std::move(it->second);
+            host.connections.erase(it);
+            for (GameId game : connection->games) {
+                host.scheduler->abort(game);
+            }
+        }
+    }
+
+    if (connection != nullptr) {
+        epoll_ctl(host.epoll, EPOLL_CTL_DEL, connection->fd, nullptr);
+        close(connection->fd);
+    }
+}
+
+/**
+ * writes what the connection has to send until the socket is full, returns `false` if the
+ * connection broke
+ */
+static bool flush(Host &host, Connection &connection) {
+    bool ret = true;
+    bool full = false;
+
+    while (ret && !full) {
+        if (connection.sent == connection.sending.size()) {
+            std::lock_guard lock(host.mutex);
+            connection.sending.clear();
+            connection.sent = 0;
+            connection.sending.swap(connection.out);
+        }
+        if (connection.sending.empty()) {
+            break;
+        }
+
+        ssize_t written = send(connection.fd, connection.sending.data() + connection.sent,
+                               connection.sending.size() - connection.sent, MSG_NOSIGNAL);
+        full = written < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+        ret = written >= 0 || full || errno == EINTR;
+        connection.sent += written > 0 ? written : 0;
+    }
+
+    return ret;
+}
+
+/**
+ * reads what the connection sent, returns `false` once it's closed or broken
+ */
+static bool receive(Host &host, std::uint64_t id, Connection &connection) {
+    bool ret = true;
+    std::array<char, 65536> buffer{};
+
+    while (ret) {
+        ssize_t got = recv(connection.fd, buffer.data(), buffer.size(), 0);
+
+        if (got < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        }
+        ret = got > 0 || (got < 0 && errno == EINTR);
+        connection.in.append(buffer.data(), got > 0 ? got : 0);
+    }
+
+    return parse(host, id, connection) && ret;
+}
+
+static void accept(Host &host) {
+    int fd = -1;
+
+    while ((fd = accept4(host.listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0) {
+        std::lock_guard lock(host.mutex);
+        std::uint64_t id = host.nextConnection++;
+        auto connection = std::make_unique<Connection>();
+        epoll_event event{};
+
+        connection->fd = fd;
+        connection->sent = 0;
+        connection->inFlight = 0;
+        connection->reading = true;
+        connection->writing = false;
+        event.events = EPOLLIN;
+        event.data.u64 = id;
+        epoll_ctl(host.epoll, EPOLL_CTL_ADD, fd, &event);
+        host.connections.emplace(id, std::move(connection));
+    }
+}
+
+/**
+ * writes the replies the game threads queued and reads again from the connections that were
+ * waiting for their replies to go out
+ */
+static void writeReplies(Host &host) {
+    std::uint64_t count = 0;
+    std::vector<std::uint64_t> dirty{};
+
+    read(host.wake, &count, sizeof(count));
+    {
+        std::lock_guard lock(host.mutex);
+        dirty.swap(host.dirty);
+    }
+
+    for (std::uint64_t id : dirty) {
+        Connection *connection = nullptr;
+        {
+            std::lock_guard lock(host.mutex);
+            auto it = host.connections.find(id);
+            connection = it != host.connections.end() ? it->second.get() : nullptr;
+        }
+
+        // connections are only removed by this thread, the pointer stays valid
+        bool open = connection == nullptr || flush(host, *connection);
+        bool wasReading = connection != nullptr && connection->reading;
+
+        if (connection != nullptr && open && !wasReading) {
+            open = parse(host, id, *connection);
+        }
+        if (!open) {
+            disconnect(host, id);
+        } else if (connection != nullptr) {
+            bool writing = connection->sent < connection->sending.size();
+
+            if (writing != connection->writing || wasReading != connection->reading) {
+                connection->writing = writing;
+                watch(host, id, *connection);
+            }
+        }
+    }
+}
+
+/**
+ * a non-blocking socket listening on `path`, -1 if it can't be bound
+ */
+static int listenOn(const std::string &path) {
+    int ret = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    sockaddr_un address{};
+
+    address.sun_family = AF_UNIX;
+    if (ret >= 0 && path.size() < sizeof(address.sun_path)) {
+        std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+        unlink(path.c_str());
+        if (bind(ret, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 ||
+            listen(ret, SOMAXCONN) != 0) {
+            close(ret);
+            ret = -1;
+        }
+    } else if (ret >= 0) {
+        close(ret);
+        ret = -1;
+    }
+
+    return ret;
+}
+
+int main(int argc, char **argv) {
+    int ret = 0;
+    int threads = 0;
+    std::size_t maxInFlight = 4096;
+    std::string path{};
+    bool ok = argc >= 2;
+
+    for (int i = 2; i < argc && ok; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (!hasValue) {
+            ok = false;
+        } else if (arg == "--threads") {
+            threads = std::atoi(argv[++i]);
+        } else if (arg == "--max-inflight") {
+            maxInFlight = std::strtoull(argv[++i], nullptr, 10);
+        } else {
+            ok = false;
+        }
+    }
+    path = ok ? argv[1] : "";
+
+    // blocked before the game threads start so they inherit it, SIGINT and SIGTERM arrive on
+    // the signalfd instead
+    sigset_t signals{};
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+    Host host{};
+    host.listener = ok ? listenOn(path) : -1;
+    host.maxInFlight = std::max<std::size_t>(maxInFlight, 1);
+    host.nextConnection = firstConnectionId;
+
+    if (!ok) {
+        printUsage();
+        ret = 1;
+    } else if (host.listener < 0) {
+        std::cerr << "can't listen on " << path << ": " << std::strerror(errno) << "\n";
+        ret = 1;
+    } else {
+        auto scheduler = std::make_unique<GameScheduler>(
+            [&](const GameUpdate &update) { onUpdate(host, update); }, threads);
+        int signalFd = signalfd(-1, &signals, SFD_NONBLOCK | SFD_CLOEXEC);
+        std::array<epoll_event, 256> events{};
+        bool running = true;
+
+        host.scheduler = scheduler.get();
+        host.epoll = epoll_create1(EPOLL_CLOEXEC);
+        host.wake = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        for (auto [fd, id] : {std::pair{host.listener, listenerId}, std::pair{host.wake, wakeId},
+                              std::pair{signalFd, signalId}}) {
+            epoll_event event{};
+            event.events = EPOLLIN;
+            event.data.u64 = id;
+            epoll_ctl(host.epoll, EPOLL_CTL_ADD, fd, &event);
+        }
+        std::cout << "listening on " << path << std::endl;
+
+        while (running) {
+            int count = epoll_wait(host.epoll, events.data(), events.size(), -1);
+
+            for (int i = 0; i < count; i++) {
+                std::uint64_t id = events[i].data.u64;
+                Connection *connection = nullptr;
+
+                if (id == listenerId) {
+                    accept(host);
+                } else if (id == wakeId) {
+                    writeReplies(host);
+                } else if (id == signalId) {
+                    running = false;
+                } else {
+                    {
+                        std::lock_guard lock(host.mutex);
+                        auto it = host.connections.find(id);
+                        connection = it != host.connections.end() ? it->second.get() : nullptr;
+                    }
+                    bool open = connection == nullptr;
+
+                    if (connection != nullptr) {
+                        bool reading = connection->reading;
+                        open = (!(events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) ||
+                                receive(host, id, *connection)) &&
+                               (!(events[i].events & EPOLLOUT) || flush(host, *connection));
+                        bool writing = connection->sent < connection->sending.size();
+
+                        if (open &&
+                            (reading != connection->reading || writing != connection->writing)) {
+                            connection->writing = writing;
+                            watch(host, id, *connection);
+                        }
+                    }
+                    if (!open) {
+                        disconnect(host, id);
+                    }
+                }
+            }
+        }
+
+        std::cout << host.requests << " requests from " << host.nextConnection - firstConnectionId
+                  << " connections" << std::endl;
+        // the game threads stop before the descriptors they report to are closed
+        scheduler.reset();
+        for (auto &[id, connection] : host.connections) {
+            close(connection->fd);
+        }
+        close(signalFd);
+        close(host.wake);
+        close(host.epoll);
+        close(host.listener);
+        unlink(path.c_str());
+    }
+
+    return ret;
+}
@@ -0,0 +1,261 @@
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "chessArchive.hpp"
+#include "chessBase.hpp"
+#include "chessBoard.hpp"
+#include "chessGame.hpp"
+#include "chessProtocol.hpp"
+
+using namespace chess;
+
+using Clock = std::chrono::steady_clock;
+
+static void printUsage() {
+    std::cout << "usage: chess_host_load SOCKET [options]\n"
+                 "plays games on a chess_host server and measures its moves/s and latency\n"
+                 "options:\n"
+                 "  --connections N  connections, each with its own thread (default 4)\n"
+                 "  --games N        games each connection plays at the same time (default 64)\n"
+                 "  --moves N        moves each connection sends (default 20000)\n"
+                 "  --plies N        longest game replayed (default 60)\n"
+                 "  --seed N\n";
+}
+
+/**
+ * games of random legal moves played ahead of time, so the client doesn't need the rules
+ */
+static std::vector<std::vector<std::uint16_t>> randomGames(int count, int plies,
+                                                           std::uint64_t seed) {
+    std::vector<std::vector<std::uint16_t>> ret(count);
+    std::mt19937_64 random(seed);
+    HeadlessGame headless;
+    Game &game = headless.game;
+
+    for (std::vector<std::uint16_t> &moves : ret) {
+        game.reset();
+        for (int ply = 0; ply < plies && game.lookForWin() == WinSearchResult::nothing; ply++) {
+            std::span<const Move> legal = game.legalMoves();
+            Move move = legal[random() % legal.size()];
+
+            moves.push_back(packMove(moveToUCI(move)).value_or(0));
+            game.makeMove(move);
+        }
+    }
+
+    return ret;
+}
+
+struct LoadStats {
+    std::int64_t moves = 0;
+    std::int64_t games = 0;
+    std::int64_t errors = 0;
+    /**
+     * microseconds from sending each request to reading its reply
+     */
+    std::vector<std::int64_t> latencies{};
+};
+
+/**
+ * plays `games` games at a time on one connection until `moves` moves were answered, one
+ * request per game is in flight and the requests a batch of replies calls for are sent at once
+ */
+static LoadStats play(const std::string &path, int games, std::int64_t moves,
+                      const std::vector<std::vector<std::uint16_t>> &sequences,
+                      std::uint64_t seed) {
+    enum class State { starting, moving, closing };
+    struct Slot {
+        State state;
+        std::uint64_t game;
+        const std::vector<std::uint16_t> *moves;
+        std::size_t ply;
+        Clock::time_point sent;
+    };
+
+    LoadStats ret{};
+    std::vector<Slot> slots(games);
+    std::mt19937_64 random(seed);
+    std::int64_t sentMoves = 0;
+    std::size_t inFlight = 0;
+    std::string out{};
+    std::string in{};
+    std::array<char, 65536> buffer{};
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    sockaddr_un address{};
+
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+    bool ok = fd >= 0 && connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) == 0;
+
+    auto send = [&](std::uint32_t tag, const protocol::Request &request) {
+        protocol::appendRequest(out, request);
+        slots[tag].sent = Clock::now();
+        inFlight++;
+    };
+    auto start = [&](std::uint32_t tag) {
+        slots[tag] = {State::starting, 0, &sequences[random() % sequences.size()], 0, {}};
+        send(tag, {protocol::RequestType::newGame, tag, 0, 0, ""});
+    };
+    auto next = [&](std::uint32_t tag) {
+        Slot &slot = slots[tag];
+
+        if (slot.ply < slot.moves->size() && sentMoves < moves) {
+            slot.state = State::moving;
+            send(tag,
+                 {protocol::RequestType::move, tag, slot.game, (*slot.moves)[slot.ply++], ""});
+            sentMoves++;
+        } else {
+            slot.state = State::closing;
+            send(tag, {protocol::RequestType::close, tag, slot.game, 0, ""});
+        }
+    };
+
+    for (int i = 0; i < games && ok; i++) {
+        start(static_cast<std::uint32_t>(i));
+    }
+
+    while (ok && inFlight > 0) {
+        for (std::size_t written = 0; ok && written < out.size();) {
+            ssize_t n = ::send(fd, out.data() + written, out.size() - written, MSG_NOSIGNAL);
+            ok = n > 0;
+            written += n > 0 ? n : 0;
+        }
+        out.clear();
+
+        ssize_t got = ok ? recv(fd, buffer.data(), buffer.size(), 0) : 0;
+        ok = got > 0;
+        in.append(buffer.data(), got > 0 ? got : 0);
+
+        std::size_t offset = 0;
+        protocol::Reply reply{};
+        std::optional<std::size_t> used = 0;
+        while (ok && (used = protocol::readReply(std::as_bytes(std::span(in)).subspan(offset),
+                                                 reply))
+                         .value_or(0) > 0) {
+            Slot &slot = slots.at(reply.tag);
+            Clock::time_point now = Clock::now();
+
+            offset += *used;
+            inFlight--;
+            ret.latencies.push_back(
+                std::chrono::duration_cast<std::chrono::microseconds>(now - slot.sent).count());
+            ret.errors += reply.status != protocol::Status::ok;
+
+            if (slot.state == State::starting && reply.status == protocol::Status::ok) {
+                slot.game = reply.game;
+                next(reply.tag);
+            } else if (slot.state == State::moving && reply.status == protocol::Status::ok &&
+                       reply.result == WinSearchResult::nothing) {
+                ret.moves++;
+                next(reply.tag);
+            } else {
+                // a closed game, the last move of a game or an error, the game is over either way
+                ret.moves += slot.state == State::moving && reply.status == protocol::Status::ok;
+                ret.games++;
+                if (sentMoves < moves) {
+                    start(reply.tag);
+                }
+            }
+        }
+        ok = ok && used.has_value();
+        in.erase(0, offset);
+    }
+
+    if (fd >= 0) {
+        close(fd);
+    }
+    ret.errors += !ok;
+
+    return ret;
+}
+
+int main(int argc, char **argv) {
+    int ret = 0;
+    int connections = 4;
+    int games = 64;
+    std::int64_t moves = 20000;
+    int plies = 60;
+    std::uint64_t seed = 1;
+    bool ok = argc >= 2;
+
+    for (int i = 2; i < argc && ok; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (!hasValue) {
+            ok = false;
+        } else if (arg == "--connections") {
+            connections = std::atoi(argv[++i]);
+        } else if (arg == "--games") {
+            games = std::atoi(argv[++i]);
+        } else if (arg == "--moves") {
+            moves = std::atoll(argv[++i]);
+        } else if (arg == "--plies") {
+            plies = std::atoi(argv[++i]);
+        } else if (arg == "--seed") {
+            seed = std::strtoull(argv[++i], nullptr, 10);
+        } else {
+            ok = false;
+        }
+    }
+
+    if (!ok || connections < 1 || games < 1 || plies < 1) {
+        printUsage();
+        ret = 1;
+    } else {
+        std::vector<std::vector<std::uint16_t>> sequences = randomGames(64, plies, seed);
+        std::vector<LoadStats> stats(connections);
+        Clock::time_point start = Clock::now();
+
+        {
+            std::vector<std::jthread> threads{};
+            for (int i = 0; i < connections; i++) {
+                threads.emplace_back([&, i] {
+                    stats[i] = play(argv[1], games, moves, sequences, seed + i + 1);
+                });
+            }
+        }
+
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        LoadStats total{};
+        for (LoadStats &connection : stats) {
+            total.moves += connection.moves;
+            total.games += connection.games;
+            total.errors += connection.errors;
+            total.latencies.insert(total.latencies.end(), connection.latencies.begin(),
+                                   connection.latencies.end());
+        }
+        std::sort(total.latencies.begin(), total.latencies.end());
+        auto percentile = [&](double p) -> std::int64_t {
+            return total.latencies.empty()
+                       ? 0
+                       : total.latencies[static_cast<std::size_t>(
+                             p * static_cast<double>(total.latencies.size() - 1))];
+        };
+
+        std::cout << std::fixed << std::setprecision(2) << total.moves << " moves, "
+                  << total.games << " games in " << seconds << "s, " << total.moves / seconds
+                  << " moves/s, latency p50 " << percentile(0.5) << "us p99 " << percentile(0.99)
+                  << "us max " << percentile(1.0) << "us, " << total.errors << " errors\n";
+        ret = total.errors > 0 ? 1 : 0;
+    }
+
+    return ret;
+}
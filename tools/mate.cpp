@@ -0,0 +1,92 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "chessMateSolver.hpp"
+#include "chessPosition.hpp"
+
+using namespace chess;
+
+static void printUsage() {
+    std::cout << "usage: chess_mate N [--nodes N] < positions\n"
+                 "reads one FEN per line and prints the first moves that mate in at most N moves\n"
+                 "and whether the others were proven not to, unique if exactly one move mates\n"
+                 "options:\n"
+                 "  --nodes N   nodes to search per position before giving up (default 10000000)\n";
+}
+
+static std::string join(const std::vector<std::string> &moves) {
+    std::string ret{};
+
+    for (const std::string &move : moves) {
+        ret += (ret.empty() ? "" : " ") + move;
+    }
+
+    return ret;
+}
+
+int main(int argc, char **argv) {
+    int ret = 0;
+    int moves = argc >= 2 ? std::atoi(argv[1]) : 0;
+    std::int64_t maxNodes = 10'000'000;
+    bool ok = moves > 0;
+
+    for (int i = 2; i < argc && ok; i++) {
+        std::string arg = argv[i];
+
+        if (arg == "--nodes" && i + 1 < argc) {
+            maxNodes = std::atoll(argv[++i]);
+        } else {
+            ok = false;
+        }
+    }
+
+    if (!ok) {
+        printUsage();
+        ret = 1;
+    } else {
+        MateSolver solver{};
+        std::string line{};
+        int positions = 0;
+        int unique = 0;
+        std::int64_t nodes = 0;
+        auto start = std::chrono::steady_clock::now();
+
+        while (std::getline(std::cin, line)) {
+            std::optional<Position> position = Position::fromFEN(line);
+
+            if (line.empty()) {
+                continue;
+            } else if (!position.has_value()) {
+                std::cerr << "invalid fen " << line << "\n";
+                ret = 1;
+                continue;
+            }
+
+            MateResult result = solver.solve(*position, moves, maxNodes);
+            bool isUnique = result.complete() && result.mates.size() == 1;
+
+            std::cout << line << "\n  mates: " << join(result.mates)
+                      << (isUnique ? " (unique)" : "") << "\n";
+            if (!result.complete()) {
+                std::cout << "  unknown: " << join(result.unknown) << "\n";
+            }
+            std::cout << "  " << result.refuted.size() << " refuted, " << result.nodes
+                      << " nodes\n";
+
+            positions++;
+            unique += isUnique ? 1 : 0;
+            nodes += result.nodes;
+        }
+
+        std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+        std::cout << positions << " positions, " << unique << " with a unique mate, " << nodes
+                  << " nodes in " << seconds.count() << "s\n";
+    }
+
+    return ret;
+}
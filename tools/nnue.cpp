@@ -0,0 +1,106 @@
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "chessBase.hpp"
+#include "chessBoard.hpp"
+#include "chessGame.hpp"
+#include "chessNNUE.hpp"
+#include "chessPosition.hpp"
+
+using namespace chess;
+
+static void printUsage() {
+    std::cout << "usage: chess_nnue generate NET [--seed N]\n"
+                 "       chess_nnue eval NET [startpos|fen FEN] [moves ...]\n"
+                 "generate writes a network that counts material, for testing\n"
+                 "eval prints the score after every move, updating the accumulators as it goes\n";
+}
+
+static int generate(const std::string &path, std::uint64_t seed) {
+    int ret = 1;
+
+    if (!nnue::Network::generate(seed)->save(path)) {
+        std::cerr << "can't write " << path << "\n";
+    } else {
+        ret = 0;
+    }
+
+    return ret;
+}
+
+/**
+ * `args` is the position in the form of a UCI position command without the leading `position`
+ */
+static int eval(const std::string &networkPath, const std::vector<std::string> &args) {
+    int ret = 1;
+    std::shared_ptr<const nnue::Network> network = nnue::Network::load(networkPath);
+    HeadlessGame headless;
+    Game &game = headless.game;
+    std::string fen{};
+    std::size_t i = 0;
+
+    if (i < args.size() && args[i] == "startpos") {
+        i++;
+    } else if (i < args.size() && args[i] == "fen") {
+        for (i++; i < args.size() && args[i] != "moves"; i++) {
+            fen += (fen.empty() ? "" : " ") + args[i];
+        }
+    }
+    i += i < args.size() && args[i] == "moves" ? 1 : 0;
+    bool ok = game.loadFEN(fen.empty() ? startingFEN : fen);
+
+    if (network == nullptr) {
+        std::cerr << networkPath << " isn't a network\n";
+    } else if (!ok) {
+        std::cerr << "invalid position\n";
+    } else {
+        nnue::Evaluator evaluator(network);
+        std::string played = "-";
+
+        ret = 0;
+        for (; ret == 0; i++) {
+            Position position = game.position();
+            int score = evaluator.evaluate(position);
+            int fresh = nnue::Evaluator::forward(
+                *network, nnue::Evaluator::refresh(*network, position), position.sideToMove);
+
+            std::cout << played << " " << score << "\n";
+            if (score != fresh) {
+                std::cerr << "the accumulators went out of sync, " << fresh << " from scratch\n";
+                ret = 1;
+            } else if (i >= args.size()) {
+                break;
+            } else {
+                std::optional<Move> move = game.moveFromUCI(args[i]);
+                if (!move.has_value() || game.makeMove(*move) != RunResult::turnedPassed) {
+                    std::cerr << "illegal move " << args[i] << "\n";
+                    ret = 1;
+                }
+                played = args[i];
+            }
+        }
+    }
+
+    return ret;
+}
+
+int main(int argc, char **argv) {
+    int ret = 1;
+    std::vector<std::string> args(argv + 1, argv + argc);
+
+    if (args.size() == 2 && args[0] == "generate") {
+        ret = generate(args[1], 0);
+    } else if (args.size() == 4 && args[0] == "generate" && args[2] == "--seed") {
+        ret = generate(args[1], std::stoull(args[3]));
+    } else if (args.size() >= 2 && args[0] == "eval") {
+        ret = eval(args[1], std::vector<std::string>(args.begin() + 2, args.end()));
+    } else {
+        printUsage();
+    }
+
+    return ret;
+}
@@ -0,0 +1,129 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "chessArchive.hpp"
+#include "chessBase.hpp"
+#include "chessBoard.hpp"
+#include "chessGame.hpp"
+#include "chessOpeningTree.hpp"
+
+using namespace chess;
+
+static void printUsage() {
+    std::cout << "usage: chess_openings build ARCHIVE TREE [options]\n"
+                 "       chess_openings show TREE [startpos|fen FEN] [moves ...]\n"
+                 "options:\n"
+                 "  --threads N    worker threads (default: one per core)\n"
+                 "  --max-plies N  plies of each game to count (default 20)\n"
+                 "  --min-games N  leave out moves played in fewer games (default 1)\n";
+}
+
+static int build(const std::string &archivePath, const std::string &treePath,
+                 const OpeningTreeConfig &config) {
+    int ret = 1;
+    std::optional<GameArchive> archive = GameArchive::open(archivePath);
+    auto start = std::chrono::steady_clock::now();
+
+    if (!archive.has_value()) {
+        std::cerr << archivePath << " isn't a game archive\n";
+    } else if (!buildOpeningTree(*archive, treePath, config)) {
+        std::cerr << "can't write " << treePath << "\n";
+    } else {
+        std::optional<OpeningTree> tree = OpeningTree::open(treePath);
+        std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+
+        std::cout << archive->size() << " games, " << (tree.has_value() ? tree->size() : 0)
+                  << " positions in " << seconds.count() << "s\n";
+        ret = 0;
+    }
+
+    return ret;
+}
+
+/**
+ * `args` is the position in the form of a UCI position command without the leading `position`
+ */
+static int show(const std::string &treePath, const std::vector<std::string> &args) {
+    int ret = 1;
+    std::optional<OpeningTree> tree = OpeningTree::open(treePath);
+    HeadlessGame headless;
+    Game &game = headless.game;
+    std::string fen{};
+    std::size_t i = 0;
+
+    if (i < args.size() && args[i] == "startpos") {
+        i++;
+    } else if (i < args.size() && args[i] == "fen") {
+        for (i++; i < args.size() && args[i] != "moves"; i++) {
+            fen += (fen.empty() ? "" : " ") + args[i];
+        }
+    }
+    i += i < args.size() && args[i] == "moves" ? 1 : 0;
+    bool ok = game.loadFEN(fen.empty() ? startingFEN : fen);
+
+    for (; i < args.size() && ok; i++) {
+        std::optional<Move> move = game.moveFromUCI(args[i]);
+        ok = move.has_value() && game.makeMove(*move) == RunResult::turnedPassed;
+    }
+
+    if (!tree.has_value()) {
+        std::cerr << treePath << " isn't an opening tree\n";
+    } else if (!ok) {
+        std::cerr << "invalid position\n";
+    } else {
+        std::vector<OpeningMove> moves = tree->moves(game.positionHash());
+
+        std::cout << game.getFEN() << "\n";
+        for (const OpeningMove &move : moves) {
+            double games = move.games;
+
+            std::cout << std::left << std::setw(6) << move.move << std::right << std::setw(10)
+                      << move.games << std::fixed << std::setprecision(1) << std::setw(8)
+                      << 100.0 * move.whiteWins / games << "%" << std::setw(7)
+                      << 100.0 * move.draws / games << "%" << std::setw(7)
+                      << 100.0 * move.blackWins / games << "%\n";
+        }
+        ret = 0;
+    }
+
+    return ret;
+}
+
+int main(int argc, char **argv) {
+    int ret = 1;
+    std::vector<std::string> args(argv + 1, argv + argc);
+    OpeningTreeConfig config{};
+    bool ok = args.size() >= 3 && args[0] == "build";
+
+    for (std::size_t i = 3; i < args.size() && ok; i++) {
+        bool hasValue = i + 1 < args.size();
+
+        if (!hasValue) {
+            ok = false;
+        } else if (args[i] == "--threads") {
+            config.threads = std::atoi(args[++i].c_str());
+        } else if (args[i] == "--max-plies") {
+            config.maxPlies = std::atoi(args[++i].c_str());
+        } else if (args[i] == "--min-games") {
+            config.minGames = static_cast<std::uint32_t>(std::atoi(args[++i].c_str()));
+        } else {
+            ok = false;
+        }
+    }
+
+    if (ok) {
+        ret = build(args[1], args[2], config);
+    } else if (args.size() >= 2 && args[0] == "show") {
+        ret = show(args[1], std::vector<std::string>(args.begin() + 2, args.end()));
+    } else {
+        printUsage();
+    }
+
+    return ret;
+}
@@ -0,0 +1,103 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "chessArchive.hpp"
+#include "chessBase.hpp"
+#include "chessBoard.hpp"
+#include "chessGame.hpp"
+#include "chessPositionIndex.hpp"
+
+using namespace chess;
+
+static void printUsage() {
+    std::cout << "usage: chess_index build ARCHIVE INDEX [options]\n"
+                 "       chess_index query INDEX FEN\n"
+                 "options:\n"
+                 "  --threads N      worker threads (default: one per core)\n"
+                 "  --run-entries N  entries sorted in memory per thread (default 4194304)\n"
+                 "  --max-plies N    plies of each game to index (default: all)\n";
+}
+
+static int build(const std::string &archivePath, const std::string &indexPath,
+                 const PositionIndexConfig &config) {
+    int ret = 1;
+    std::optional<GameArchive> archive = GameArchive::open(archivePath);
+    auto start = std::chrono::steady_clock::now();
+
+    if (!archive.has_value()) {
+        std::cerr << archivePath << " isn't a game archive\n";
+    } else if (!buildPositionIndex(*archive, indexPath, config)) {
+        std::cerr << "can't write " << indexPath << "\n";
+    } else {
+        std::optional<PositionIndex> index = PositionIndex::open(indexPath);
+        std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+
+        std::cout << archive->size() << " games, " << (index.has_value() ? index->size() : 0)
+                  << " positions indexed in " << seconds.count() << "s\n";
+        ret = 0;
+    }
+
+    return ret;
+}
+
+static int query(const std::string &indexPath, const std::string &fen) {
+    int ret = 1;
+    std::optional<PositionIndex> index = PositionIndex::open(indexPath);
+    HeadlessGame headless;
+    Game &game = headless.game;
+
+    if (!index.has_value()) {
+        std::cerr << indexPath << " isn't a position index\n";
+    } else if (!game.loadFEN(fen)) {
+        std::cerr << "invalid FEN\n";
+    } else {
+        auto start = std::chrono::steady_clock::now();
+        std::vector<PositionHit> hits = index->find(game.positionHash());
+        std::chrono::duration<double, std::milli> ms = std::chrono::steady_clock::now() - start;
+
+        for (const PositionHit &hit : hits) {
+            std::cout << "game " << hit.game << " ply " << hit.ply << "\n";
+        }
+        std::cout << hits.size() << " hits in " << ms.count() << "ms\n";
+        ret = 0;
+    }
+
+    return ret;
+}
+
+int main(int argc, char **argv) {
+    int ret = 1;
+    std::vector<std::string> args(argv + 1, argv + argc);
+    PositionIndexConfig config{};
+    bool ok = args.size() >= 3;
+
+    for (std::size_t i = 3; i < args.size() && ok; i++) {
+        bool hasValue = i + 1 < args.size();
+
+        if (!hasValue) {
+            ok = false;
+        } else if (args[i] == "--threads") {
+            config.threads = std::atoi(args[++i].c_str());
+        } else if (args[i] == "--run-entries") {
+            config.runEntries = std::strtoull(args[++i].c_str(), nullptr, 10);
+        } else if (args[i] == "--max-plies") {
+            config.maxPlies = std::atoi(args[++i].c_str());
+        } else {
+            ok = false;
+        }
+    }
+
+    if (ok && args[0] == "build") {
+        ret = build(args[1], args[2], config);
+    } else if (ok && args[0] == "query" && args.size() == 3) {
+        ret = query(args[1], args[2]);
+    } else {
+        printUsage();
+    }
+
+    return ret;
+}
@@ -0,0 +1,157 @@
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <random>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "chessBase.hpp"
+#include "chessGame.hpp"
+#include "chessScheduler.hpp"
+#include "chessTournament.hpp"
+
+using namespace chess;
+
+using Clock = std::chrono::steady_clock;
+
+static void printUsage() {
+    std::cout << "usage: chess_scheduler [options]\n"
+                 "plays games of random moves that each take a while to arrive, like the games\n"
+                 "of a correspondence server, with a few threads for all of them\n"
+                 "options:\n"
+                 "  --games N      games played at the same time (default 1000)\n"
+                 "  --threads N    worker threads (default: one per core)\n"
+                 "  --think MS     average time before a move arrives (default 50)\n"
+                 "  --max-plies N  abort games after N plies (default 100)\n"
+                 "  --seed N\n";
+}
+
+int main(int argc, char **argv) {
+    int ret = 0;
+    int games = 1000;
+    int threads = 0;
+    int think = 50;
+    int maxPlies = 100;
+    std::uint64_t seed = 1;
+    bool ok = true;
+
+    for (int i = 1; i < argc && ok; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (!hasValue) {
+            ok = false;
+        } else if (arg == "--games") {
+            games = std::atoi(argv[++i]);
+        } else if (arg == "--threads") {
+            threads = std::atoi(argv[++i]);
+        } else if (arg == "--think") {
+            think = std::atoi(argv[++i]);
+        } else if (arg == "--max-plies") {
+            maxPlies = std::atoi(argv[++i]);
+        } else if (arg == "--seed") {
+            seed = std::strtoull(argv[++i], nullptr, 10);
+        } else {
+            ok = false;
+        }
+    }
+
+    if (!ok || games < 1 || think < 0 || maxPlies < 1) {
+        printUsage();
+        ret = 1;
+    } else {
+        // indexed by `GameId`, which counts from 1 in spawn order
+        std::vector<std::atomic<bool>> due(games + 1);
+        std::vector<int> plies(games + 1, 0);
+        std::mutex timerMutex;
+        std::condition_variable timerCv;
+        std::priority_queue<std::pair<Clock::time_point, GameId>,
+                            std::vector<std::pair<Clock::time_point, GameId>>, std::greater<>>
+            timers{};
+        std::mt19937_64 random(seed);
+        std::atomic<int> finished = 0;
+        std::atomic<std::int64_t> moves = 0;
+        std::array<std::atomic<int>, 3> results{};
+
+        auto delay = [&]() -> Clock::duration {
+            return std::chrono::milliseconds(think > 0 ? random() % (2 * think + 1) : 0);
+        };
+        auto player = [&](PieceColor color, GameId id) -> std::unique_ptr<Player> {
+            auto moveRandom =
+                std::make_shared<std::mt19937_64>(seed ^ (id * 2 + static_cast<int>(color)));
+            return std::make_unique<FunctionPlayer>(color, [&, id, moveRandom](Game &game) {
+                std::span<const Move> legal = game.legalMoves();
+                return due[id].exchange(false) && !legal.empty()
+                           ? std::make_optional(legal[(*moveRandom)() % legal.size()])
+                           : std::nullopt;
+            });
+        };
+
+        Clock::time_point start = Clock::now();
+        GameScheduler scheduler(
+            [&](const GameUpdate &update) {
+                if (update.finished) {
+                    bool white = update.result == WinSearchResult::whiteWinCheckmate;
+                    bool black = update.result == WinSearchResult::blackWinCheckmate;
+                    results[white ? 0 : black ? 1 : 2]++;
+                    finished++;
+                    timerCv.notify_one();
+                } else if (update.accepted) {
+                    moves++;
+                    if (++plies[update.id] >= maxPlies) {
+                        scheduler.abort(update.id);
+                    } else {
+                        std::lock_guard lock(timerMutex);
+                        timers.emplace(Clock::now() + delay(), update.id);
+                        timerCv.notify_one();
+                    }
+                }
+            },
+            threads);
+
+        for (int i = 0; i < games; i++) {
+            std::lock_guard lock(timerMutex);
+            GameId id = static_cast<GameId>(i + 1);
+
+            scheduler.spawn(player(PieceColor::white, id), player(PieceColor::black, id));
+            timers.emplace(Clock::now() + delay(), id);
+        }
+
+        // the timer gives a game its move once it's due, the game waits without a thread
+        std::unique_lock lock(timerMutex);
+        while (finished < games) {
+            if (timers.empty()) {
+                timerCv.wait_for(lock, std::chrono::milliseconds(10));
+            } else if (timers.top().first > Clock::now()) {
+                timerCv.wait_until(lock, timers.top().first);
+            } else {
+                GameId id = timers.top().second;
+                timers.pop();
+                due[id] = true;
+                scheduler.wake(id);
+            }
+        }
+        lock.unlock();
+
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        std::cout << std::fixed << std::setprecision(2) << games << " games, " << moves
+                  << " moves in " << seconds << "s, " << moves / seconds << " moves/s, +"
+                  << results[0] << " -" << results[1] << " =" << results[2]
+                  << " (draws and aborted)\n";
+    }
+
+    return ret;
+}
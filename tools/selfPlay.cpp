@@ -0,0 +1,164 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <random>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "chessBase.hpp"
+#include "chessGame.hpp"
+#include "chessTournament.hpp"
+
+using namespace chess;
+
+static void printUsage() {
+    std::cout << "usage: chess_selfplay [options] [first] [second]\n"
+                 "competitors: random, greedy (default: greedy random)\n"
+                 "options:\n"
+                 "  --games N            games to play (default 100)\n"
+                 "  --threads N          worker threads (default: one per core)\n"
+                 "  --book FILE          FEN/EPD openings, one per line\n"
+                 "  --random-plies N     random moves played after the opening\n"
+                 "  --max-plies N        adjudicate longer games as draws (default 400)\n"
+                 "  --material-margin N  adjudicate a win when a side is N material ahead\n"
+                 "  --seed N\n"
+                 "  --elo0 X --elo1 X    SPRT hypotheses (default 0 and 5)\n"
+                 "  --alpha X --beta X   SPRT error rates (default 0.05)\n"
+                 "  --sprt-stop          stop once the SPRT is decided\n";
+}
+
+/**
+ * picks a random legal move
+ */
+static PlayerFactory randomPlayer() {
+    return [](PieceColor color, std::uint64_t seed) -> std::unique_ptr<Player> {
+        auto random = std::make_shared<std::mt19937_64>(seed);
+        return std::make_unique<FunctionPlayer>(color, [=](Game &game) -> std::optional<Move> {
+            std::span<const Move> moves = game.legalMoves();
+            return moves.empty() ? std::nullopt
+                                 : std::make_optional(moves[(*random)() % moves.size()]);
+        });
+    };
+}
+
+/**
+ * captures the most valuable piece it can, otherwise picks a random legal move
+ */
+static PlayerFactory greedyPlayer() {
+    return [](PieceColor color, std::uint64_t seed) -> std::unique_ptr<Player> {
+        auto random = std::make_shared<std::mt19937_64>(seed ^ 0x9e3779b97f4a7c15);
+        return std::make_unique<FunctionPlayer>(color, [=](Game &game) -> std::optional<Move> {
+            std::span<const Move> legal = game.legalMoves();
+            std::vector<Move> moves(legal.begin(), legal.end());
+            std::shuffle(moves.begin(), moves.end(), *random);
+            auto best = std::max_element(moves.begin(), moves.end(), [](Move &a, Move &b) {
+                return (a.endPiece != nullptr ? a.endPiece->value : 0) <
+                       (b.endPiece != nullptr ? b.endPiece->value : 0);
+            });
+            return best != moves.end() ? std::make_optional(*best) : std::nullopt;
+        });
+    };
+}
+
+static std::optional<PlayerFactory> playerByName(const std::string &name) {
+    std::optional<PlayerFactory> ret = std::nullopt;
+
+    if (name == "random") {
+        ret = randomPlayer();
+    } else if (name == "greedy") {
+        ret = greedyPlayer();
+    }
+
+    return ret;
+}
+
+static void printStats(const TournamentConfig &config, const TournamentStats &stats) {
+    EloEstimate elo = estimateElo(stats.wins, stats.draws, stats.losses);
+    double llr = sprtLLR(stats.wins, stats.draws, stats.losses, config.elo0, config.elo1);
+    SprtResult sprt = sprtResult(llr, config.alpha, config.beta);
+
+    std::cout << std::fixed << std::setprecision(2) << "games " << stats.games() << ": +"
+              << stats.wins << " =" << stats.draws << " -" << stats.losses << " (forfeits "
+              << stats.forfeits << ", skipped " << stats.skipped << "), elo " << elo.elo
+              << " +/- " << elo.error << ", llr " << llr << " ["
+              << (sprt == SprtResult::acceptH1   ? "H1 accepted"
+                  : sprt == SprtResult::acceptH0 ? "H0 accepted"
+                                                 : "inconclusive")
+              << "], " << stats.gamesPerSecond() << " games/s\n";
+}
+
+int main(int argc, char **argv) {
+    TournamentConfig config{};
+    std::vector<std::string> names{};
+    bool ok = true;
+
+    for (int i = 1; i < argc && ok; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (arg == "--help" || arg == "-h") {
+            ok = false;
+        } else if (arg == "--sprt-stop") {
+            config.stopOnSprt = true;
+        } else if (arg.starts_with("--") && !hasValue) {
+            ok = false;
+        } else if (arg == "--games") {
+            config.games = std::atoi(argv[++i]);
+        } else if (arg == "--threads") {
+            config.threads = std::atoi(argv[++i]);
+        } else if (arg == "--book") {
+            std::ifstream book(argv[++i]);
+            ok = book.is_open();
+            config.openings = readOpenings(book);
+        } else if (arg == "--random-plies") {
+            config.randomPlies = std::atoi(argv[++i]);
+        } else if (arg == "--max-plies") {
+            config.maxPlies = std::atoi(argv[++i]);
+        } else if (arg == "--material-margin") {
+            config.materialMargin = std::atoi(argv[++i]);
+        } else if (arg == "--seed") {
+            config.seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--elo0") {
+            config.elo0 = std::atof(argv[++i]);
+        } else if (arg == "--elo1") {
+            config.elo1 = std::atof(argv[++i]);
+        } else if (arg == "--alpha") {
+            config.alpha = std::atof(argv[++i]);
+        } else if (arg == "--beta") {
+            config.beta = std::atof(argv[++i]);
+        } else if (arg.starts_with("--")) {
+            ok = false;
+        } else {
+            names.push_back(arg);
+        }
+    }
+
+    if (names.empty()) {
+        names.push_back("greedy");
+    }
+    names.resize(2, "random");
+    std::optional<PlayerFactory> first = playerByName(names[0]);
+    std::optional<PlayerFactory> second = playerByName(names[1]);
+
+    if (!ok || !first.has_value() || !second.has_value()) {
+        printUsage();
+        return 1;
+    }
+
+    std::cout << names[0] << " vs " << names[1] << "\n";
+    TournamentStats stats = runTournament(
+        config, *first, *second, [&](const TournamentStats &stats) -> void {
+            if (stats.games() % 50 == 0) {
+                printStats(config, stats);
+            }
+        });
+    printStats(config, stats);
+
+    return 0;
+}
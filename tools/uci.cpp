@@ -0,0 +1,332 @@
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "chessBase.hpp"
+#include "chessBoard.hpp"
+#include "chessEngine.hpp"
+#include "chessGame.hpp"
+#include "chessNNUE.hpp"
+
+using namespace chess;
+
+/**
+ * writes lines to stdout from its own thread, so the search never waits on the GUI reading them
+ */
+class OutputQueue {
+   private:
+    std::mutex _mutex;
+    std::condition_variable _cv;
+    std::deque<std::string> _lines;
+    bool _closed;
+    std::thread _writer;
+
+   public:
+    OutputQueue() : _closed(false), _writer([this] { write(); }) {}
+
+    ~OutputQueue() {
+        {
+            std::lock_guard lock(_mutex);
+            _closed = true;
+        }
+        _cv.notify_one();
+        _writer.join();
+    }
+
+    void push(std::string line) {
+        {
+            std::lock_guard lock(_mutex);
+            _lines.push_back(std::move(line));
+        }
+        _cv.notify_one();
+    }
+
+   private:
+    void write() {
+        std::unique_lock lock(_mutex);
+
+        while (!_closed || !_lines.empty()) {
+            _cv.wait(lock, [this] { return _closed || !_lines.empty(); });
+
+            std::deque<std::string> lines{};
+            lines.swap(_lines);
+            lock.unlock();
+            for (std::string &line : lines) {
+                std::fwrite(line.data(), 1, line.size(), stdout);
+                std::fputc('\n', stdout);
+            }
+            std::fflush(stdout);
+            lock.lock();
+        }
+    }
+};
+
+class UciFrontEnd {
+   private:
+    Board _board;
+    Player _white;
+    Player _black;
+    Game _game;
+    /**
+     * a `MaterialEngine` until a network is loaded with `setoption name EvalFile`
+     */
+    std::unique_ptr<Engine> _engine;
+    int _multiPV;
+    OutputQueue _out;
+    /**
+     * what the current game was set up from, so a `position` command that only adds moves to it
+     * doesn't rebuild the board
+     */
+    std::string _fen;
+    std::vector<std::string> _moves;
+    SearchSignals _signals;
+    std::mutex _mutex;
+    std::condition_variable _cv;
+    std::thread _search;
+
+   public:
+    UciFrontEnd()
+        : _board(64, false),
+          _white(PieceColor::white),
+          _black(PieceColor::black),
+          _game(_board, _white, _black),
+          _engine(std::make_unique<MaterialEngine>()),
+          _multiPV(1) {
+        setPosition(startingFEN, {});
+    }
+
+    ~UciFrontEnd() { stop(); }
+
+    /**
+     * returns `false` when the GUI asks to quit
+     */
+    bool handle(const std::string &line) {
+        std::istringstream stream(line);
+        std::string command{};
+        bool ret = true;
+
+        stream >> command;
+        if (command == "uci") {
+            _out.push("id name " + _engine->name());
+            _out.push("id author Chess-Library");
+            _out.push("option name EvalFile type string default <empty>");
+            _out.push("option name MultiPV type spin default 1 min 1 max 256");
+            _out.push("uciok");
+        } else if (command == "isready") {
+            _out.push("readyok");
+        } else if (command == "ucinewgame") {
+            stop();
+            _engine->newGame();
+            _fen.clear();
+            setPosition(startingFEN, {});
+        } else if (command == "setoption") {
+            stop();
+            setOption(stream);
+        } else if (command == "position") {
+            stop();
+            position(stream);
+        } else if (command == "go") {
+            stop();
+            go(stream);
+        } else if (command == "stop") {
+            stop();
+        } else if (command == "ponderhit") {
+            {
+                std::lock_guard lock(_mutex);
+                _signals.ponder = false;
+            }
+            _cv.notify_all();
+        } else if (command == "quit") {
+            ret = false;
+        }
+
+        return ret;
+    }
+
+   private:
+    void setOption(std::istringstream &stream) {
+        std::string token{};
+        std::string name{};
+        std::string value{};
+
+        stream >> token;
+        while (stream >> token && token != "value") {
+            name += (name.empty() ? "" : " ") + token;
+        }
+        std::getline(stream >> std::ws, value);
+
+        if (name == "EvalFile") {
+            std::shared_ptr<const nnue::Network> network = nnue::Network::load(value);
+
+            if (network != nullptr) {
+                _engine = std::make_unique<NNUEEngine>(std::move(network));
+            } else {
+                _out.push("info string can't load the network " + value);
+            }
+        } else if (name == "MultiPV") {
+            _multiPV = std::clamp(std::atoi(value.c_str()), 1, 256);
+        }
+    }
+
+    void position(std::istringstream &stream) {
+        std::string token{};
+        std::string fen{};
+        std::vector<std::string> moves{};
+
+        stream >> token;
+        if (token == "startpos") {
+            fen = startingFEN;
+            stream >> token;
+        } else if (token == "fen") {
+            while (stream >> token && token != "moves") {
+                fen += (fen.empty() ? "" : " ") + token;
+            }
+        }
+
+        if (token == "moves") {
+            while (stream >> token) {
+                moves.push_back(token);
+            }
+        }
+
+        setPosition(fen, moves);
+    }
+
+    /**
+     * undoes the moves that differ from the last position and makes the new ones,
+     * the board is only set up again when the starting position changes
+     */
+    void setPosition(const std::string &fen, const std::vector<std::string> &moves) {
+        if (fen != _fen) {
+            if (!_game.loadFEN(fen)) {
+                _out.push("info string invalid fen " + fen);
+                _game.loadFEN(startingFEN);
+            }
+            _fen = fen;
+            _moves.clear();
+        }
+
+        std::size_t common = 0;
+        while (common < _moves.size() && common < moves.size() && _moves[common] == moves[common]) {
+            common++;
+        }
+
+        while (_moves.size() > common) {
+            _game.undoLastMove();
+            _moves.pop_back();
+        }
+
+        for (std::size_t i = common; i < moves.size(); i++) {
+            std::optional<Move> move = _game.moveFromUCI(moves[i]);
+
+            if (!move.has_value() || _game.makeMove(*move) != RunResult::turnedPassed) {
+                _out.push("info string illegal move " + moves[i]);
+                break;
+            }
+            _moves.push_back(moves[i]);
+        }
+    }
+
+    void go(std::istringstream &stream) {
+        SearchLimits limits{};
+        std::string token{};
+        bool ponder = false;
+
+        while (stream >> token) {
+            int value{};
+
+            if (token == "infinite") {
+                limits.infinite = true;
+            } else if (token == "ponder") {
+                ponder = true;
+            } else if (!(stream >> value)) {
+                break;
+            } else if (token == "wtime") {
+                limits.whiteTime = value;
+            } else if (token == "btime") {
+                limits.blackTime = value;
+            } else if (token == "winc") {
+                limits.whiteIncrement = value;
+            } else if (token == "binc") {
+                limits.blackIncrement = value;
+            } else if (token == "movestogo") {
+                limits.movesToGo = value;
+            } else if (token == "depth") {
+                limits.depth = value;
+            } else if (token == "nodes") {
+                limits.nodes = value;
+            } else if (token == "movetime") {
+                limits.moveTime = value;
+            }
+        }
+
+        limits.multiPV = _multiPV;
+        _signals.stop = false;
+        _signals.ponder = ponder;
+        _search = std::thread([this, limits] {
+            std::optional<Move> best =
+                _engine->search(_game, limits, _signals,
+                               [this](const SearchInfo &info) { _out.push(toUCI(info)); });
+
+            {
+                std::unique_lock lock(_mutex);
+                _cv.wait(lock, [&] {
+                    return _signals.stop || (!limits.infinite && !_signals.ponder);
+                });
+            }
+
+            _out.push("bestmove " + (best.has_value() ? moveToUCI(*best) : "0000"));
+        });
+    }
+
+    void stop() {
+        if (_search.joinable()) {
+            {
+                std::lock_guard lock(_mutex);
+                _signals.stop = true;
+            }
+            _cv.notify_all();
+            _search.join();
+        }
+    }
+
+    static std::string toUCI(const SearchInfo &info) {
+        std::int64_t nps = info.nodes * 1000 / std::max<std::int64_t>(info.timeMs, 1);
+        std::string ret = "info depth " + std::to_string(info.depth) + " multipv " +
+                          std::to_string(info.multiPV) + " score " +
+                          (info.mateIn.has_value() ? "mate " + std::to_string(*info.mateIn)
+                                                   : "cp " + std::to_string(info.score)) +
+                          " nodes " + std::to_string(info.nodes) + " time " +
+                          std::to_string(info.timeMs) + " nps " + std::to_string(nps) + " pv";
+
+        for (const std::string &move : info.pv) {
+            ret += " " + move;
+        }
+
+        return ret;
+    }
+};
+
+int main() {
+    std::ios::sync_with_stdio(false);
+
+    UciFrontEnd uci{};
+    std::string line{};
+
+    while (std::getline(std::cin, line) && uci.handle(line)) {
+    }
+
+    return 0;
+}